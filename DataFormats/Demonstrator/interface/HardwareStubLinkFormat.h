@@ -0,0 +1,121 @@
+#ifndef DataFormats_L1Trigger_HardwareStubLinkFormat_h
+#define DataFormats_L1Trigger_HardwareStubLinkFormat_h
+
+#include "DataFormats/Demonstrator/interface/HardwareStub.h"
+
+#include <vector>
+#include <cstdint>
+
+namespace l1t {
+  /**
+   * @brief     Packs the hardware stub coordinates into the bit-packed words sent along the optical links of the TMT hardware demonstrator, and unpacks them again.
+   * @details   Each of the HardwareStub data formats (HT input with the DaisyChain fw, HT output with the DaisyChain fw, HT input with the old fw) is packed into one word of at most 64 bits. The fields are packed in the order of the arguments of the corresponding HardwareStub constructor, starting from the most significant bit, with the number of bits of each field taken from the stub digitisation configuration. A field with 0 bits is not packed, which is useful for the phi sector & eta region, as these are usually given by the link carrying the stub. Signed fields are stored in two's complement.
+   *
+   *            Fields from the most significant to the least significant bit (signed fields marked "s"):
+   *            - HTinput    : phiSec, etaReg, dummy, valid, phiS(s), rT(s), z(s), mMin(s), mMax(s), layerId, subEta, deadLayer(1 bit), deadLayerId
+   *            - HToutput   : phiSec, etaReg, dummy, valid, layerId, phiS(s), rT(s), z(s), cBin, mBin
+   *            - HTinputOld : phiSec, etaReg, dummy, valid, rho, phiS(s), rT(s), z(s), dphi(s)
+   *
+   *            The dummy & valid bits have 1 bit each. deadLayerId has the same number of bits as layerId, and mMin & mMax the same as mBin.
+   *            subEta is a bit mask with one bit per eta subsector.
+   */
+  class HardwareStubLinkFormat{
+
+  public:
+
+    /// The HardwareStub data formats
+    enum Format {
+      HTinput    = 0, ///< HT input (DaisyChain fw)
+      HToutput   = 1, ///< HT output (DaisyChain fw)
+      HTinputOld = 2  ///< HT input (pipelined HT and systolic array fw)
+    };
+
+    /// Number of bits used by each of the stub coordinates. (Those not used by the chosen format are ignored).
+    struct Widths {
+      unsigned int phiSec;   ///< phi sector (0 = not packed)
+      unsigned int etaReg;   ///< eta region (0 = not packed)
+      unsigned int subEta;   ///< eta subsectors the stub is in (one bit per subsector)
+      unsigned int layerId;  ///< tracker layer identifier (also used for the dead layer identifier)
+      unsigned int phiS;     ///< phiS coordinate
+      unsigned int rT;       ///< rT coordinate
+      unsigned int z;        ///< z coordinate
+      unsigned int dphi;     ///< Delta(phi)
+      unsigned int rho;      ///< rho
+      unsigned int mBin;     ///< q/pT bin in the HT array (also used for the lowest & top q/pT bins of the stub)
+      unsigned int cBin;     ///< phi bin in the HT array
+    };
+
+    /// Description of one field of the packed word.
+    struct Field {
+      const char*  name;     ///< Name of the field
+      unsigned int shift;    ///< Position of its least significant bit in the word
+      unsigned int width;    ///< Number of bits
+      bool         isSigned; ///< Stored in two's complement
+    };
+
+    /**
+     * @brief      Constructor
+     *
+     * @param[in]  format  The HardwareStub data format to be packed
+     * @param[in]  widths  The number of bits of each stub coordinate
+     */
+    HardwareStubLinkFormat(Format format, const Widths& widths);
+
+    ~HardwareStubLinkFormat() {}
+
+    /// The HardwareStub data format packed
+    Format format()                        const { return format_;  }
+    /// Total number of bits used in each word
+    unsigned int numBits()                 const { return numBits_; }
+    /// The fields of the word, from the most significant to the least significant
+    const std::vector<Field>& fields()     const { return fields_;  }
+
+    /**
+     * @brief      Pack a stub into a word. Throws an exception if any coordinate doesn't fit into its field.
+     *
+     * @param[in]  stub  The stub
+     *
+     * @return     The packed word
+     */
+    uint64_t encode(const HardwareStub& stub) const;
+
+    /**
+     * @brief      Pack a collection of stubs into consecutive words.
+     *
+     * @param[in]  stubs  The stubs
+     * @param[out] words  Pointer to space for stubs.size() words
+     */
+    void encode(const HwStubCollection& stubs, uint64_t* words) const;
+
+    /**
+     * @brief      Unpack a word into a stub.
+     *
+     * @param[in]  word    The packed word
+     * @param[in]  phiSec  The phi sector, if it isn't packed in the word
+     * @param[in]  etaReg  The eta region, if it isn't packed in the word
+     *
+     * @return     The stub
+     */
+    HardwareStub decode(uint64_t word, unsigned int phiSec = 0, unsigned int etaReg = 0) const;
+
+  private:
+
+    // Identifiers of the stub coordinates that can be packed.
+    enum FieldId {kValid, kDummy, kPhiSec, kEtaReg, kSubEta, kDeadLayer, kDeadLayerId, kLayerId, kPhiS, kRt, kZ, kDphi, kRho, kMbinMin, kMbinMax, kMbin, kCbin, kNumFieldIds};
+
+    // Add a field after those already defined (unless it has 0 bits).
+    void addField(FieldId id, const char* name, unsigned int width, bool isSigned);
+
+    // Get the value of a stub coordinate.
+    static int64_t value(const HardwareStub& stub, FieldId id);
+
+  private:
+
+    Format                format_;
+    unsigned int          numBits_;
+    std::vector<Field>    fields_;
+    std::vector<FieldId>  fieldIds_;
+  };
+}
+
+#endif
@@ -54,7 +54,7 @@ HardwareStub::HardwareStub( unsigned int phiSec,
   layerId_ = layerId;
   subeta_ = subeta;
   deadLayer_ = deadLayer;
-  deadLayerId_ = deadLayerId_;
+  deadLayerId_ = deadLayerId;
 }
 
 // Constructor for the new HT fw output DataFormat (DaisyChain)
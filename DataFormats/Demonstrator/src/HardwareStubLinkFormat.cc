@@ -0,0 +1,149 @@
+#include "DataFormats/Demonstrator/interface/HardwareStubLinkFormat.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <iostream>
+
+using namespace l1t;
+
+// Constructor, defining the fields of the word for the chosen data format
+HardwareStubLinkFormat::HardwareStubLinkFormat(Format format, const Widths& widths) :
+  format_(format),
+  numBits_(0)
+{
+  // The fields follow the order of the arguments of the corresponding HardwareStub constructor.
+  addField(kPhiSec, "phiSec", widths.phiSec, false);
+  addField(kEtaReg, "etaReg", widths.etaReg, false);
+  addField(kDummy,  "dummy",  1,             false);
+  addField(kValid,  "valid",  1,             false);
+
+  switch (format_) {
+  case HTinput:
+    addField(kPhiS,        "phiS",        widths.phiS,    true);
+    addField(kRt,          "rT",          widths.rT,      true);
+    addField(kZ,           "z",           widths.z,       true);
+    addField(kMbinMin,     "mMin",        widths.mBin,    true);
+    addField(kMbinMax,     "mMax",        widths.mBin,    true);
+    addField(kLayerId,     "layerId",     widths.layerId, false);
+    addField(kSubEta,      "subEta",      widths.subEta,  false);
+    addField(kDeadLayer,   "deadLay",     1,              false);
+    addField(kDeadLayerId, "deadLayId",   widths.layerId, false);
+    break;
+  case HToutput:
+    addField(kLayerId,     "layerId",     widths.layerId, false);
+    addField(kPhiS,        "phiS",        widths.phiS,    true);
+    addField(kRt,          "rT",          widths.rT,      true);
+    addField(kZ,           "z",           widths.z,       true);
+    addField(kCbin,        "cBin",        widths.cBin,    false);
+    addField(kMbin,        "mBin",        widths.mBin,    false);
+    break;
+  case HTinputOld:
+    addField(kRho,         "rho",         widths.rho,     false);
+    addField(kPhiS,        "phiS",        widths.phiS,    true);
+    addField(kRt,          "rT",          widths.rT,      true);
+    addField(kZ,           "z",           widths.z,       true);
+    addField(kDphi,        "dphi",        widths.dphi,    true);
+    break;
+  default:
+    throw cms::Exception("HardwareStubLinkFormat: Unknown format ")<<format_<<std::endl;
+  }
+
+  if (numBits_ > 64) throw cms::Exception("HardwareStubLinkFormat: Fields need more than 64 bits: ")<<numBits_<<std::endl;
+
+  // Place the fields, starting from the most significant bit.
+  unsigned int shift = numBits_;
+  for (Field& field : fields_) {
+    shift -= field.width;
+    field.shift = shift;
+  }
+}
+
+// Add a field after those already defined
+void HardwareStubLinkFormat::addField(FieldId id, const char* name, unsigned int width, bool isSigned)
+{
+  if (width == 0) return;
+  if (width > 32) throw cms::Exception("HardwareStubLinkFormat: Field ")<<name<<" has too many bits: "<<width<<std::endl;
+  Field field = {name, 0, width, isSigned};
+  fields_.push_back(field);
+  fieldIds_.push_back(id);
+  numBits_ += width;
+}
+
+// Get the value of a stub coordinate
+int64_t HardwareStubLinkFormat::value(const HardwareStub& stub, FieldId id)
+{
+  switch (id) {
+  case kValid:       return stub.valid();
+  case kDummy:       return stub.dummyStub();
+  case kPhiSec:      return stub.phiSec();
+  case kEtaReg:      return stub.etaRegion();
+  case kSubEta:      return stub.subEta();
+  case kDeadLayer:   return stub.DeadLayer();
+  case kDeadLayerId: return stub.DeadLayerId();
+  case kLayerId:     return stub.layerId();
+  case kPhiS:        return stub.phiS();
+  case kRt:          return stub.rT();
+  case kZ:           return stub.z();
+  case kDphi:        return stub.dphi();
+  case kRho:         return stub.rho();
+  case kMbinMin:     return stub.MbinMin();
+  case kMbinMax:     return stub.MbinMax();
+  case kMbin:        return stub.m_bin();
+  case kCbin:        return stub.c_bin();
+  default:           return 0;
+  }
+}
+
+// Pack a stub into a word
+uint64_t HardwareStubLinkFormat::encode(const HardwareStub& stub) const
+{
+  uint64_t word = 0;
+  for (unsigned int i = 0; i < fields_.size(); i++) {
+    const Field& field = fields_[i];
+    const int64_t val = value(stub, fieldIds_[i]);
+    const int64_t minVal = field.isSigned  ?  -(int64_t(1) << (field.width - 1))  :  0;
+    const int64_t maxVal = field.isSigned  ?   (int64_t(1) << (field.width - 1))  :  (int64_t(1) << field.width);
+    if (val < minVal || val >= maxVal) throw cms::Exception("HardwareStubLinkFormat: Value of field ")<<field.name<<" = "<<val<<" doesn't fit into "<<field.width<<" bits"<<std::endl;
+    const uint64_t mask = (uint64_t(1) << field.width) - 1;
+    word |= (uint64_t(val) & mask) << field.shift;
+  }
+  return word;
+}
+
+// Pack a collection of stubs into consecutive words
+void HardwareStubLinkFormat::encode(const HwStubCollection& stubs, uint64_t* words) const
+{
+  for (const HardwareStub& stub : stubs) *(words++) = this->encode(stub);
+}
+
+// Unpack a word into a stub
+HardwareStub HardwareStubLinkFormat::decode(uint64_t word, unsigned int phiSec, unsigned int etaReg) const
+{
+  int64_t val[kNumFieldIds] = {0};
+  val[kPhiSec] = phiSec;
+  val[kEtaReg] = etaReg;
+  for (unsigned int i = 0; i < fields_.size(); i++) {
+    const Field& field = fields_[i];
+    const uint64_t mask = (uint64_t(1) << field.width) - 1;
+    int64_t v = (word >> field.shift) & mask;
+    // Sign extend.
+    if (field.isSigned && (v >> (field.width - 1)) != 0) v -= (int64_t(1) << field.width);
+    val[fieldIds_[i]] = v;
+  }
+
+  const unsigned int uPhiSec = val[kPhiSec];
+  const unsigned int uEtaReg = val[kEtaReg];
+  const bool         dummy   = val[kDummy];
+  const bool         valid   = val[kValid];
+
+  switch (format_) {
+  case HTinput:
+    return HardwareStub(uPhiSec, uEtaReg, dummy, valid, int(val[kPhiS]), int(val[kRt]), int(val[kZ]), int(val[kMbinMin]), int(val[kMbinMax]),
+                        (unsigned int)(val[kLayerId]), (unsigned int)(val[kSubEta]), bool(val[kDeadLayer]), (unsigned int)(val[kDeadLayerId]));
+  case HToutput:
+    return HardwareStub(uPhiSec, uEtaReg, dummy, valid, (unsigned int)(val[kLayerId]), int(val[kPhiS]), int(val[kRt]), int(val[kZ]),
+                        int(val[kCbin]), int(val[kMbin]));
+  default:
+    return HardwareStub(uPhiSec, uEtaReg, dummy, valid, (unsigned int)(val[kRho]), int(val[kPhiS]), int(val[kRt]), int(val[kZ]),
+                        int(val[kDphi]));
+  }
+}
@@ -0,0 +1,348 @@
+//=== Microbenchmarks of the CPU-intensive kernels of the TMTT L1 track finding, each timed in isolation on
+//=== events made by the StubGenerator (see StubGenerator.h). The benchmark is repeated for each requested
+//=== combination of pileup & number of signal tracks, so sweeping the number of stubs & track candidates per
+//=== sector, and the results are written to a JSON file, so that they can be compared between software versions.
+//===
+//=== Kernels timed: Sector::inside (reading the stubs via Stub pointers & via the StubTable),
+//=== HTrphi::store, HTbase::end, TrkRZfilter::filterTracks, KillDupTrks::filter (for each algorithm),
+//=== TrackFitGeneric::fit & TrackFitGeneric::fitBatch (for each fitter), Utility::countLayers & Utility::matchingTP.
+//===
+//=== Usage: tmttBenchmark tmtt_benchmark_cfg.py [jsonFile]
+//===
+//=== The configuration file must define process.TMTrackProducer (as tmtt_tf_analysis_cfg.py does) and a PSet
+//=== process.Benchmark with the benchmark options, including a PSet Generator with the StubGenerator options.
+
+#include "TMTrackTrigger/TMTrackFinder/interface/StubGenerator.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTrphi.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrkRZfilter.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/KillDupTrks.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1track2D.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
+
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <chrono>
+#include <memory>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+  typedef std::chrono::steady_clock Clock;
+
+  //=== Accumulates the time spent in one kernel during a pass over all the fixture events,
+  //=== and notes the fastest pass, to suppress noise from other activity on the machine.
+
+  class KernelTimer {
+  public:
+    KernelTimer() : passTime_(0.), bestTime_(-1.), passCalls_(0), calls_(0) {}
+    void start() {t0_ = Clock::now();}
+    // Stop timer, noting how many times the kernel was called since start().
+    void stop(unsigned long nCalls = 1) {passTime_ += std::chrono::duration<double>(Clock::now() - t0_).count(); passCalls_ += nCalls;}
+    void endPass() {
+      if (bestTime_ < 0. || passTime_ < bestTime_) bestTime_ = passTime_;
+      calls_     = passCalls_;
+      passTime_  = 0.;
+      passCalls_ = 0;
+    }
+    double        bestTime() const {return max(bestTime_, 0.);} // seconds per pass
+    unsigned long calls()    const {return calls_;}              // calls per pass
+  private:
+    Clock::time_point t0_;
+    double            passTime_;
+    double            bestTime_;
+    unsigned long     passCalls_;
+    unsigned long     calls_;
+  };
+
+  //=== Quote a string for the JSON output, escaping characters that JSON doesn't allow inside strings.
+
+  string jsonString(const string& str) {
+    ostringstream out;
+    out<<'"';
+    for (unsigned char c : str) {
+      if      (c == '"')  out<<"\\\"";
+      else if (c == '\\') out<<"\\\\";
+      else if (c < 0x20) {
+        const char* hex = "0123456789abcdef";
+        out<<"\\u00"<<hex[c >> 4]<<hex[c & 0xf];
+      } else {
+        out<<c;
+      }
+    }
+    out<<'"';
+    return out.str();
+  }
+
+  // Results of the kernels are written here, so that the compiler can't optimise the kernels away.
+  volatile unsigned int benchmarkSink;
+
+  //=== A generated event, with the stubs in each sector & the track candidates found there.
+  //=== Sectors are indexed by iPhiSec*numEtaRegions + iEtaReg.
+
+  struct Fixture {
+    std::unique_ptr<InputData>                                       inputData;
+    vector< vector< pair<const Stub*, vector<bool>> > >             sectorStubs; // with eta subsector flags
+    vector< vector<L1track3D> >                                      sectorCands; // from HTpair
+  };
+}
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 2) {
+    cout<<"Usage: "<<argv[0]<<" tmtt_benchmark_cfg.py [jsonFile]"<<endl;
+    return 1;
+  }
+
+  try {
+
+    //=== Read configuration.
+
+    const std::shared_ptr<edm::ParameterSet> process = edm::readPSetsFrom(argv[1]);
+    const edm::ParameterSet& cfgTMTT  = process->getParameter<edm::ParameterSet>("TMTrackProducer");
+    const edm::ParameterSet& cfgBench = process->getParameter<edm::ParameterSet>("Benchmark");
+
+    string                 outputFile      = cfgBench.getParameter<string>                ("OutputFile");
+    const string           label           = cfgBench.getParameter<string>                ("Label");
+    const unsigned int     numEvents       = cfgBench.getParameter<unsigned int>          ("NumEvents");
+    const unsigned int     numRepetitions  = max(1u, cfgBench.getParameter<unsigned int>  ("NumRepetitions"));
+    const vector<double>   pileUps         = cfgBench.getParameter<vector<double>>        ("PileUp");
+    const vector<unsigned int> numSignals  = cfgBench.getParameter<vector<unsigned int>>  ("NumSignalTracks");
+    const vector<unsigned int> dupTrkAlgs  = cfgBench.getParameter<vector<unsigned int>>  ("DupTrkAlgs");
+    const vector<string>   fitterNames     = cfgBench.getParameter<vector<string>>        ("TrackFitters");
+    const edm::ParameterSet& cfgGenerator  = cfgBench.getParameter<edm::ParameterSet>     ("Generator");
+    if (argc > 2) outputFile = argv[2];
+
+    Settings* settings = new Settings(cfgTMTT);
+    settings->setBfield(cfgGenerator.getParameter<double>("BField"));
+
+    const unsigned int nPhiSec  = settings->numPhiSectors();
+    const unsigned int nEtaReg  = settings->numEtaRegions();
+    const unsigned int nSectors = nPhiSec*nEtaReg;
+
+    vector<Sector> sectors(nSectors);
+    for (unsigned int iPhiSec = 0; iPhiSec < nPhiSec; iPhiSec++) {
+      for (unsigned int iEtaReg = 0; iEtaReg < nEtaReg; iEtaReg++) {
+	sectors[iPhiSec*nEtaReg + iEtaReg].init(settings, iPhiSec, iEtaReg);
+      }
+    }
+
+    // Create track fitters. (No histograms are booked, so KalmanFillInternalHists must be False).
+    if (settings->kalmanFillInternalHists()) throw cms::Exception("tmttBenchmark: KalmanFillInternalHists must be False")<<endl;
+    vector<pair<string, TrackFitGeneric*>> fitters;
+    for (const string& fitterName : fitterNames) {
+      fitters.push_back( make_pair(fitterName, TrackFitGeneric::create(fitterName, settings)) );
+      fitters.back().second->initRun();
+    }
+
+    ostringstream json;
+    json<<"{"<<endl;
+    json<<"  \"label\": "<<jsonString(label)<<","<<endl;
+    json<<"  \"numEvents\": "<<numEvents<<", \"numRepetitions\": "<<numRepetitions<<", \"numSectors\": "<<nSectors<<","<<endl;
+    json<<"  \"points\": ["<<endl;
+
+    bool firstPoint = true;
+    for (double pileUp : pileUps) {
+      for (unsigned int numSignal : numSignals) {
+
+	//=== Generate fixture events, and run the full HT chain once on them to get the track candidates.
+
+	edm::ParameterSet genCfg = cfgGenerator;
+	genCfg.addParameter<double>      ("PileUp",          pileUp);
+	genCfg.addParameter<unsigned int>("NumSignalTracks", numSignal);
+	StubGenerator generator(genCfg, settings);
+
+	vector<Fixture> fixtures(numEvents);
+	vector<SnapshotTP>   vTPs;
+	vector<SnapshotStub> vStubs;
+	vector<uint32_t>     vLinks;
+	unsigned long nStubsInSectors = 0;
+	unsigned long nCands2D        = 0;
+	unsigned long nCands3D        = 0;
+
+	for (Fixture& fix : fixtures) {
+	  generator.generate(vTPs, vStubs, vLinks);
+	  SnapshotEventHeader header = {1, 1, 0, uint32_t(vTPs.size()), uint32_t(vStubs.size()), uint32_t(vLinks.size()), 0};
+	  const SnapshotEvent snapEvent = {&header, vTPs.data(), vStubs.data(), vLinks.data()};
+	  fix.inputData.reset( new InputData(snapEvent, settings) );
+
+	  fix.sectorStubs.resize(nSectors);
+	  fix.sectorCands.resize(nSectors);
+	  for (unsigned int iSec = 0; iSec < nSectors; iSec++) {
+	    const Sector& sector = sectors[iSec];
+	    HTpair htPair;
+	    htPair.init(settings, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+	    for (const Stub* stub : fix.inputData->getStubs()) {
+	      if ( sector.inside( stub ) ) {
+		fix.sectorStubs[iSec].push_back( make_pair(stub, sector.insideEtaSubSecs( stub )) );
+		htPair.store( stub, fix.sectorStubs[iSec].back().second );
+	      }
+	    }
+	    htPair.end();
+	    fix.sectorCands[iSec] = htPair.trackCands3D();
+
+	    nStubsInSectors += fix.sectorStubs[iSec].size();
+	    nCands2D        += htPair.getRphiHT().numTrackCands2D();
+	    nCands3D        += htPair.numTrackCands3D();
+	  }
+	}
+
+	//=== Time each kernel, running it several times over all the fixture events.
+
+	map<string, KernelTimer> timers;
+
+	for (unsigned int iRep = 0; iRep < numRepetitions; iRep++) {
+	  for (const Fixture& fix : fixtures) {
+	    for (unsigned int iSec = 0; iSec < nSectors; iSec++) {
+	      const unsigned int iPhiSec = iSec/nEtaReg;
+	      const unsigned int iEtaReg = iSec%nEtaReg;
+	      const Sector& sector = sectors[iSec];
+	      const vector<L1track3D>& cands = fix.sectorCands[iSec];
+
+	      // Assignment of stubs to the sector, reading them via the Stub pointers & via the stub table.
+	      unsigned int nInside = 0;
+	      const vector<const Stub*>& stubs = fix.inputData->getStubs();
+	      KernelTimer& tInside = timers["Sector::inside"];
+	      tInside.start();
+	      for (const Stub* stub : stubs) if ( sector.inside( stub ) ) nInside++;
+	      tInside.stop(stubs.size());
+
+	      const StubTable& stubTable = fix.inputData->getStubTable();
+	      KernelTimer& tInsideTable = timers["Sector::insideStubTable"];
+	      tInsideTable.start();
+	      for (unsigned int i = 0; i < stubTable.size(); i++) if ( sector.inside( stubTable, i ) ) nInside++;
+	      tInsideTable.stop(stubTable.size());
+
+	      // r-phi Hough transform.
+	      HTrphi htRphi;
+	      htRphi.init(settings, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+
+	      KernelTimer& tStore = timers["HTrphi::store"];
+	      tStore.start();
+	      for (const auto& s : fix.sectorStubs[iSec]) htRphi.store(s.first, s.second);
+	      tStore.stop(fix.sectorStubs[iSec].size());
+
+	      KernelTimer& tEnd = timers["HTbase::end"];
+	      tEnd.start();
+	      htRphi.end();
+	      tEnd.stop();
+
+	      // r-z filters, run on r-phi HT output.
+	      TrkRZfilter rzFilters;
+	      rzFilters.init(settings, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+
+	      KernelTimer& tRz = timers["TrkRZfilter::filterTracks"];
+	      tRz.start();
+	      const vector<L1track2D> filtTracks = rzFilters.filterTracks( htRphi.trackCands2D() );
+	      tRz.stop();
+
+	      // Duplicate track removal, run on 3D track candidates.
+	      for (unsigned int dupTrkAlg : dupTrkAlgs) {
+		KillDupTrks<L1track3D> killDupTrks;
+		killDupTrks.init(settings, dupTrkAlg);
+
+		KernelTimer& tDup = timers["KillDupTrks::filterAlg" + to_string(dupTrkAlg)];
+		tDup.start();
+		const vector<L1track3D> dupFiltTracks = killDupTrks.filter( cands );
+		tDup.stop();
+	      }
+
+	      // Track fitters.
+	      for (auto& fitter : fitters) {
+		KernelTimer& tFit = timers["TrackFit::" + fitter.first];
+		tFit.start();
+		for (const L1track3D& trk : cands) fitter.second->fit(trk, iPhiSec, iEtaReg);
+		tFit.stop(cands.size());
+
+		KernelTimer& tFitBatch = timers["TrackFitBatch::" + fitter.first];
+		tFitBatch.start();
+		fitter.second->fitBatch(cands, iPhiSec, iEtaReg);
+		tFitBatch.stop(cands.size());
+	      }
+
+	      // Utilities used when creating every track object.
+	      unsigned int nLayersSum = 0;
+	      KernelTimer& tCount = timers["Utility::countLayers"];
+	      tCount.start();
+	      for (const L1track3D& trk : cands) nLayersSum += Utility::countLayers(settings, trk.getStubs());
+	      tCount.stop(cands.size());
+
+	      unsigned int nMatchedLayers;
+	      vector<const Stub*> matchedStubs;
+	      KernelTimer& tMatch = timers["Utility::matchingTP"];
+	      tMatch.start();
+	      for (const L1track3D& trk : cands) Utility::matchingTP(settings, trk.getStubs(), nMatchedLayers, matchedStubs);
+	      tMatch.stop(cands.size());
+
+	      // Prevent the compiler optimising away the stub routing & layer counting.
+	      benchmarkSink = nInside + nLayersSum;
+	    }
+	  }
+	  for (auto& t : timers) t.second.endPass();
+	}
+
+	//=== Report results for this point of the sweep.
+
+	const double nSecEvents      = max(1u, numEvents*nSectors);
+	const double stubsPerSector  = nStubsInSectors/nSecEvents;
+	const double cands2DPerSector = nCands2D/nSecEvents;
+	const double cands3DPerSector = nCands3D/nSecEvents;
+
+	cout<<endl<<"=== tmttBenchmark: PileUp = "<<pileUp<<" NumSignalTracks = "<<numSignal
+	    <<" : stubs/sector = "<<stubsPerSector<<" r-phi cands/sector = "<<cands2DPerSector<<" 3D cands/sector = "<<cands3DPerSector<<endl;
+
+	if (! firstPoint) json<<","<<endl;
+	firstPoint = false;
+	json<<"    {\"pileUp\": "<<pileUp<<", \"numSignalTracks\": "<<numSignal
+	    <<", \"stubsPerSector\": "<<stubsPerSector<<", \"rphiCandidatesPerSector\": "<<cands2DPerSector
+	    <<", \"candidatesPerSector\": "<<cands3DPerSector<<","<<endl;
+	json<<"     \"kernels\": {"<<endl;
+
+	bool firstKernel = true;
+	for (const auto& t : timers) {
+	  const double nsPerCall   = (t.second.calls() > 0)  ?  1.e9*t.second.bestTime()/t.second.calls()  :  0.;
+	  const double usPerSector = 1.e6*t.second.bestTime()/nSecEvents;
+	  cout<<"  "<<t.first<<" : "<<nsPerCall<<" ns/call, "<<usPerSector<<" us/sector"<<endl;
+
+	  if (! firstKernel) json<<","<<endl;
+	  firstKernel = false;
+	  json<<"       "<<jsonString(t.first)<<": {\"callsPerPass\": "<<t.second.calls()<<", \"secondsPerPass\": "<<t.second.bestTime()
+	      <<", \"nsPerCall\": "<<nsPerCall<<", \"usPerSector\": "<<usPerSector<<"}";
+	}
+	json<<endl<<"     }}";
+      }
+    }
+
+    json<<endl<<"  ]"<<endl<<"}"<<endl;
+
+    ofstream out(outputFile.c_str());
+    out<<json.str();
+    if (! out.good()) throw cms::Exception("tmttBenchmark: Failed writing to file ")<<outputFile<<endl;
+    cout<<endl<<"tmttBenchmark: results written to "<<outputFile<<endl;
+
+    for (auto& fitter : fitters) delete fitter.second;
+    delete settings;
+
+  } catch (cms::Exception& e) {
+    cout<<"tmttBenchmark: cms::Exception caught: "<<e.what()<<endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+//=== Standalone generator of stub-level events (see StubGenerator.h), writing them to a snapshot file
+//=== (see EventSnapshot.h) that can be processed by tmttReplay. Allows the L1 track finding throughput to be
+//=== studied as a function of the pileup & number of signal tracks, without needing official MC samples.
+//===
+//=== Usage: tmttGenerate tmtt_generate_cfg.py [snapshotFile] [numEvents]
+//===
+//=== The configuration file must define process.TMTrackProducer (used to define the TP selection cuts) and a PSet
+//=== process.Generator with the generator options.
+
+#include "TMTrackTrigger/TMTrackFinder/interface/StubGenerator.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 2) {
+    cout<<"Usage: "<<argv[0]<<" tmtt_generate_cfg.py [snapshotFile] [numEvents]"<<endl;
+    return 1;
+  }
+
+  try {
+
+    //=== Read configuration.
+
+    const std::shared_ptr<edm::ParameterSet> process = edm::readPSetsFrom(argv[1]);
+    const edm::ParameterSet& cfgTMTT = process->getParameter<edm::ParameterSet>("TMTrackProducer");
+    const edm::ParameterSet& cfgGen  = process->getParameter<edm::ParameterSet>("Generator");
+
+    string       outputFile = cfgGen.getParameter<string>      ("OutputFile");
+    unsigned int numEvents  = cfgGen.getParameter<unsigned int>("NumEvents");
+    double       bField     = cfgGen.getParameter<double>      ("BField");
+    if (argc > 2) outputFile = argv[2];
+    if (argc > 3) numEvents  = atoi(argv[3]);
+
+    Settings settings(cfgTMTT);
+    settings.setBfield(bField);
+
+    StubGenerator generator(cfgGen, &settings);
+
+    // Stubs generated from pileup particles not stored as TPs have no truth link, so loose matching is used.
+    EventSnapshotWriter writer(outputFile, false);
+
+    vector<SnapshotTP>   vTPs;
+    vector<SnapshotStub> vStubs;
+    vector<uint32_t>     vLinks;
+
+    unsigned long nStubsTot = 0;
+    for (unsigned int iEvent = 0; iEvent < numEvents; iEvent++) {
+      generator.generate(vTPs, vStubs, vLinks);
+      writer.write(1, 1, iEvent + 1, vTPs, vStubs, vLinks);
+      nStubsTot += vStubs.size();
+    }
+
+    cout<<"tmttGenerate: generated "<<numEvents<<" events with mean of "<<(numEvents > 0 ? float(nStubsTot)/numEvents : 0.)<<" stubs/event"<<endl;
+
+  } catch (cms::Exception& e) {
+    cout<<"tmttGenerate: cms::Exception caught: "<<e.what()<<endl;
+    return 1;
+  }
+
+  return 0;
+}
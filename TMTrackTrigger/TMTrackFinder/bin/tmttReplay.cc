@@ -0,0 +1,266 @@
+//=== Standalone replay of the TMTT L1 track finding chain (Sector -> HTpair -> track fitters -> KillDupFitTrks -> Histos),
+//=== reading stubs & tracking particles from a snapshot file written by TMTrackProducer (see EventSnapshot.h),
+//=== so no edm::Event or EventSetup is needed. Reports the event rate and the wall-clock time spent in each stage.
+//===
+//=== Usage: tmttReplay tmtt_replay_cfg.py [snapshotFile] [maxEvents]
+//===
+//=== The configuration file must define process.TMTrackProducer (as tmtt_tf_analysis_cfg.py does) and a PSet
+//=== process.Replay with parameters InputFile, MaxEvents, HistFile (empty = no histograms) and BField (Tesla).
+
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Histos.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/SectorMembership.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TPassocIndex.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/KillDupFitTrks.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+
+#include "FWCore/PythonParameterSet/interface/MakeParameterSets.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/PluginManager/interface/PluginManager.h"
+#include "FWCore/PluginManager/interface/standard.h"
+#include "FWCore/ServiceRegistry/interface/ServiceRegistry.h"
+#include "FWCore/ServiceRegistry/interface/ServiceToken.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include "boost/numeric/ublas/matrix.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+using boost::numeric::ublas::matrix;
+
+namespace {
+
+  // Processing stages that are timed individually.
+  enum Stage {InputDecoding, HTfill, HTend, Fit, DupRemoval, Histogramming, NumStages};
+  const char* stageNames[NumStages] = {"Input decoding", "Routing & HT fill", "HT end & r-z filters", "Track fit", "Dup. fit track removal", "Histogramming"};
+
+  typedef std::chrono::steady_clock Clock;
+
+  double seconds(Clock::duration dt) {return std::chrono::duration<double>(dt).count();}
+}
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 2) {
+    cout<<"Usage: "<<argv[0]<<" tmtt_replay_cfg.py [snapshotFile] [maxEvents]"<<endl;
+    return 1;
+  }
+
+  try {
+
+    //=== Read configuration.
+
+    const std::shared_ptr<edm::ParameterSet> process = edm::readPSetsFrom(argv[1]);
+    const edm::ParameterSet& cfgTMTT   = process->getParameter<edm::ParameterSet>("TMTrackProducer");
+    const edm::ParameterSet& cfgReplay = process->getParameter<edm::ParameterSet>("Replay");
+
+    string inputFile = cfgReplay.getParameter<string>("InputFile");
+    int    maxEvents = cfgReplay.getParameter<int>   ("MaxEvents");
+    string histFile  = cfgReplay.getParameter<string>("HistFile");
+    double bField    = cfgReplay.getParameter<double>("BField");
+    if (argc > 2) inputFile = argv[2];
+    if (argc > 3) maxEvents = atoi(argv[3]);
+
+    Settings* settings = new Settings(cfgTMTT);
+    // In CMSSW, this is taken from the EventSetup in TMTrackProducer::beginRun().
+    settings->setBfield(bField);
+    cout<<endl<<"--- B field = "<<bField<<" Tesla ---"<<endl<<endl;
+
+    // Tame debug printout.
+    cout.setf(ios::fixed, ios::floatfield);
+    cout.precision(4);
+
+    //=== Create the TFileService, which Histos & the fitters use to book histograms, if histograms are wanted.
+
+    edmplugin::PluginManager::configure(edmplugin::standard::config());
+    vector<edm::ParameterSet> servicePSets;
+    if (histFile != "") {
+      edm::ParameterSet tfsPSet;
+      tfsPSet.addParameter<string>("@service_type", "TFileService");
+      tfsPSet.addParameter<string>("fileName", histFile);
+      servicePSets.push_back(tfsPSet);
+    }
+    edm::ServiceToken serviceToken(edm::ServiceRegistry::createSet(servicePSets));
+    edm::ServiceRegistry::Operate operate(serviceToken);
+
+    Histos* hists = nullptr;
+    if (histFile != "") {
+      hists = new Histos( settings );
+    }
+
+    // Create track fitting algorithms (& internal histograms if they use them)
+    map<string, TrackFitGeneric*> fitterWorkerMap;
+    for (const string& fitterName : settings->trackFitters()) {
+      fitterWorkerMap[ fitterName ] = TrackFitGeneric::create(fitterName, settings);
+      if (hists != nullptr) fitterWorkerMap[ fitterName ]->bookHists();
+      fitterWorkerMap[ fitterName ]->initRun();
+    }
+
+    // Columnar store of the fitted tracks of each event, reused from one event to the next.
+    FittedTrackStore fittedTracks(settings);
+    // Which sectors each stub is inside, reused from one event to the next.
+    SectorMembership sectorMembership;
+    // Track candidates & fitted tracks matched to each tracking particle, reused from one event to the next.
+    TPassocIndex tpAssoc;
+
+    //=== Open input file.
+
+    EventSnapshotReader reader(inputFile);
+    unsigned int nEvents = reader.numEvents();
+    if (maxEvents >= 0 && (unsigned int)(maxEvents) < nEvents) nEvents = maxEvents;
+    cout<<"Replaying "<<nEvents<<" of "<<reader.numEvents()<<" events from "<<inputFile<<endl;
+
+    vector<double> stageTime(NumStages, 0.);
+    const Clock::time_point tJobStart = Clock::now();
+
+    //=== Loop over events, running the same chain as TMTrackProducer::produce().
+
+    for (unsigned int iEvent = 0; iEvent < nEvents; iEvent++) {
+
+      Clock::time_point t0 = Clock::now();
+
+      InputData inputData(reader, iEvent, settings);
+      const vector<const Stub*>& vStubs = inputData.getStubs();
+
+      Clock::time_point t1 = Clock::now();
+      stageTime[InputDecoding] += seconds(t1 - t0);
+
+      if (hists != nullptr) {
+	hists->fillInputData(inputData);
+	stageTime[Histogramming] += seconds(Clock::now() - t1);
+      }
+
+      matrix<Sector>  mSectors(settings->numPhiSectors(), settings->numEtaRegions());
+      matrix<HTpair>  mHtPairs(settings->numPhiSectors(), settings->numEtaRegions());
+
+      // Initialize the sectors, and note which of them each stub is inside (before the stubs are digitized).
+      Clock::time_point tRoute = Clock::now();
+      for (unsigned int iPhiSec = 0; iPhiSec < settings->numPhiSectors(); iPhiSec++) {
+	for (unsigned int iEtaReg = 0; iEtaReg < settings->numEtaRegions(); iEtaReg++) {
+	  mSectors(iPhiSec, iEtaReg).init(settings, iPhiSec, iEtaReg);
+	}
+      }
+      sectorMembership.fill(mSectors, inputData);
+      stageTime[settings->enableDigitize() ? Histogramming : HTfill] += seconds(Clock::now() - tRoute);
+
+      // Fill Hough-Transform arrays with stubs, and look for tracks in them.
+      for (unsigned int iPhiSec = 0; iPhiSec < settings->numPhiSectors(); iPhiSec++) {
+	for (unsigned int iEtaReg = 0; iEtaReg < settings->numEtaRegions(); iEtaReg++) {
+
+	  Clock::time_point t2 = Clock::now();
+
+	  Sector& sector = mSectors(iPhiSec, iEtaReg);
+	  HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
+
+	  htPair.init(settings, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+
+	  if (settings->enableDigitize()) {
+	    for (const Stub* stub: vStubs) {
+	      (const_cast<Stub*>(stub))->digitizeForGPinput(iPhiSec);
+	      if ( sector.inside( stub ) ) {
+		const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
+		(const_cast<Stub*>(stub))->digitizeForHTinput(iPhiSec);
+		htPair.store( stub, inEtaSubSecs );
+	      }
+	    }
+	  } else {
+	    for (const Stub* stub : sectorMembership.stubsInSector(iPhiSec, iEtaReg)) {
+	      htPair.store( stub, sector.insideEtaSubSecs( stub ) );
+	    }
+	  }
+
+	  Clock::time_point t3 = Clock::now();
+	  stageTime[HTfill] += seconds(t3 - t2);
+
+	  htPair.end();
+
+	  stageTime[HTend] += seconds(Clock::now() - t3);
+	}
+      }
+
+      // Fit the track candidates, and optionally remove duplicates among the fitted tracks.
+      KillDupFitTrks killDupFitTrks;
+      killDupFitTrks.init(settings, settings->dupTrkAlgFit());
+
+      fittedTracks.clear(inputData);
+      for (unsigned int iPhiSec = 0; iPhiSec < settings->numPhiSectors(); iPhiSec++) {
+	for (unsigned int iEtaReg = 0; iEtaReg < settings->numEtaRegions(); iEtaReg++) {
+	  const vector<L1track3D>& vecTrk3D = mHtPairs(iPhiSec, iEtaReg).trackCands3D();
+	  fittedTracks.beginSector(vecTrk3D);
+	  for (unsigned int fitterId = 0; fitterId < settings->trackFitters().size(); fitterId++) {
+	    const string& fitterName = settings->trackFitters()[fitterId];
+
+	    Clock::time_point t4 = Clock::now();
+
+	    const vector<L1fittedTrack> fittedTracksInSec = fitterWorkerMap[fitterName]->fitBatch(vecTrk3D, iPhiSec, iEtaReg);
+
+	    Clock::time_point t5 = Clock::now();
+	    stageTime[Fit] += seconds(t5 - t4);
+
+	    const vector<L1fittedTrack> filtFittedTracksInSec = killDupFitTrks.filter( fittedTracksInSec );
+	    fittedTracks.add(fitterId, filtFittedTracksInSec);
+
+	    stageTime[DupRemoval] += seconds(Clock::now() - t5);
+	  }
+	}
+      }
+
+      for (const Stub* stub: vStubs) {
+	if (settings->enableDigitize()) (const_cast<Stub*>(stub))->reset_digitize();
+      }
+
+      if (hists != nullptr) {
+	Clock::time_point t6 = Clock::now();
+	hists->fillEtaPhiSectors(inputData, sectorMembership);
+	hists->fillRphiHT(mHtPairs);
+	hists->fillRZfilters(mHtPairs);
+	if (hists->enabled(Histos::TrackCandHists) || hists->enabled(Histos::TrackFitHists)) tpAssoc.fill(inputData, mHtPairs, fittedTracks);
+	hists->fillTrackCands(inputData, mSectors, sectorMembership, mHtPairs, tpAssoc);
+	hists->fillTrackFitting(inputData, fittedTracks, tpAssoc, settings->chi2OverNdfCut() );
+	stageTime[Histogramming] += seconds(Clock::now() - t6);
+      }
+    }
+
+    const double totTime = seconds(Clock::now() - tJobStart);
+
+    //=== Print timing summary.
+
+    cout<<endl<<"=== tmttReplay timing summary for "<<nEvents<<" events ==="<<endl;
+    cout<<"Event rate = "<<(totTime > 0. ? nEvents/totTime : 0.)<<" events/s ("<<totTime<<" s in total)"<<endl;
+    double sumStages = 0.;
+    for (unsigned int i = 0; i < NumStages; i++) {
+      sumStages += stageTime[i];
+      cout<<"  "<<setw(24)<<left<<stageNames[i]<<right<<setw(12)<<1000.*stageTime[i]/max(nEvents, 1u)<<" ms/event  "
+	  <<setw(8)<<100.*stageTime[i]/max(totTime, 1.e-9)<<" %"<<endl;
+    }
+    cout<<"  "<<setw(24)<<left<<"Other"<<right<<setw(12)<<1000.*(totTime - sumStages)/max(nEvents, 1u)<<" ms/event"<<endl;
+
+    //=== Tidy up. (Histograms are written to file when the TFileService is destroyed).
+
+    if (hists != nullptr) {
+      hists->endJobAnalysis();
+      delete hists;
+    }
+    for (auto& fitter : fitterWorkerMap) delete fitter.second;
+    delete settings;
+
+  } catch (cms::Exception& e) {
+    cout<<"tmttReplay: cms::Exception caught: "<<e.what()<<endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -15,8 +15,8 @@ public:
 protected:
     std::vector<double> seed(const L1track3D& l1track3D);
     std::vector<double> residuals(std::vector<double> x);
-    Matrix<double> D(std::vector<double> x);
-    Matrix<double> Vinv();
+    void D(const std::vector<double>& x, std::vector<double>& d);
+    std::vector<double> Vinv();
     std::map<std::string, double> convertParams(std::vector<double> x);
  
 private:
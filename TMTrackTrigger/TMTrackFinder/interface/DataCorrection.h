@@ -4,7 +4,6 @@
 #include "FWCore/Utilities/interface/Exception.h"
 
 #include <vector>
-#include <map>
 #include <set>
 #include <utility>
 #include <cmath>
@@ -45,124 +44,125 @@ public:
   static void ConvertBarrelBend(float bend, unsigned int layer,
 		float& degradedBend, bool& reject, unsigned int& num)
 	{
-		using namespace std;
-		
-    // Get degraded bend value
-    DataCorrection::ConvertBarrelBendWork(bend, layer, degradedBend, reject);
+    DataCorrection::ConvertBend(DataCorrection::barrelTables(), &DataCorrection::ConvertBarrelBendWork, bend, layer,
+				degradedBend, reject, num);
+  }
 
-    // Determine number of bend values that would lead to same degraded bend value.
-    // This helps understand the loss in bend resolution caused by the bit encoding.
+  //--- Given the original bend and endcap ring number,
+  //--- return the degraded stub bend, a boolean indicating if stub bend was outside the assumed window
+  //--- size programmed below, and an integer indicating how many values of the original bend
+  //--- were grouped together into this single value of the degraded bend.
 
-    // Stores number of bend values merged into a single one by bit encoding, for each layer & bend value.
-    static std::vector< std::map<float, unsigned int> > barrelNums(30); // Dimension to larger than number of barrel laye
-    std::map<float, unsigned int>& storedNum = barrelNums[layer];
-		
-    if (storedNum.find(degradedBend) != storedNum.end()) {
+  static void ConvertEndcapBend(float bend, unsigned int ring,
+   	float& degradedBend, bool& reject, unsigned int& num)
+	{
+    DataCorrection::ConvertBend(DataCorrection::endcapTables(), &DataCorrection::ConvertEndcapBendWork, bend, ring,
+				degradedBend, reject, num);
+  }
 
-      // Calculation already done, so just retrieve it.
-      num = storedNum[degradedBend];
+private:
 
-    } else {
+  // Bend values tabulated are i/2 for -maxI <= i <= maxI, where maxI is larger than the number of unique bend values.
+  static const int maxI = 30;
 
-      // Calculation not yet done, so do it.
+  // Degraded bend, reject flag & number of bend values merged into the degraded one, for each 
+  // tabulated bend value of a given barrel layer or endcap ring.
+  struct BendTable {
+    float        degradedBend[2*maxI + 1];
+    bool         reject      [2*maxI + 1];
+    unsigned int num         [2*maxI + 1];
+  };
 
-      num = 0;
+  typedef void (*BendWork)(float bend, unsigned int layerOrRing, float& degradedBend, bool& reject);
 
-      const int maxI = 30; // A number larger than the number of unique bend values.
-      int maxAcceptedI = -1;
-      float degradedBendI;
-      bool rejectI;
-      std::set<float> uniqueDegradedBends;
-      for (int i = -maxI; i <= maxI; i++) {
-	float bendI = 0.5*float(i);
-	DataCorrection::ConvertBarrelBendWork(bendI, layer, degradedBendI, rejectI);
-	if ( ! rejectI) {
-	  if (abs(maxAcceptedI) < abs(i)) maxAcceptedI = abs(i);
-	  if (degradedBend == degradedBendI) num++;
-	  uniqueDegradedBends.insert(degradedBendI);
-	}
-      }
+  //--- Tables for each barrel layer (1-6) & each endcap ring (1-15), indexed by layer or ring number (entry 0 is unused).
+  //--- They are made on first use and never modified, so can be read concurrently by several threads.
+  //--- (Initialization of a function-local static is thread-safe in C++11).
 
-      //cout<<"Barrel layer="<<layer<<" Bend="<<bend<<" --> "<<degradedBend<<" reject=" <<reject<<" num="<<num<<endl;
+  static const std::vector<BendTable>& barrelTables() {
+    static const std::vector<BendTable> tables = DataCorrection::makeTables(&DataCorrection::ConvertBarrelBendWork, 6, 3, "barrel");
+    return tables;
+  }
 
-      // Store result
-      storedNum[degradedBend] = num;
-    
-      //--- Sanity checks
-      if (maxAcceptedI < 0 || maxAcceptedI == (unsigned int) maxI) throw cms::Exception("DataCorrection:: barrel stub window size wrong. ")<<layer<<" "<<maxAcceptedI<<endl;
-      // Number of degraded bend values should correspond to 3 bits (PS modules) or 4 bits (2S modules),
-      // minus one, where the latter is because the encoding must be symmetric about 0.
-      // Or perhaps less if no bit encoding was required.
-      unsigned int numDegradedBendsExp = (layer <= 3)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
-      numDegradedBendsExp = min(numDegradedBendsExp, (unsigned int)(2*maxAcceptedI + 1)); 
-      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: barrel stub encoding corresponds to wrong number of bits. ")<<layer<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
-    }
+  static const std::vector<BendTable>& endcapTables() {
+    static const std::vector<BendTable> tables = DataCorrection::makeTables(&DataCorrection::ConvertEndcapBendWork, 15, 9, "endcap");
+    return tables;
   }
 
-  //--- Given the original bend and endcap ring number,
-  //--- return the degraded stub bend, a boolean indicating if stub bend was outside the assumed window
-  //--- size programmed below, and an integer indicating how many values of the original bend
-  //--- were grouped together into this single value of the degraded bend.
+  //--- Look up the degraded bend of a stub in the tables of the given barrel layer or endcap ring.
+  //--- Bends that are not in the tables (i.e. not a multiple of 0.5 strips) are degraded by calling the
+  //--- conversion function directly.
 
-  static void ConvertEndcapBend(float bend, unsigned int ring,
-   	float& degradedBend, bool& reject, unsigned int& num)
-	{
-    using namespace std;
+  static void ConvertBend(const std::vector<BendTable>& tables, BendWork work, float bend, unsigned int layerOrRing,
+			  float& degradedBend, bool& reject, unsigned int& num)
+  {
+    // The conversion function throws an exception for unknown layers or rings.
+    if (layerOrRing == 0 || layerOrRing >= tables.size()) work(bend, layerOrRing, degradedBend, reject);
 
-    // Get degraded bend value
-    DataCorrection::ConvertEndcapBendWork(bend, ring, degradedBend, reject);
+    const BendTable& table = tables[layerOrRing];
 
-    // Determine number of bend values that would lead to same degraded bend value.
-    // This helps understand the loss in bend resolution caused by the bit encoding.
+    const float twoBend = 2*bend;
+    if (fabs(twoBend) <= maxI && twoBend == float(int(twoBend))) {
 
-    // Stores number of bend values merged into a single one by bit encoding, for each ring & bend value
-    static std::vector< std::map<float, unsigned int> > endcapNums(30); // Dimension to larger than number of endcap ring
-    std::map<float, unsigned int>& storedNum = endcapNums[ring];
+      const unsigned int j = int(twoBend) + maxI;
+      degradedBend = table.degradedBend[j];
+      reject       = table.reject[j];
+      num          = table.num[j];
 
-    if (storedNum.find(degradedBend) != storedNum.end()) {
+    } else {
 
-      // Calculation already done, so just retrieve it.
-      num = storedNum[degradedBend];
+      work(bend, layerOrRing, degradedBend, reject);
+      num = 0;
+      for (unsigned int k = 0; k < 2*maxI + 1; k++) {
+	if ( ! table.reject[k] && table.degradedBend[k] == degradedBend) num++;
+      }
+    }
+  }
 
-    } else {
+  //--- Make the bend tables of all barrel layers or endcap rings, checking that the encoding is consistent 
+  //--- with the assumed number of bits. Layers or rings numbered up to maxPS contain PS modules.
+
+  static std::vector<BendTable> makeTables(BendWork work, unsigned int numLayersOrRings, unsigned int maxPS, const char* name)
+  {
+    using namespace std;
 
-      // Calculation not yet done, so do it.
+    vector<BendTable> tables(numLayersOrRings + 1);
 
-      num = 0;
+    for (unsigned int lay = 1; lay <= numLayersOrRings; lay++) {
+      BendTable& table = tables[lay];
 
-      const int maxI = 30; // A number larger than the number of unique bend values.
       int maxAcceptedI = -1;
-      float degradedBendI;
-      bool rejectI;
       set<float> uniqueDegradedBends;
       for (int i = -maxI; i <= maxI; i++) {
-	float bendI = 0.5*float(i);
-	DataCorrection::ConvertEndcapBendWork(bendI, ring, degradedBendI, rejectI);
-	if ( ! rejectI) {
-	  if (abs(maxAcceptedI) < abs(i)) maxAcceptedI = abs(i);
-	  maxAcceptedI = i;
-	  if (degradedBend == degradedBendI) num++;
-	  uniqueDegradedBends.insert(degradedBendI);
+	const unsigned int j = i + maxI;
+	work(0.5*float(i), lay, table.degradedBend[j], table.reject[j]);
+	if ( ! table.reject[j]) {
+	  if (maxAcceptedI < abs(i)) maxAcceptedI = abs(i);
+	  uniqueDegradedBends.insert(table.degradedBend[j]);
 	}
       }
 
-      //cout<<"Endcap ring="<<ring<<" Bend="<<bend<<" --> "<<degradedBend<<" reject=" <<reject<<" num="<<num<<endl;
+      // Determine number of bend values that would lead to same degraded bend value.
+      // This helps understand the loss in bend resolution caused by the bit encoding.
+      for (unsigned int j = 0; j < 2*maxI + 1; j++) {
+	table.num[j] = 0;
+	for (unsigned int k = 0; k < 2*maxI + 1; k++) {
+	  if ( ! table.reject[k] && table.degradedBend[k] == table.degradedBend[j]) table.num[j]++;
+	}
+      }
 
-      // Store result
-      storedNum[degradedBend] = num;
-    
       //--- Sanity checks
-      if (maxAcceptedI < 0 || maxAcceptedI == (unsigned int) maxI) throw cms::Exception("DataCorrection:: endcap stub window size wrong. ")<<ring<<" "<<maxAcceptedI<<endl;
+      if (maxAcceptedI < 0 || maxAcceptedI == maxI) throw cms::Exception("DataCorrection:: ")<<name<<" stub window size wrong. "<<lay<<" "<<maxAcceptedI<<endl;
       // Number of degraded bend values should correspond to 3 bits (PS modules) or 4 bits (2S modules),
       // minus one, where the latter is because the encoding must be symmetric about 0.
       // Or perhaps less if no bit encoding was required.
-      unsigned int numDegradedBendsExp = (ring <= 9)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
+      unsigned int numDegradedBendsExp = (lay <= maxPS)  ?  pow(2,3) - 1  :  pow(2,4) - 1;
       numDegradedBendsExp = min(numDegradedBendsExp, (unsigned int)(2*maxAcceptedI + 1)); 
-      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: endcap stub encoding corresponds to wrong number of bits. ")<<ring<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
+      if (uniqueDegradedBends.size() != numDegradedBendsExp) throw cms::Exception("DataCorrection:: ")<<name<<" stub encoding corresponds to wrong number of bits. "<<lay<<" "<<numDegradedBendsExp<<" "<<uniqueDegradedBends.size()<<endl;
     }
-  }
 
-private:
+    return tables;
+  }
 
   // No constructor needed, since all function members are static.
   DataCorrection() = delete;
@@ -0,0 +1,100 @@
+#ifndef __DEMOTESTVECTORWRITER_H__
+#define __DEMOTESTVECTORWRITER_H__
+
+#include <DataFormats/Demonstrator/interface/HardwareStub.h>
+#include <DataFormats/Demonstrator/interface/HardwareStubLinkFormat.h>
+
+#include "boost/numeric/ublas/matrix.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+
+class Settings;
+class HTpair;
+
+//=== Writes the stubs at the output of the HT (as made by DemoOutput::getStubCollection()) to a binary file
+//=== of test vectors for the firmware test benches, with each stub packed into a 64 bit link word
+//=== (see HardwareStubLinkFormat.h). This is much smaller & faster to read than the EDM HardwareStub collections.
+//===
+//=== File layout: one TestVectorFileHeader, describing the fields of the link words, followed for each event
+//=== by a TestVectorEventHeader, a TestVectorSector record for every (eta,phi) sector (iPhiSec outer, iEtaReg inner),
+//=== and then the link words of all the sectors, sector after sector, in the order given by the TestVectorSector records.
+//=== All records are multiples of 8 bytes, so the words can be used in place in a memory mapped file.
+//=== N.B. Native byte order is used. The phi sector & eta region are given by the TestVectorSector records,
+//=== so are not packed in the words.
+
+struct TestVectorField {
+  char         name[12];        // Field name (null terminated).
+  uint8_t      shift;           // Position of least significant bit in word.
+  uint8_t      width;           // Number of bits.
+  uint8_t      isSigned;        // Stored in two's complement?
+  uint8_t      spare;
+};
+
+struct TestVectorFileHeader {
+  char            magic[8];     // "TMTTLINK"
+  uint32_t        version;      // Incremented whenever layout of records changes.
+  uint32_t        format;       // HardwareStubLinkFormat::Format of the words.
+  uint32_t        numBits;      // Number of bits used in each word.
+  uint32_t        numFields;    // Number of fields used below.
+  uint32_t        numPhiSectors;
+  uint32_t        numEtaRegions;
+  TestVectorField fields[16];
+};
+
+struct TestVectorEventHeader {
+  uint32_t     run;
+  uint32_t     lumi;
+  uint64_t     event;
+  uint32_t     nSectors;
+  uint32_t     nWords;
+};
+
+struct TestVectorSector {
+  uint16_t     iPhiSec;
+  uint16_t     iEtaReg;
+  uint32_t     nWords;
+};
+
+static_assert(sizeof(TestVectorFileHeader) % 8 == 0 && sizeof(TestVectorEventHeader) % 8 == 0 && sizeof(TestVectorSector) == 8, "DemoTestVectorWriter: records must preserve 8 byte alignment");
+
+class DemoTestVectorWriter {
+
+public:
+
+  DemoTestVectorWriter(const std::string& fileName, const Settings* settings);
+  ~DemoTestVectorWriter();
+
+  // Append the HT output stubs of one event to the file. The HT arrays are only used to get their dimensions.
+  void write(uint32_t run, uint32_t lumi, uint64_t event, const boost::numeric::ublas::matrix<HTpair>& mHtPairs, const std::vector<l1t::HardwareStub>& hwStubs);
+
+  unsigned int numEventsWritten() const {return nEvents_;}
+
+private:
+
+  // Define the link word format and write the file header (once the HT array dimensions are known).
+  void writeFileHeader(unsigned int nBinsM, unsigned int nBinsC);
+
+  // Not copyable.
+  DemoTestVectorWriter(const DemoTestVectorWriter&) = delete;
+  DemoTestVectorWriter& operator=(const DemoTestVectorWriter&) = delete;
+
+private:
+
+  const Settings*       settings_;
+  std::string           fileName_;
+  std::ofstream         out_;
+  unsigned int          nEvents_;
+
+  std::unique_ptr<l1t::HardwareStubLinkFormat> linkFormat_;
+
+  // Buffers reused from event to event.
+  std::vector<TestVectorSector> vSectors_;
+  std::vector<uint32_t>         vNext_;
+  std::vector<uint64_t>         vWords_;
+};
+
+#endif
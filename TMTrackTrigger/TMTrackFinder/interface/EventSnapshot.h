@@ -0,0 +1,180 @@
+#ifndef __EVENTSNAPSHOT_H__
+#define __EVENTSNAPSHOT_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <type_traits>
+
+class InputData;
+
+//=== Compact binary snapshot of the stubs & tracking particles unpacked by class InputData.
+//=== Allows the MC samples to be converted once with a full CMSSW job, and then replayed many times,
+//=== without EDM input or the tracker geometry, by constructing InputData from an EventSnapshotReader.
+//===
+//=== File layout: one SnapshotFileHeader, followed for each event by a SnapshotEventHeader, nTPs SnapshotTP,
+//=== nStubs SnapshotStub, and nLinks uint32_t (stub to TP truth links), padded to a multiple of 8 bytes.
+//=== All records are plain-old-data, so can be used in place in a memory mapped file.
+//=== N.B. Native byte order is used, so files should be read on the same architecture as they are written.
+//===
+//=== Only the geometry-resolved stub information and raw front-end bend are stored. Quantities depending on
+//=== configuration parameters (degraded bend, front-end cuts, q/Pt bin range ...) are recalculated on replay.
+//=== The TP selection flags are frozen at the time the snapshot is written.
+
+// Index value used in snapshot to indicate that no TP is associated.
+static const int32_t snapshotNoTP = -1;
+
+struct SnapshotFileHeader {
+  char         magic[8];        // "TMTTSNAP"
+  uint32_t     version;         // Incremented whenever layout of records below changes.
+  uint32_t     stubMatchStrict; // Value of "StubMatchStrict" cfg param when file written.
+  uint32_t     sizeOfTP;        // Record sizes, as protection against inconsistent compilation.
+  uint32_t     sizeOfStub;
+};
+
+struct SnapshotEventHeader {
+  uint32_t     run;
+  uint32_t     lumi;
+  uint64_t     event;
+  uint32_t     nTPs;
+  uint32_t     nStubs;
+  uint32_t     nLinks;
+  uint32_t     spare;
+};
+
+struct SnapshotTP {
+  int32_t      pdgId;
+  int32_t      charge;
+  float        mass;
+  float        pt;
+  float        eta;
+  float        theta;
+  float        phi0;
+  float        vx;              // TP production point.
+  float        vy;
+  float        vz;
+  uint8_t      inTimeBx;
+  uint8_t      physicsCollision;
+  uint8_t      useForEff;
+  uint8_t      spare;
+};
+
+struct SnapshotStub {
+  // Stub coordinates & raw bend as available in the front-end chip (sign already corrected in endcap).
+  float        phi;
+  float        r;
+  float        z;
+  float        bendInFrontend;
+  float        localU_cluster[2];
+  float        localV_cluster[2];
+  // Info about the module containing the stub.
+  uint32_t     idDet;
+  float        moduleMinR;
+  float        moduleMaxR;
+  float        moduleMinPhi;
+  float        moduleMaxPhi;
+  float        moduleMinZ;
+  float        moduleMaxZ;
+  float        stripPitch;
+  float        stripLength;
+  float        sensorWidth;
+  uint32_t     nStrips;
+  uint32_t     layerId;
+  uint32_t     endcapRing;
+  uint8_t      psModule;
+  uint8_t      barrel;
+  uint8_t      spare[2];
+  // Truth info, as index in the event's SnapshotTP records (or snapshotNoTP).
+  int32_t      assocTP;
+  int32_t      assocTPofCluster[2];
+  // Location of the indices of all associated TPs (Stub::assocTPs()) in the event's link pool.
+  uint32_t     firstLink;
+  uint32_t     numLinks;
+};
+
+static_assert(std::is_trivially_copyable<SnapshotTP>::value   && std::is_trivially_copyable<SnapshotStub>::value, "EventSnapshot: records must be POD");
+static_assert(sizeof(SnapshotFileHeader) % 8 == 0 && sizeof(SnapshotEventHeader) % 8 == 0, "EventSnapshot: headers must preserve 8 byte alignment");
+
+// Pointers to the records of a single event inside a snapshot file.
+
+struct SnapshotEvent {
+  const SnapshotEventHeader* header;
+  const SnapshotTP*          tps;
+  const SnapshotStub*        stubs;
+  const uint32_t*            links;
+};
+
+//=== Writes InputData of successive events to a snapshot file.
+
+class EventSnapshotWriter {
+
+public:
+
+  EventSnapshotWriter(const std::string& fileName, bool stubMatchStrict);
+  ~EventSnapshotWriter();
+
+  // Append the stubs (including those failing front-end cuts) & TPs of one event to the file.
+  void write(uint32_t run, uint32_t lumi, uint64_t event, const InputData& inputData);
+  // Append one event whose records have been made by other means (e.g. by the StubGenerator).
+  void write(uint32_t run, uint32_t lumi, uint64_t event, const std::vector<SnapshotTP>& vTPs, const std::vector<SnapshotStub>& vStubs, const std::vector<uint32_t>& vLinks);
+
+  unsigned int numEventsWritten() const {return nEvents_;}
+
+private:
+
+  // Not copyable.
+  EventSnapshotWriter(const EventSnapshotWriter&) = delete;
+  EventSnapshotWriter& operator=(const EventSnapshotWriter&) = delete;
+
+private:
+
+  std::string           fileName_;
+  std::ofstream         out_;
+  unsigned int          nEvents_;
+
+  // Buffers reused from event to event.
+  std::vector<SnapshotTP>   vTPs_;
+  std::vector<SnapshotStub> vStubs_;
+  std::vector<uint32_t>     vLinks_;
+};
+
+//=== Gives read-only access to the events in a snapshot file, which is memory mapped.
+
+class EventSnapshotReader {
+
+public:
+
+  explicit EventSnapshotReader(const std::string& fileName);
+  ~EventSnapshotReader();
+
+  unsigned int                      numEvents() const {return events_.size();}
+  // Access the records of event number iEvent (counting from zero in the file).
+  const SnapshotEvent&                  event(unsigned int iEvent) const;
+  // Value of "StubMatchStrict" cfg param used when file was written.
+  bool                        stubMatchStrict() const {return stubMatchStrict_;}
+  const std::string&                 fileName() const {return fileName_;}
+
+private:
+
+  // Memory map the opened file, check its header, and note the location of each event inside it.
+  void mapFile();
+  // Unmap & close the file.
+  void release();
+
+  // Not copyable.
+  EventSnapshotReader(const EventSnapshotReader&) = delete;
+  EventSnapshotReader& operator=(const EventSnapshotReader&) = delete;
+
+private:
+
+  std::string                 fileName_;
+  int                         fd_;
+  const char*                 data_;
+  size_t                      size_;
+  bool                        stubMatchStrict_;
+  std::vector<SnapshotEvent>  events_;
+};
+
+#endif
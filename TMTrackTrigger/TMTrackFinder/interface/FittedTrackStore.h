@@ -0,0 +1,181 @@
+#ifndef __FITTEDTRACKSTORE_H__
+#define __FITTEDTRACKSTORE_H__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+
+class Settings;
+class InputData;
+class L1fittedTrack;
+class TP;
+
+//=== Compact, columnar store of all the fitted tracks found in one event by all the track fitting algorithms.
+//===
+//=== Each fitted track is stored as one entry in a set of parallel arrays (helix parameters, chi2, flags ...),
+//=== rather than as an L1fittedTrack, which carries a copy of its HT track candidate, its stubs & several
+//=== HT helper objects. The fitter is identified by its index in Settings::trackFitters(), the stubs by
+//=== an (offset, length) range in a single per-event pool of stub indices (into InputData::getStubs()),
+//=== the HT track candidate the fit was run on by its index in a per-event list of candidates, and the
+//=== matched truth particle (if any) by its index in InputData::getTPs().
+//===
+//=== Usage: call clear() at the start of each event, beginSector() with the HT track candidates of each
+//=== sector, and then add() with the fitted tracks that each fitter produced from them.
+//=== The HT track candidates & InputData must stay alive as long as the store is used.
+
+class FittedTrackStore {
+
+public:
+
+  //--- Light-weight read-only view of a single fitted track in the store. It gives the same information
+  //--- as the equivalent functions of L1fittedTrack.
+
+  class Track {
+  public:
+    Track(const FittedTrackStore* store, unsigned int i) : store_(store), i_(i) {}
+
+    // Index of this track in the store.
+    unsigned int             index()                    const {return i_;}
+
+    // Fitter which produced this track, both as index in Settings::trackFitters() and as name.
+    unsigned int             fitterId()                 const {return store_->fitterId_[i_];}
+    const std::string&       fitterName()               const {return store_->fitterName(store_->fitterId_[i_]);}
+
+    // Get track candidate from HT (before fit).
+    const L1track3D&         getL1track3D()             const {return *(store_->cands_[store_->cand_[i_]]);}
+
+    // Get number of stubs on fitted track, and index in InputData::getStubs() of the k-th of them.
+    unsigned int             getNumStubs()              const {return store_->stubCount_[i_];}
+    unsigned int             stubIndex(unsigned int k)  const {return store_->stubPool_[store_->stubOffset_[i_] + k];}
+    // Get number of tracker layers these stubs are in.
+    unsigned int             getNumLayers()             const {return store_->nLayers_[i_];}
+    // Get number of stubs deleted from track candidate by fitter (because they had large residuals)
+    unsigned int             getNumKilledStubs()        const {return this->getL1track3D().getNumStubs() - this->getNumStubs();}
+    // Get number of stubs matched to correct TP that were deleted from track candidate by fitter.
+    unsigned int             getNumKilledMatchedStubs() const {return store_->nKilledMatchedStubs_[i_];}
+
+    // Get best matching tracking particle (=nullptr if none).
+    const TP*                getMatchedTP()             const {return store_->matchedTP(i_);}
+    // Get number of matched stubs with this Tracking Particle
+    unsigned int             getNumMatchedStubs()       const {return store_->nMatchedStubs_[i_];}
+    // Get purity of stubs on track (i.e. fraction matching best Tracking Particle)
+    float                    getPurity()                const {return this->getNumMatchedStubs()/float(this->getNumStubs());}
+
+    // Get the fitted track helix parameters.
+    float   qOverPt()      const {return store_->qOverPt_[i_];}
+    float   invPt()        const {return fabs(this->qOverPt());}
+    float   pt()           const {return 1./(1.0e-6 + this->invPt());} // includes protection against 1/pt = 0.
+    float   d0()           const {return store_->d0_[i_];}
+    float   phi0()         const {return store_->phi0_[i_];}
+    float   z0()           const {return store_->z0_[i_];}
+    float   tanLambda()    const {return store_->tanLambda_[i_];}
+    float   theta()        const {return atan2(1., this->tanLambda());} // Use atan2 to ensure 0 < theta < pi.
+    float   eta()          const {return -log(tan(0.5*this->theta()));}
+
+    // Get the number of helix parameters fitted, the degrees of freedom, and the fit chi2 and chi2/DOF.
+    unsigned int nHelixParam() const {return store_->nHelixParam_[i_];}
+    unsigned int numDOF()      const {return 2*this->getNumStubs() - this->nHelixParam();}
+    float   chi2()         const {return store_->chi2_[i_];}
+    float   chi2dof()      const {return this->chi2()/this->numDOF();}
+
+    // Get phi sector and eta region used by track finding code that this track is in.
+    unsigned int iPhiSec() const {return store_->iPhiSec_[i_];}
+    unsigned int iEtaReg() const {return store_->iEtaReg_[i_];}
+
+    // Was the track accepted by the fit ?
+    bool    accepted()     const {return (store_->flags_[i_] & Accepted) != 0;}
+
+  private:
+    const FittedTrackStore* store_;
+    unsigned int            i_;
+  };
+
+  //--- Iterator over the tracks in the store, allowing range-based for loops.
+
+  class const_iterator {
+  public:
+    const_iterator(const FittedTrackStore* store, unsigned int i) : store_(store), i_(i) {}
+    Track           operator*()                             const {return Track(store_, i_);}
+    const_iterator& operator++()                                  {i_++; return *this;}
+    bool            operator!=(const const_iterator& other) const {return i_ != other.i_;}
+  private:
+    const FittedTrackStore* store_;
+    unsigned int            i_;
+  };
+
+public:
+
+  FittedTrackStore(const Settings* settings);
+  ~FittedTrackStore() {}
+
+  // Empty the store at the start of a new event, whose stubs & TPs are in inputData.
+  void clear(const InputData& inputData);
+
+  // Register the HT track candidates of a sector, on which the fitters will subsequently be run.
+  void beginSector(const std::vector<L1track3D>& cands);
+
+  // Store fitted tracks produced by the fitter with the given index in Settings::trackFitters() from the
+  // track candidates registered by the latest call to beginSector().
+  void add(unsigned int fitterId, const std::vector<L1fittedTrack>& fitTrks);
+
+  // Number of tracks stored.
+  unsigned int        size()                          const {return qOverPt_.size();}
+  bool                empty()                         const {return qOverPt_.empty();}
+  Track               operator[](unsigned int i)      const {return Track(this, i);}
+  const_iterator      begin()                         const {return const_iterator(this, 0);}
+  const_iterator      end()                           const {return const_iterator(this, this->size());}
+
+  // Number of fitters & name of each.
+  unsigned int        numFitters()                    const {return fitterNames_.size();}
+  const std::string&  fitterName(unsigned int id)     const {return fitterNames_[id];}
+
+private:
+
+  // Get truth particle matched to i-th track (=nullptr if none).
+  const TP* matchedTP(unsigned int i) const;
+
+  // Find index in cands_ of the HT track candidate from which fitted track was produced.
+  unsigned int findCandidate(const L1fittedTrack& fitTrk);
+
+private:
+
+  // Bits of flags_.
+  enum Flag {Accepted = 1};
+
+  const Settings*              settings_;
+  const InputData*             inputData_;
+  std::vector<std::string>     fitterNames_;
+
+  // HT track candidates of this event, and range of those in the current sector.
+  std::vector<const L1track3D*> cands_;
+  unsigned int                 sectorCandBegin_;
+  unsigned int                 candHint_;
+
+  // Pool of stub indices, shared by all tracks.
+  std::vector<uint32_t>        stubPool_;
+
+  // Columns, with one entry per fitted track.
+  std::vector<float>           qOverPt_;
+  std::vector<float>           d0_;
+  std::vector<float>           phi0_;
+  std::vector<float>           z0_;
+  std::vector<float>           tanLambda_;
+  std::vector<float>           chi2_;
+  std::vector<uint32_t>        stubOffset_;
+  std::vector<uint16_t>        stubCount_;
+  std::vector<uint16_t>        nMatchedStubs_;
+  std::vector<uint16_t>        nKilledMatchedStubs_;
+  std::vector<uint32_t>        cand_;
+  std::vector<int32_t>         matchedTP_; // -1 if none.
+  std::vector<uint8_t>         nLayers_;
+  std::vector<uint8_t>         nHelixParam_;
+  std::vector<uint8_t>         fitterId_;
+  std::vector<uint8_t>         flags_;
+  std::vector<uint16_t>        iPhiSec_;
+  std::vector<uint16_t>        iEtaReg_;
+};
+
+#endif
@@ -94,6 +94,10 @@ public:
 
 protected:
 
+  // Add stub to the table of stubs stored in this HT array, returning its index in the table, which is what the
+  // HT cells store in place of the stub pointer. If eta subsectors are used, specify which ones the stub is compatible with.
+  unsigned int addStubToTable(const Stub* stub, const std::vector<bool>& inSubSecs = std::vector<bool>());
+
   // Given a range in one of the coordinates specified by coordRange, calculate the corresponding range of bins. The other arguments specify the axis. And also if some cells nominally associated to stub are to be killed.
   virtual std::pair<unsigned int, unsigned int> convertCoordRangeToBinRange( std::pair<float, float> coordRange, unsigned int nBinsAxis, float coordAxisMin, float coordAxisBinSize, unsigned int killSomeHTcells, bool debug = false) const;
 
@@ -121,6 +125,10 @@ protected:
   // This has two dimensions, representing the two track helix parameters being varied.
   boost::numeric::ublas::matrix<HTcell> htArray_; 
 
+  // Table of stubs stored in this HT array, and the subsectors each is compatible with (bit i set for subsector i).
+  std::vector<const Stub*>  stubTable_;
+  std::vector<unsigned int> stubSubSecs_;
+
   // Contains algorithm used for duplicate track removal.
   KillDupTrks<L1track2D> killDupTrks_;
 
@@ -28,14 +28,12 @@ public:
   // and (if called from r-phi HT) the bin number of the cell along the q/Pt axis of the r-phi HT array.
   void init(const Settings* settings, bool isRphiHT, float etaMinSector, float etaMaxSector, float qOverPt, unsigned int ibin_qOverPt = 0);
 
-  // Add stub to this cell in HT array.
-  void store (const Stub* stub) { vStubs_.push_back(stub); }
-
-  // Add stub to this cell in HT array, indicating also which subsectors within the sector is consistent with.
-  void store (const Stub* stub, const std::vector<bool>& inSubSecs) { this->store(stub); subSectors_[stub] = inSubSecs; if (inSubSecs.size() != numSubSecs_) throw cms::Exception("HTcell: Wrong number of subsectors!");}
+  // Add stub to this cell in HT array, specifying its index in the stub table of the HT array (see HTbase::addStubToTable()).
+  void store (unsigned int iStub) { vStubs_.push_back(iStub); }
 
   // Termination. Search for track in this HT cell etc.
-  void end();
+  // Requires the stub table of the HT array, and the subsectors each stub in it is consistent with (as a bit mask).
+  void end(const std::vector<const Stub*>& stubTable, const std::vector<unsigned int>& stubSubSecs);
 
   //=== Get results
   //=== Most of these functions operate on the filtered stubs, which are stubs passing any requested stub filters (e.g. bend filter). 
@@ -47,8 +45,9 @@ public:
   // Check if a specific stub is in this cell and survived filtering.
   bool stubInCell( const Stub* stub ) const { return (std::count(vFilteredStubs_.begin(), vFilteredStubs_.end(), stub ) > 0); }
 
-  // Check if a specific stub was stored to this cell (without checking if it survived filtering).
-  bool stubStoredInCell( const Stub* stub ) const { return (std::count(vStubs_.begin(), vStubs_.end(), stub ) > 0); }
+  // Check if a specific stub, identified by its index in the stub table of the HT array, was stored to this cell 
+  // (without checking if it survived filtering).
+  bool stubStoredInCell( unsigned int iStub ) const { return (std::count(vStubs_.begin(), vStubs_.end(), iStub ) > 0); }
 
   // Return info useful for deciding if there is a track candidate in this cell.
   unsigned int numStubs()         const { return vFilteredStubs_.size(); }      // Number of filtered stubs 
@@ -77,18 +76,20 @@ private:
   unsigned int calcNumFilteredLayers()  const { return Utility::countLayers( settings_, vFilteredStubs_ ); }
 
   // Calculate how many tracker layers the filter stubs in this cell are in, when only the subset of those stubs
-  // that are in the specified subsector are counted.
-  unsigned int calcNumFilteredLayers(unsigned int iSubSec) const;
+  // that are in the specified subsector are counted. The stubs are specified by their index in the stub table.
+  unsigned int calcNumFilteredLayers(unsigned int iSubSec, const std::vector<unsigned int>& filteredStubs, 
+                                     const std::vector<const Stub*>& stubTable, const std::vector<unsigned int>& stubSubSecs) const;
 
   // Estimate track bend angle at a given radius, derived using the track q/Pt at the centre of this HT cell, ignoring scattering.
   float dphi(float rad) const { return (invPtToDphi_ * rad * qOverPtCell_); }
 
-  // Produce a filtered collection of stubs in this cell that all have consistent bend
-  std::vector<const Stub*> bendFilter( const std::vector<const Stub*>& stubs ) const;
+  // Produce a filtered collection of stubs in this cell that all have consistent bend.
+  // The stubs are specified by their index in the stub table.
+  std::vector<unsigned int> bendFilter( const std::vector<unsigned int>& stubs, const std::vector<const Stub*>& stubTable ) const;
 
   // Filter stubs so as to prevent more than specified number of stubs being stored in one cell.
   // This reflects finite memory of hardware.
-  std::vector<const Stub*> maxStubCountFilter( const std::vector<const Stub*>& stubs ) const;
+  std::vector<unsigned int> maxStubCountFilter( const std::vector<unsigned int>& stubs ) const;
 
 private:
   //=== Configuration parameters
@@ -127,13 +128,11 @@ private:
 
   //=== data
 
-  std::vector<const Stub*> vStubs_; // Stubs in this cell
+  std::vector<unsigned int> vStubs_; // Stubs in this cell, as indices in the stub table of the HT array.
   std::vector<const Stub*> vFilteredStubs_; // Stubs in cell selected by applying all requested stub filters (e.g. bend and/or eta filter ...)
 
   unsigned int numFilteredLayersInCell_; // How many tracker layers these filtered stubs are in
   unsigned int numFilteredLayersInCellBestSubSec_; // Ditto, but requiring all stubs to be in same subsector to be counted. This number is the highest layer count found in any of the subsectors in this sector.
-
-  std::map<const Stub*, std::vector<bool>> subSectors_; // Indicate which subsectors within the sector this stub is consistent with.
 };
 #endif
 
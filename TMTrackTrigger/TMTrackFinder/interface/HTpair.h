@@ -14,6 +14,7 @@
 class Settings;
 class Stub;
 class TP;
+class StageTimers;
 
 
 
@@ -30,12 +31,15 @@ class HTpair {
 
 public:
   
-  HTpair() {}
+  HTpair() : stageTimers_(nullptr) {}
   ~HTpair(){}
 
   // Initialization
   void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector);
 
+  // Optionally time the r-z filters run inside end() separately from the rest of it.
+  void setStageTimers(StageTimers* stageTimers) {stageTimers_ = stageTimers;}
+
   // Add stub to r-phi HT array.
   // If eta subsectors are being used within each sector, specify which ones the stub is compatible with.
   void store( const Stub* stub, const std::vector<bool>& inEtaSubSecs);
@@ -99,6 +103,9 @@ private:
   // Contains algorithm used for duplicate track removal.
   KillDupTrks<L1track3D> killDupTrks_;
 
+  // Optional timers of processing stages (not owned).
+  StageTimers* stageTimers_;
+
   // List of all found 3D track candidates and their associated properties.
   std::vector<L1track3D> vecTracks3D_;
 
@@ -25,7 +25,11 @@ public:
   ~HTrphi(){}
 
   // Initialization with eta range covered by sector and phi coordinate of its centre.
-  void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector);
+  void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector) {
+    this->init(settings, etaMinSector, etaMaxSector, phiCentreSector, true);
+  }
+  // Ditto, but optionally without booking the array of cells, if only the axes are needed (e.g. by getCell()).
+  void init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector, bool bookArray);
 
   // Add stub to HT array.
   // If eta subsectors are being used within each sector, specify which ones the stub is compatible with.
@@ -0,0 +1,87 @@
+#ifndef __HISTOSET_H__
+#define __HISTOSET_H__
+
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include <TH1.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+
+//=== Books histograms, keeping a list of them in booking order.
+//===
+//=== The "master" set books its histograms in the TFileService output file, exactly like TFileDirectory.
+//=== A "shard" books the same histograms privately (not written to the output file), so that it can be filled by
+//=== another thread, without locking, at the same time as the master. Since the master & its shards book their
+//=== histograms in the same order, merge() can then add the contents of each shard to the master's histograms.
+//===
+//=== Usage: replace "TFileDirectory dir = fs->mkdir(name)" by "HistoSet::Dir dir = histoSet.mkdir(name)".
+//=== N.B. Shards must be booked in the same thread as the master (since ROOT's booking is not thread-safe),
+//=== and merged before any quantities (e.g. efficiencies) are derived from the master's histograms.
+
+class HistoSet {
+
+public:
+
+  //--- Directory in which histograms are booked, with the same interface as TFileDirectory.
+
+  class Dir {
+  public:
+    Dir(HistoSet* set, TFileDirectory* tDir) : set_(set), tDir_(tDir) {}
+
+    template<typename T, typename ... Args>
+    T* make(const Args& ... args) const {
+      T* obj;
+      if (tDir_ != nullptr) {
+        obj = tDir_->make<T>(args ...);
+      } else {
+        // Don't attach histogram to the current ROOT directory.
+        const bool addDir = TH1::AddDirectoryStatus();
+        TH1::AddDirectory(false);
+        obj = new T(args ...);
+        TH1::AddDirectory(addDir);
+        set_->owned_.push_back( std::unique_ptr<TObject>(obj) );
+      }
+      set_->add(obj);
+      return obj;
+    }
+
+  private:
+    HistoSet*                       set_;
+    std::shared_ptr<TFileDirectory> tDir_; // null if shard.
+  };
+
+public:
+
+  HistoSet(bool shard) : shard_(shard) {}
+  ~HistoSet() {}
+
+  // Is this a shard, whose histograms are not written to the output file?
+  bool isShard() const {return shard_;}
+
+  // Create directory in which to book histograms.
+  Dir mkdir(const std::string& name);
+
+  // Number of histograms booked.
+  unsigned int size() const {return hists_.size();}
+
+  // Add the contents of the histograms of a shard to the corresponding ones of this set.
+  void merge(const HistoSet& shard);
+
+private:
+
+  // Note booked histogram (or ignore other ROOT objects, such as graphs).
+  void add(TH1* hist)    {hists_.push_back(hist);}
+  void add(TObject*)     {}
+
+private:
+
+  bool                                  shard_;
+  edm::Service<TFileService>            fs_;
+  std::vector<TH1*>                     hists_;  // Histograms in booking order.
+  std::vector<std::unique_ptr<TObject>> owned_;  // Objects booked by shard.
+};
+
+#endif
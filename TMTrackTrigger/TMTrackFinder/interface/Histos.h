@@ -1,9 +1,8 @@
 #ifndef __HISTOS_H__
 #define __HISTOS_H__
 
-#include "FWCore/ServiceRegistry/interface/Service.h"
-#include "CommonTools/UtilAlgos/interface/TFileService.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HistoSet.h"
 
 #include "boost/numeric/ublas/matrix.hpp"
 
@@ -18,8 +17,11 @@
 class InputData;
 class TP;
 class Sector;
+class SectorMembership;
 class HTpair;
 class L1fittedTrack;
+class FittedTrackStore;
+class TPassocIndex;
 class L1fittedTrk4and5;
 class TH1F;
 class TH2F;
@@ -28,34 +30,52 @@ class TGraphAsymmErrors;
 
 class Histos {
 
+public:
+	// Families of histograms. Each can be disabled with cfg param HistosDisabled, in which case its fill code is skipped.
+	// Each enabled family is booked when first filled, (so e.g. the r-z filter histograms are only booked if a filter is used).
+	enum Family {InputDataHists, EtaPhiSectorHists, RphiHTHists, RZfilterHists, BusyEventHists, TrackCandHists, TrackFitHists, NumFamilies};
+
 public:
 	// Store cfg parameters.
-	Histos(const Settings* settings) : settings_(settings), numPerfRecoTPforAlg_(0) {}
+	// If "shard" is true, the histograms are not written to the output file, but must be merged into another Histos object.
+	Histos(const Settings* settings, bool shard = false);
 
 	~Histos(){}
 
-	// Book all histograms
+	// Book all enabled histograms now, rather than when first filled.
+	// (Needed if the histograms are filled in other threads, since ROOT can't book histograms in several threads at once).
 	void book();
 
+	// Is given family of histograms enabled?
+	bool enabled(Family family) const {return enabled_[family];}
+
 	// Fill histograms with stubs and tracking particles from input data.
 	void fillInputData(const InputData& inputData);
 	// Fill histograms that check if choice of (eta,phi) sectors is good.
-	void fillEtaPhiSectors(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors);
+	void fillEtaPhiSectors(const InputData& inputData, const SectorMembership& sectorMembership);
 	// Fill histograms checking filling of r-phi HT array.
 	void fillRphiHT(const boost::numeric::ublas::matrix<HTpair>& mHtPairs);
 	// Book histograms about r-z track filters (or other filters applied after r-phi HT array).
 	void fillRZfilters(const boost::numeric::ublas::matrix<HTpair>& mHtPairs);
 	// Fill histograms studying track candidates found by Hough Transform.
-	void fillTrackCands(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const boost::numeric::ublas::matrix<HTpair>& mHtPairs);
+	void fillTrackCands(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const SectorMembership& sectorMembership, const boost::numeric::ublas::matrix<HTpair>& mHtPairs, const TPassocIndex& tpAssoc);
 	// Fill histograms studying freak, events with too many stubs..
-	void fillStudyBusyEvents(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const boost::numeric::ublas::matrix<HTpair>& mHtPairs);
+	void fillStudyBusyEvents(const InputData& inputData, const SectorMembership& sectorMembership, const boost::numeric::ublas::matrix<HTpair>& mHtPairs);
 	// Fill histograms relating to track fitting performance.
-	void fillTrackFitting(const InputData& inputData, const std::vector<std::pair<std::string,L1fittedTrack>>& fittedTracks, float chi2dofCutPlots);
+	void fillTrackFitting(const InputData& inputData, const FittedTrackStore& fittedTracks, const TPassocIndex& tpAssoc, float chi2dofCutPlots);
+
+	// Create & book a private copy ("shard") of all the histograms, which another thread can fill at the same time as this one.
+	Histos* bookShard() const;
+	// Add the contents of a shard to these histograms. Call this before endJobAnalysis().
+	void mergeShard(const Histos& shard);
 
 	void endJobAnalysis();
 
 private:
 
+	// If given family of histograms is enabled, book it if not yet done, and return true.
+	bool use(Family family);
+
 	// Book histograms for specific topics.
 	void bookInputData();
 	void bookEtaPhiSectors();
@@ -73,13 +93,18 @@ private:
 	// Understand why not all tracking particles were reconstructed.
 	// Returns list of tracking particles that were not reconstructed and an integer indicating why.
 	// Only considers TP used for algorithmic efficiency measurement.
-	std::map<const TP*, std::string> diagnoseTracking(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const boost::numeric::ublas::matrix<HTpair>& mHtPairs) const;
+	std::map<const TP*, std::string> diagnoseTracking(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const SectorMembership& sectorMembership, const TPassocIndex& tpAssoc) const;
 
 private:
 
 	const Settings *settings_; // Configuration parameters.
 
-	edm::Service<TFileService> fs_;
+	// Booked histograms (in output file, or private if this is a shard).
+	HistoSet histoSet_;
+
+	// Which families of histograms are enabled & booked.
+	bool enabled_[NumFamilies];
+	bool booked_[NumFamilies];
 
 	// Histograms of input data.
 	TProfile* profNumStubs_;
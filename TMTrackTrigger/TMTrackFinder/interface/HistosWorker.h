@@ -0,0 +1,116 @@
+#ifndef __HISTOSWORKER_H__
+#define __HISTOSWORKER_H__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/SectorMembership.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TPassocIndex.h"
+
+#include "boost/numeric/ublas/matrix.hpp"
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+class Settings;
+class Histos;
+
+//=== All results of the L1 track finding in one event that the Histos class looks at.
+//=== Once handed to the HistosWorker, they are no longer modified, so can be histogrammed by another thread.
+
+struct HistosEvent {
+
+  HistosEvent(const Settings* settings);
+
+  // Prepare for a new event, taking ownership of its input data, and creating fresh sectors & HT arrays.
+  void reset(InputData* newInputData);
+
+  std::unique_ptr<InputData>             inputData;
+  boost::numeric::ublas::matrix<Sector>  mSectors;
+  SectorMembership                       sectorMembership; // N.B. Reused from one event to the next.
+  boost::numeric::ublas::matrix<HTpair>  mHtPairs;
+  FittedTrackStore                       fittedTracks; // N.B. Reused from one event to the next.
+  TPassocIndex                           tpAssoc;      // Filled by the HistosWorker. Reused from one event to the next.
+
+private:
+  const Settings* settings_;
+};
+
+//=== Fills the Histos class with the results of each event.
+//===
+//=== If option AsyncHistos is off, each event is histogrammed immediately. If it is on, it is instead put in a
+//=== bounded queue, and histogrammed by a separate thread, while the track finding proceeds with the next event.
+//=== If the queue is full, fill() waits until the thread has caught up.
+//=== With option AsyncHistosThreads > 1, several threads take events from the queue. Each thread after the first
+//=== fills its own private copy ("shard") of the histograms, and these are added to the Histos ones by finish(),
+//=== in a fixed order. Either way, the histogram contents are the same, (apart from rounding of the sums of weights).
+//===
+//=== Usage: each event, get a HistosEvent from newEvent(), fill it with the event's results, and pass it to fill().
+//=== Call finish() before Histos::endJobAnalysis(), which also merges the histogram shards.
+//===
+//=== N.B. Nothing else may fill the histograms owned by Histos while the thread is running,
+//=== and the stubs of a HistosEvent must not be digitized once it is passed to fill().
+
+class HistosWorker {
+
+public:
+
+  HistosWorker(const Settings* settings, Histos* hists);
+  ~HistosWorker();
+
+  // Get an empty HistosEvent, reusing one that has already been histogrammed if possible.
+  std::unique_ptr<HistosEvent> newEvent();
+
+  // Fill histograms with the results of an event (possibly later, in the separate thread).
+  void fill(std::unique_ptr<HistosEvent> event);
+
+  // Wait until all events passed to fill() have been histogrammed.
+  // (e.g. before changing Settings that the histogramming uses).
+  void wait();
+
+  // Histogram all remaining events, stop the separate threads, and merge their histograms into the Histos ones.
+  void finish();
+
+private:
+
+  // Fill given histograms with the results of an event.
+  void fillHists(Histos* hists, HistosEvent& event);
+
+  // Main loop of each separate thread, which fills the given histograms.
+  void run(Histos* hists);
+
+  // Stop the separate threads, once they have histogrammed all remaining events.
+  void stopThreads();
+
+  // Rethrow any exception that occurred in the separate thread, unless already done.
+  void rethrow();
+
+  // Has an exception occurred in the separate thread, which hasn't yet been rethrown?
+  bool errorPending() const {return (error_ != nullptr && ! errorReported_);}
+
+private:
+
+  const Settings* settings_;
+  Histos*         hists_;
+  bool            async_;
+  unsigned int    maxQueueSize_;
+
+  std::vector<std::thread>                   threads_;
+  std::vector<Histos*>                       shards_; // Histograms filled by all threads after the first.
+  std::mutex                                 mutex_; // Protects the members below.
+  std::condition_variable                    cond_;
+  std::deque<std::unique_ptr<HistosEvent>>   queue_; // Events waiting to be histogrammed.
+  std::vector<std::unique_ptr<HistosEvent>>  done_;  // Events already histogrammed, for reuse.
+  unsigned int                               nBusy_; // Number of threads histogramming an event.
+  bool                                       stop_;
+  std::exception_ptr                         error_; // First error in the separate threads. (Kept, so later events are discarded).
+  bool                                       errorReported_; // Has error_ been rethrown?
+};
+
+#endif
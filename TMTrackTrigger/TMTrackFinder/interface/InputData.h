@@ -3,11 +3,15 @@
 
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/StubTable.h"
 #include "FWCore/Framework/interface/Frameworkfwd.h"
 
 #include <vector>
 
 class Settings;
+class ModuleGeometryCache;
+class EventSnapshotReader;
+struct SnapshotEvent;
 
 
 //=== Unpacks stub & tracking particle (truth) data into user-friendlier format in Stub & TP classes.
@@ -16,24 +20,40 @@ class Settings;
 class InputData
 {
 public:
-	InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings);
+	// The info about each tracker module is taken from moduleCache, which is filled from the tracker geometry as needed.
+	InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings, ModuleGeometryCache* moduleCache);
+	// Alternatively unpack event number iEvent from a snapshot file, without needing EDM or the tracker geometry.
+	// (The B-field must already have been set in Settings).
+	InputData(const EventSnapshotReader& reader, unsigned int iEvent, Settings* settings);
+	// Or from snapshot records already in memory, e.g. made by the StubGenerator.
+	InputData(const SnapshotEvent& snapEvent, Settings* settings);
 
 	// Get tracking particles
 	const std::vector<TP>&          getTPs()      const {return vTPs_;}
 	// Get stubs that would be output by the front-end readout electronics 
 	const std::vector<const Stub*>& getStubs()    const {return vStubs_;}
+	// Get the same stubs as a structure-of-arrays table, holding their undigitized coordinates & bend.
+	const StubTable&                getStubTable() const {return stubTable_;}
 
 	//--- of minor importance ...
 
 	// Get number of stubs prior to applying tighted front-end readout electronics cuts specified in section StubCuts of Analyze_Defaults_cfi.py. (Only used to measure the efficiency of these cuts).
 	const std::vector<Stub>&        getAllStubs() const {return vAllStubs_;}
 
+private:
+	// Create the Stub & TP objects from the snapshot records of one event.
+	void unpackSnapshot(const SnapshotEvent& snapEvent, Settings* settings);
+	// Note list of stubs produced by each tracking particle.
+	void fillTruthOfTPs();
+
 private:
 	// tracking particles
 	std::vector<TP> vTPs_;
 	
 	// stubs that would be output by the front-end readout electronics.
 	std::vector<const Stub*> vStubs_;
+	// the same stubs, as a structure-of-arrays table.
+	StubTable stubTable_;
 
 	//--- of minor importance ...
 
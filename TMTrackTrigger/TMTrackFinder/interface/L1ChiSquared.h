@@ -29,8 +29,8 @@ protected:
     /* Methods */
     virtual std::vector<double> seed(const L1track3D& l1track3D)=0;
     virtual std::vector<double> residuals(std::vector<double> x)=0;
-    virtual Matrix<double> D(std::vector<double> x)=0; // derivatives
-    virtual Matrix<double> Vinv()=0; // Covariances
+    virtual void D(const std::vector<double>& x, std::vector<double>& d)=0; // derivatives (2*nStubs x nPar_, row major)
+    virtual std::vector<double> Vinv()=0; // Diagonal of inverse covariance matrix (2 entries per stub)
     virtual std::map<std::string, double> convertParams(std::vector<double> x)=0;
  
     /* Variables */
@@ -43,8 +43,22 @@ protected:
  
 private:
 
-    void calculateChiSq( std::vector<double> resids );
-    void calculateDeltaChiSq( std::vector<double> deltaX, std::vector<double> covX );
+    // Maximum number of helix params supported by the normal equation solver.
+    static const unsigned int maxPar_ = 5;
+
+    void calculateChiSq( const std::vector<double>& resids );
+    void calculateDeltaChiSq( const std::vector<double>& deltaX, const std::vector<double>& covX );
+
+    // Linearised fit step: build the normal equations M*deltaX = covX from the derivatives at x and
+    // the cached diagonal Vinv, and solve them.
+    void fitStep( const std::vector<double>& x, const std::vector<double>& resids, std::vector<double>& deltaX, std::vector<double>& covX );
+
+    // Solve M*x = b by Cholesky decomposition of the symmetric n x n matrix M (n <= maxPar_),
+    // returning false if M is not positive definite.
+    static bool solveCholesky( unsigned int n, const double M[maxPar_][maxPar_], const double b[maxPar_], double x[maxPar_] );
+
+    std::vector<double> vinv_;  // Cached diagonal Vinv of stubs_
+    std::vector<double> d_;     // Derivatives buffer, reused between iterations
 
     int numFittingIterations_;
     int killTrackFitWorstHit_;
@@ -36,15 +36,28 @@ public:
                 unsigned int iPhiSec, unsigned int iEtaReg, bool accepted = true) :
     L1trackBase(),
     settings_(settings),
-    l1track3D_(l1track3D), stubs_(stubs),
+    l1track3D_(l1track3D),
     qOverPt_(qOverPt), d0_(d0), phi0_(phi0), z0_(z0), tanLambda_(tanLambda), 
     chi2_(chi2), nHelixParam_(nHelixParam),
     iPhiSec_(iPhiSec), iEtaReg_(iEtaReg), accepted_(accepted)
   {
-    nLayers_   = Utility::countLayers(settings, stubs); // Count tracker layers these stubs are in
-    matchedTP_ = Utility::matchingTP(settings, stubs, nMatchedLayers_, matchedStubs_); // Find associated truth particle & calculate info about match.
+    if (stubs == l1track3D.getStubs()) {
+      // The fit kept all the stubs of the HT track, so share its list of stubs & truth match instead of copying them.
+      stubs_          = l1track3D.getStubList();
+      nLayers_        = l1track3D.getNumLayers();
+      matchedTP_      = l1track3D.getMatchedTP();
+      matchedStubs_   = l1track3D.getMatchedStubList();
+      nMatchedLayers_ = l1track3D.getNumMatchedLayers();
+    } else {
+      stubs_     = makeStubList(stubs);
+      nLayers_   = Utility::countLayers(settings, *stubs_); // Count tracker layers these stubs are in
+      std::vector<const Stub*> matchedStubs;
+      matchedTP_ = Utility::matchingTP(settings, *stubs_, nMatchedLayers_, matchedStubs); // Find associated truth particle & calculate info about match.
+      matchedStubs_ = makeStubList(std::move(matchedStubs));
+    }
     secTmp_.init(settings, iPhiSec, iEtaReg); //Sector class used to check if fitted track trajectory is in expected sector.
-    htRphiTmp_.init(settings, secTmp_.etaMin(), secTmp_.etaMax(), secTmp_.phiCentre()); // HT class used to identify HT cell that corresponds to fitted helix parameters.
+    const bool bookArray = false; // Only the HT axes are needed, not its array of cells.
+    htRphiTmp_.init(settings, secTmp_.etaMin(), secTmp_.etaMax(), secTmp_.phiCentre(), bookArray); // HT class used to identify HT cell that corresponds to fitted helix parameters.
   }
 
   ~L1fittedTrack() {}
@@ -56,9 +69,11 @@ public:
   const L1track3D&            getL1track3D()          const  {return l1track3D_;}
 
   // Get stubs on fitted track (can differ from those on HT track if track fit kicked out stubs with bad residuals)
-  const std::vector<const Stub*>&  getStubs()              const  {return stubs_;}  
+  const std::vector<const Stub*>&  getStubs()              const  {return *stubs_;}  
+  // Get shared list of stubs on fitted track.
+  const StubList&             getStubList()           const  {return stubs_;}
   // Get number of stubs on fitted track.
-  unsigned int                getNumStubs()           const  {return stubs_.size();}
+  unsigned int                getNumStubs()           const  {return stubs_->size();}
   // Get number of tracker layers these stubs are in.
   unsigned int                getNumLayers()          const  {return nLayers_;}
   // Get number of stubs deleted from track candidate by fitter (because they had large residuals)
@@ -74,9 +89,9 @@ public:
   // Get best matching tracking particle (=nullptr if none).
   const TP*                   getMatchedTP()          const  {return matchedTP_;}
   // Get the matched stubs with this Tracking Particle
-  const std::vector<const Stub*>&  getMatchedStubs()       const  {return matchedStubs_;}
+  const std::vector<const Stub*>&  getMatchedStubs()       const  {return *matchedStubs_;}
   // Get number of matched stubs with this Tracking Particle
-  unsigned int                getNumMatchedStubs()    const  {return matchedStubs_.size();}
+  unsigned int                getNumMatchedStubs()    const  {return matchedStubs_->size();}
   // Get number of tracker layers with matched stubs with this Tracking Particle 
   unsigned int                getNumMatchedLayers()   const  {return nMatchedLayers_;}
   // Get purity of stubs on track (i.e. fraction matching best Tracking Particle)
@@ -86,9 +101,8 @@ public:
     unsigned int nStubCount = l1track3D_.getNumMatchedStubs();
     if (nStubCount > 0) { // Original HT track candidate did match a truth particle
       const TP* tp = l1track3D_.getMatchedTP(); 
-      for (const Stub* s : stubs_) {
-	std::set<const TP*> assTPs = s->assocTPs();
-        if (assTPs.find(tp) != assTPs.end()) nStubCount--; // We found a stub matched to original truth particle that survived fit.
+      for (const Stub* s : *stubs_) {
+        if (s->assocTPs().contains(tp)) nStubCount--; // We found a stub matched to original truth particle that survived fit.
       }
     }
     return nStubCount;
@@ -179,11 +193,9 @@ private:
   L1track3D                l1track3D_;
 
   //--- The stubs on the fitted track (can differ from those on HT track if fit kicked off stubs with bad residuals)
-  std::vector<const Stub*> stubs_;
+  StubList                 stubs_;
   unsigned int             nLayers_;
 
-  HTrphi shit;
-
   //--- The fitted helix parameters and fit chi-squared.
   float qOverPt_;
   float d0_;
@@ -201,7 +213,7 @@ private:
 
   //--- Information about its association (if any) to a truth Tracking Particle.
   const TP*                matchedTP_;
-  std::vector<const Stub*> matchedStubs_;
+  StubList                 matchedStubs_;
   unsigned int             nMatchedLayers_;
 
   //--- Has the track fit declared this to be a valid track?
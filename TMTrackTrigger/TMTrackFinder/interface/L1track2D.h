@@ -28,6 +28,16 @@ public:
 	  std::pair<unsigned int, unsigned int> cellLocation,
 		std::pair<float, float>               helix2D,
 		bool isRphi
+	) : 
+		L1track2D(settings, makeStubList(stubs), cellLocation, helix2D, isRphi)
+  {}
+
+  // Ditto, but sharing an existing list of stubs (e.g. that of another track) rather than copying it.
+  L1track2D(const Settings* settings,
+		const StubList&                       stubs, 
+	  std::pair<unsigned int, unsigned int> cellLocation,
+		std::pair<float, float>               helix2D,
+		bool isRphi
 	) : 
 		L1trackBase(),
 		settings_(settings),
@@ -39,8 +49,10 @@ public:
 		estZ0_(0.),
 		estTanLambda_(0.)
   {
-    nLayers_   = Utility::countLayers(settings, stubs); // Count tracker layers these stubs are in
-    matchedTP_ = Utility::matchingTP(settings, stubs, nMatchedLayers_, matchedStubs_); // Find associated truth particle & calculate info about match.
+    nLayers_   = Utility::countLayers(settings, *stubs_); // Count tracker layers these stubs are in
+    std::vector<const Stub*> matchedStubs;
+    matchedTP_ = Utility::matchingTP(settings, *stubs_, nMatchedLayers_, matchedStubs); // Find associated truth particle & calculate info about match.
+    matchedStubs_ = makeStubList(std::move(matchedStubs));
   }
 
   ~L1track2D() {}
@@ -48,9 +60,11 @@ public:
   //--- Get information about the reconstructed track.
 
   // Get stubs on track candidate.
-  const std::vector<const Stub*>&       getStubs()              const  {return stubs_;}  
+  const std::vector<const Stub*>&       getStubs()              const  {return *stubs_;}  
+  // Get shared list of stubs on track candidate, so another track can use the same stubs without copying them.
+  const StubList&                       getStubList()           const  {return stubs_;}
   // Get number of stubs on track candidate.
-  unsigned int                          getNumStubs()           const  {return stubs_.size();}
+  unsigned int                          getNumStubs()           const  {return stubs_->size();}
   // Get number of tracker layers these stubs are in.
   unsigned int                          getNumLayers()          const  {return nLayers_;}
   // Get cell location of track candidate in Hough Transform array in units of bin number.
@@ -94,9 +108,9 @@ public:
   // Get matching tracking particle (=nullptr if none).
   const TP*                          getMatchedTP() const   {return matchedTP_;}
   // Get the matched stubs.
-  const std::vector<const Stub*>& getMatchedStubs() const   {return matchedStubs_;}
+  const std::vector<const Stub*>& getMatchedStubs() const   {return *matchedStubs_;}
   // Get number of matched stubs.
-  unsigned int                 getNumMatchedStubs() const   {return matchedStubs_.size();}
+  unsigned int                 getNumMatchedStubs() const   {return matchedStubs_->size();}
   // Get number of tracker layers with matched stubs.
   unsigned int                getNumMatchedLayers() const   {return nMatchedLayers_;}
 
@@ -109,7 +123,7 @@ private:
   const Settings*                       settings_; 
 
   //--- Information about the reconstructed track from Hough transform.
-  std::vector<const Stub*>              stubs_;
+  StubList                              stubs_;
   unsigned int                          nLayers_;
   std::pair<unsigned int, unsigned int> cellLocation_; 
   std::pair<float, float>               helix2D_; 
@@ -122,7 +136,7 @@ private:
 
   //--- Information about its association (if any) to a truth Tracking Particle.  
   const TP*                             matchedTP_;
-  std::vector<const Stub*>              matchedStubs_;
+  StubList                              matchedStubs_;
   unsigned int                          nMatchedLayers_;
 };
 #endif
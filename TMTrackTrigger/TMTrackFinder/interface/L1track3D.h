@@ -23,14 +23,23 @@ public:
   L1track3D(const Settings* settings, const std::vector<const Stub*>& stubs,
             std::pair<unsigned int, unsigned int> cellLocationRphi, std::pair<float, float> helixRphi,
             std::pair<unsigned int, unsigned int> cellLocationRz,   std::pair<float, float> helixRz) : 
+    L1track3D(settings, makeStubList(stubs), cellLocationRphi, helixRphi, cellLocationRz, helixRz)
+  {}
+
+  // Ditto, but sharing an existing list of stubs (e.g. that of a 2D track) rather than copying it.
+  L1track3D(const Settings* settings, const StubList& stubs,
+            std::pair<unsigned int, unsigned int> cellLocationRphi, std::pair<float, float> helixRphi,
+            std::pair<unsigned int, unsigned int> cellLocationRz,   std::pair<float, float> helixRz) : 
     L1trackBase(),
     settings_(settings),
     stubs_(stubs), 
     cellLocationRphi_(cellLocationRphi), helixRphi_(helixRphi),
     cellLocationRz_  (cellLocationRz)  , helixRz_  (helixRz)
   {
-    nLayers_   = Utility::countLayers(settings, stubs); // Count tracker layers these stubs are in
-    matchedTP_ = Utility::matchingTP(settings, stubs, nMatchedLayers_, matchedStubs_); // Find associated truth particle & calculate info about match.
+    nLayers_   = Utility::countLayers(settings, *stubs_); // Count tracker layers these stubs are in
+    std::vector<const Stub*> matchedStubs;
+    matchedTP_ = Utility::matchingTP(settings, *stubs_, nMatchedLayers_, matchedStubs); // Find associated truth particle & calculate info about match.
+    matchedStubs_ = makeStubList(std::move(matchedStubs));
   }
 
   ~L1track3D() {}
@@ -38,9 +47,11 @@ public:
   //--- Get information about the reconstructed track.
 
   // Get stubs on track candidate.
-  const std::vector<const Stub*>&       getStubs()              const  {return stubs_;}  
+  const std::vector<const Stub*>&       getStubs()              const  {return *stubs_;}  
+  // Get shared list of stubs on track candidate, so another track can use the same stubs without copying them.
+  const StubList&                       getStubList()           const  {return stubs_;}
   // Get number of stubs on track candidate.
-  unsigned int                          getNumStubs()           const  {return stubs_.size();}
+  unsigned int                          getNumStubs()           const  {return stubs_->size();}
   // Get number of tracker layers these stubs are in.
   unsigned int                          getNumLayers()          const  {return nLayers_;}
   // Get cell location of track candidate in r-phi Hough Transform array in units of bin number.
@@ -77,9 +88,11 @@ public:
   // Get best matching tracking particle (=nullptr if none).
   const TP*                       getMatchedTP()        const {return matchedTP_;}
   // Get the matched stubs with this Tracking Particle
-  const std::vector<const Stub*>& getMatchedStubs()     const {return matchedStubs_;}
+  const std::vector<const Stub*>& getMatchedStubs()     const {return *matchedStubs_;}
+  // Get shared list of the matched stubs.
+  const StubList&                 getMatchedStubList()  const {return matchedStubs_;}
   // Get number of matched stubs with this Tracking Particle
-  unsigned int                    getNumMatchedStubs()  const {return matchedStubs_.size();}
+  unsigned int                    getNumMatchedStubs()  const {return matchedStubs_->size();}
   // Get number of tracker layers with matched stubs with this Tracking Particle 
   unsigned int                    getNumMatchedLayers() const {return nMatchedLayers_;}
   // Get purity of stubs on track candidate (i.e. fraction matching best Tracking Particle)
@@ -94,7 +107,7 @@ private:
   const Settings*                    settings_; 
 
   //--- Information about the reconstructed track.
-  std::vector<const Stub*>              stubs_;
+  StubList                              stubs_;
   unsigned int                          nLayers_;
   std::pair<unsigned int, unsigned int> cellLocationRphi_; 
   std::pair<float, float>               helixRphi_; 
@@ -103,7 +116,7 @@ private:
 
   //--- Information about its association (if any) to a truth Tracking Particle.
   const TP*                matchedTP_;
-  std::vector<const Stub*> matchedStubs_;
+  StubList                 matchedStubs_;
   unsigned int             nMatchedLayers_;
 };
 #endif
@@ -3,11 +3,21 @@
 
 #include <vector>
 #include <utility>
+#include <memory>
 
 
 class Stub;
 class TP;
 
+//=== Immutable list of the stubs on a track. It is shared, rather than copied, between all copies of a track
+//=== object, and between the track objects of successive stages of the track finding chain
+//=== (L1track2D -> L1track3D -> L1fittedTrack) whenever a stage does not change the stubs.
+
+typedef std::shared_ptr<const std::vector<const Stub*> > StubList;
+
+inline StubList makeStubList(const std::vector<const Stub*>& stubs) {return std::make_shared<const std::vector<const Stub*> >(stubs);}
+inline StubList makeStubList(std::vector<const Stub*>&& stubs)      {return std::make_shared<const std::vector<const Stub*> >(std::move(stubs));}
+
 //=== L1 track base class
 //=== This is a pure virtual class containing no implemented functions or data members.
 //=== However, it declares functions that are common to the derived classes L1trackBase, L1track3D and L1fittedTrack,
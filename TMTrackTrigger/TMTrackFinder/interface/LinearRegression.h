@@ -11,6 +11,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
 
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
 #include <vector>
 #include <sstream>
 #include <string>
@@ -32,7 +33,8 @@ public:
 protected:
 
   void initFit( const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg );
-  void updateLayerMap();
+  void initLayerCounts();
+  void removeStub( unsigned int is );
   bool checkValidity();
   void calcHelix( bool useHelix = true );
   void calcResidual();
@@ -83,11 +85,16 @@ protected:
   std::pair< unsigned int, unsigned int > HTCell_;
   std::pair< unsigned int, unsigned int > trackCell_;
 
-  // updateLayerMap()
+  // initLayerCounts(), removeStub( unsigned int is )
+  // Reduced layer IDs are in range 1-7.
+  static const unsigned int nLayerIdReduced_ = 8;
   unsigned int NumStubs_;
-  unsigned int layerID_;
-  std::map< unsigned int, std::vector< unsigned int > > layerMap_;
-  std::map< unsigned int, std::vector< unsigned int > > psLayerMap_;
+  std::vector< unsigned int > stubLayer_;
+  std::vector< unsigned int > stubCountLayer_;
+  unsigned int nStubsInLayer_[ nLayerIdReduced_ ];
+  unsigned int nPSStubsInLayer_[ nLayerIdReduced_ ];
+  unsigned int nStubsInCountLayer_[ Utility::maxLayerForCounting ];
+  unsigned int nPSStubsInCountLayer_[ Utility::maxLayerForCounting ];
   unsigned int nLayers_;
   unsigned int nPSLayers_;
 
@@ -95,9 +102,9 @@ protected:
   bool valid_;
 
   // calcHelixRPhi(), calcHelixRZ()
-  std::pair< float, float > rMinMax_;
-  std::pair< float, float > phiMinMax_;
-  std::pair< float, float > zMinMax_;
+  std::pair< float, float > rMinMax_[ nLayerIdReduced_ ];
+  std::pair< float, float > phiMinMax_[ nLayerIdReduced_ ];
+  std::pair< float, float > zMinMax_[ nLayerIdReduced_ ];
   float r_;
   float rTPhi_;
   float rTZ_;
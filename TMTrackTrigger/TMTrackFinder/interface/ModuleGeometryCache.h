@@ -0,0 +1,68 @@
+#ifndef __MODULEGEOMETRYCACHE_H__
+#define __MODULEGEOMETRYCACHE_H__
+
+#include <unordered_map>
+#include <cstdint>
+
+class StackedTrackerGeometry;
+class StackedTrackerDetId;
+
+//=== Info about a stacked tracker module, which is the same for all stubs in that module.
+
+struct ModuleInfo {
+  unsigned int idDet;       // Unique identifier of module.
+  float        minR;        // Min & max (r,phi,z) coordinates of the centre of the two sensors.
+  float        maxR;
+  float        minPhi;
+  float        maxPhi;
+  float        minZ;
+  float        maxZ;
+  bool         psModule;    // Module type: PS or 2S?
+  bool         barrel;
+  unsigned int layerId;     // Tracker layer ID number (1-6 = barrel layer; 11-15 = endcap A disk; 21-25 = endcap B disk)
+  unsigned int endcapRing;  // Endcap ring of module (zero in barrel)
+  float        stripPitch;  // Strip pitch (or pixel pitch along shortest axis).
+  float        stripLength; // Strip length (or pixel pitch along longest axis).
+  unsigned int nStrips;     // No. of strips in sensor.
+  float        sensorWidth; // Width of sensitive region of sensor.
+  float        sigmaPerp;   // Hit resolution perpendicular to strip (or to longest pixel axis) = pitch/sqrt(12).
+  float        sigmaPar;    // Hit resolution parallel to strip (or to longest pixel axis) = length/sqrt(12).
+};
+
+//=== Cache of the ModuleInfo of each tracker module, keyed by the module's DetId, so that the tracker geometry
+//=== only needs to be queried the first time a stub is found in each module, rather than for every stub in every event.
+//===
+//=== The entries are created as stubs are found, and kept from one event to the next.
+//=== Call clear() whenever the tracker geometry may have changed (e.g. at the start of each run).
+
+class ModuleGeometryCache {
+
+public:
+
+  ModuleGeometryCache() : lastIdDet_(0), lastModule_(nullptr) {}
+  ~ModuleGeometryCache() {}
+
+  // Forget all cached modules.
+  void clear() {modules_.clear(); lastIdDet_ = 0; lastModule_ = nullptr;}
+
+  // Get info about given module, taking it from the tracker geometry if it is not yet in the cache.
+  const ModuleInfo& module(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId);
+
+  // Number of modules in the cache.
+  unsigned int size() const {return modules_.size();}
+
+private:
+
+  // Get info about given module from the tracker geometry.
+  static ModuleInfo makeModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId);
+
+private:
+
+  std::unordered_map<uint32_t, ModuleInfo> modules_;
+
+  // Most recently requested module. (Stubs are unpacked module by module, so this is usually the one wanted).
+  uint32_t          lastIdDet_;
+  const ModuleInfo* lastModule_;
+};
+
+#endif
@@ -6,6 +6,7 @@
 
 class Settings;
 class Stub;
+class StubTable;
 class TP;
 
 
@@ -27,6 +28,13 @@ public:
   // Check if stub is within subsectors in eta that sector may be divided into.
   std::vector<bool> insideEtaSubSecs( const Stub* stub) const;
 
+  // The same checks for entry i of a stub table, which avoids dereferencing the Stub pointers.
+  // (Only valid if the stubs are not digitized).
+  bool inside   ( const StubTable& stubs, unsigned int i ) const {return (this->insideEta(stubs, i) && this->insidePhi(stubs, i));}
+  bool insideEta( const StubTable& stubs, unsigned int i ) const;
+  bool insidePhi( const StubTable& stubs, unsigned int i ) const;
+  std::vector<bool> insideEtaSubSecs( const StubTable& stubs, unsigned int i ) const;
+
   float phiCentre() const { return phiCentre_; } // Return phi of centre of this sector.
   float etaMin()    const { return etaMin_; } // Eta range covered by this sector.
   float etaMax()    const { return etaMax_; } // Eta range covered by this sector.
@@ -49,8 +57,14 @@ public:
 
 private: 
 
-  // Check if stub is within eta sector or subsector that is delimated by specified zTrk range.
-  bool insideEtaRange( const Stub* stub, float zRangeMin, float zRangeMax) const;
+  // Check if stub with given (r,z) coords. & uncertainties is within eta sector or subsector that is delimated by specified zTrk range.
+  bool insideEtaRange( float r, float z, float rErr, float zErr, float zRangeMin, float zRangeMax) const;
+
+  // Check if stub with given phi, r, rErr, bend angle dphi & its resolution is inside this phi sector.
+  bool insidePhi( float phi, float r, float rErr, float dphi, float dphiRes ) const;
+
+  // Check which eta subsectors stub with given (r,z) coords. & uncertainties is within.
+  std::vector<bool> insideEtaSubSecs( float r, float z, float rErr, float zErr ) const;
 
 private:
 
@@ -0,0 +1,76 @@
+#ifndef __SECTORMEMBERSHIP_H__
+#define __SECTORMEMBERSHIP_H__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+
+#include "boost/numeric/ublas/matrix.hpp"
+
+#include <vector>
+#include <cstdint>
+
+class Sector;
+class InputData;
+class TP;
+
+//=== Notes which (eta,phi) sectors each stub is inside, as decided by Sector::insideEta() & Sector::insidePhi(),
+//=== so that this is only calculated once per event, rather than by every piece of code that needs it.
+//===
+//=== Whether a stub is inside an eta region depends only on the eta region, and whether it is inside a phi sector
+//=== only on the phi sector. So this is held as two bit masks per stub, one with a bit for each eta region & one
+//=== with a bit for each phi sector, which are found with numEtaRegions + numPhiSectors checks per stub, rather than
+//=== numEtaRegions * numPhiSectors, reading the stubs output by the front-end electronics from the StubTable.
+//=== All stubs are included, (indexed by Stub::index()), even those failing the front-end electronics cuts.
+//=== It also holds the list of stubs inside each sector, (in the same order as
+//=== InputData::getStubs(), and only including stubs passing the front-end electronics cuts).
+//===
+//=== N.B. It uses the stub coordinates at the time fill() is called, so call it before the stubs are digitized.
+
+class SectorMembership {
+
+public:
+
+  SectorMembership() : numPhiSectors_(0), numEtaRegions_(0) {}
+  ~SectorMembership() {}
+
+  // Note which of the given (initialized) sectors each stub in the event is inside, replacing any previous contents.
+  void fill(const boost::numeric::ublas::matrix<Sector>& mSectors, const InputData& inputData);
+
+  // Check if stub within the eta and/or phi boundaries of given sector (as Sector::inside(), insideEta(), insidePhi()).
+  bool inside   (unsigned int iPhiSec, unsigned int iEtaReg, const Stub* stub) const {return (this->insideEta(iEtaReg, stub) && this->insidePhi(iPhiSec, stub));}
+  bool insideEta(unsigned int iEtaReg, const Stub* stub) const {return (etaMask_[stub->index()] >> iEtaReg) & 1;}
+  bool insidePhi(unsigned int iPhiSec, const Stub* stub) const {return (phiMask_[stub->index()] >> iPhiSec) & 1;}
+
+  // Number of eta regions & phi sectors that the stub is inside.
+  unsigned int numEtaRegions(const Stub* stub) const {return __builtin_popcountll(etaMask_[stub->index()]);}
+  unsigned int numPhiSectors(const Stub* stub) const {return __builtin_popcountll(phiMask_[stub->index()]);}
+
+  // Stubs inside given sector.
+  const std::vector<const Stub*>& stubsInSector(unsigned int iPhiSec, unsigned int iEtaReg) const {return sectorStubs_[iPhiSec*numEtaRegions_ + iEtaReg];}
+
+  // Count number of stubs in given tracking particle which are inside this (phi,eta) sector;
+  // or inside it if only the eta cuts are applied; or inside it if only the phi cuts are applied.
+  // (as Sector::numStubsInside()). The results are returned as the 3 last arguments of the function.
+  void numStubsInside(unsigned int iPhiSec, unsigned int iEtaReg, const TP& tp,
+                      unsigned int& nStubsInsideEtaPhi, unsigned int& nStubsInsideEta,
+                      unsigned int& nStubsInsidePhi) const;
+
+private:
+
+  // Note the eta regions & phi sectors that a stub is inside, where the stub is a Stub pointer or a StubTable & entry.
+  template <typename... StubArgs>
+  void setMasks(const boost::numeric::ublas::matrix<Sector>& mSectors, unsigned int stubIndex, const StubArgs&... stubArgs);
+
+private:
+
+  unsigned int numPhiSectors_;
+  unsigned int numEtaRegions_;
+
+  // Bit masks of eta regions & phi sectors each stub is inside, indexed by Stub::index().
+  std::vector<uint64_t> etaMask_;
+  std::vector<uint64_t> phiMask_;
+
+  // Stubs inside each sector, indexed by iPhiSec*numEtaRegions + iEtaReg.
+  std::vector< std::vector<const Stub*> > sectorStubs_;
+};
+
+#endif
@@ -244,6 +244,25 @@ public:
   // Booleain indicating if an output EDM file will be written.
   // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside tmtt_tf_analysis_cfg.py .
   bool                 writeOutEdmFile()         const   {return writeOutEdmFile_;}
+  // Name of snapshot file to which stubs & tracking particles will be written (empty if none), so they can be replayed without CMSSW.
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside tmtt_tf_analysis_cfg.py .
+  const std::string&   snapshotFile()            const   {return snapshotFile_;}
+  // Name of file to which the HT output stubs will be written as firmware test vectors (empty if none).
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside tmtt_tf_analysis_cfg.py .
+  const std::string&   testVectorFile()          const   {return testVectorFile_;}
+  // Boolean indicating if the time spent in each processing stage & sector will be histogrammed (see StageTimers.h).
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside tmtt_tf_analysis_cfg.py .
+  bool                 stageTiming()             const   {return stageTiming_;}
+  // Boolean indicating if the histograms will be filled by separate threads, in parallel with the track finding of
+  // the following events (see HistosWorker.h), the max. number of events that may wait to be histogrammed,
+  // and the number of threads.
+  // N.B. These parameters do not appear inside TMTrackProducer_Defaults_cfi.py . They are created inside tmtt_tf_analysis_cfg.py .
+  bool                 asyncHistos()             const   {return asyncHistos_;}
+  unsigned int         asyncHistosQueueSize()    const   {return asyncHistosQueueSize_;}
+  unsigned int         asyncHistosThreads()      const   {return asyncHistosThreads_;}
+  // Names of the families of histograms that will not be filled (see Histos.h). If empty, all are filled.
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside tmtt_tf_analysis_cfg.py .
+  const std::vector<std::string>& histosDisabled() const {return histosDisabled_;}
 
   //=== Hard-wired constants
   double               pitchPS()                 const   {std::cout<<"ERROR: Use Stub::stripPitch instead of Settings::pitchPS!";exit(1);return 0.;} // pitch of PS modules - OBSOLETE
@@ -421,6 +440,23 @@ private:
   // Boolean indicating an an EDM output file will be written.
   bool                 writeOutEdmFile_;
 
+  // Name of output snapshot file.
+  std::string          snapshotFile_;
+
+  // Name of output firmware test vector file.
+  std::string          testVectorFile_;
+
+  // Boolean indicating if processing time is histogrammed.
+  bool                 stageTiming_;
+
+  // Fill histograms in separate threads, how many events may be queued for them, and how many threads.
+  bool                 asyncHistos_;
+  unsigned int         asyncHistosQueueSize_;
+  unsigned int         asyncHistosThreads_;
+
+  // Families of histograms not filled.
+  std::vector<std::string> histosDisabled_;
+
   // B-field in Tesla
   float                bField_;
 };
@@ -0,0 +1,127 @@
+#ifndef __STAGETIMERS_H__
+#define __STAGETIMERS_H__
+
+#include "FWCore/ServiceRegistry/interface/Service.h"
+#include "CommonTools/UtilAlgos/interface/TFileService.h"
+
+#include <chrono>
+#include <vector>
+#include <map>
+#include <string>
+
+class Settings;
+class TH1F;
+class TProfile;
+
+//=== Measures the CPU (wall-clock) time spent in each stage of the L1 track finding chain, both per event and
+//=== per (eta,phi) sector, and histograms it in the TFileService output file, in directory "Timing".
+//=== The per-sector distributions show the tail latency in busy sectors, which is what limits the
+//=== time-multiplexed hardware.
+//===
+//=== Usage: call startEvent(), time each stage with a StageTimers::Scope object (or addTime()),
+//=== call startSectors() before the first sector is processed, fillSectorHT() & fillSectorFit() after each
+//=== sector is processed, and call endEvent() at the end.
+
+class StageTimers {
+
+public:
+
+  // Stages of the processing chain that are timed.
+  enum Stage {InputDecoding, Routing, HTfill, HTend, RZfilters, Fit, DupRemoval, Histogramming, DemoOutput, NumStages};
+
+  typedef std::chrono::steady_clock Clock;
+
+  // Times the enclosing code block, adding the time to the given stage.
+  // If a fitter name is given, it is also added to the time of that fitter.
+  // Scopes may be nested, in which case time spent in the inner scope is not counted in the outer one.
+  // Does nothing if the timers pointer is null.
+  class Scope {
+  public:
+    Scope(StageTimers* timers, Stage stage, const std::string* fitterName = nullptr) :
+      timers_(timers), stage_(stage), fitterName_(fitterName), excluded_(0.) 
+    {
+      if (timers_ != nullptr) {
+        parent_ = timers_->currentScope_;
+        timers_->currentScope_ = this;
+        t0_ = Clock::now();
+      }
+    }
+    ~Scope() {
+      if (timers_ != nullptr) {
+        const double sec = seconds(Clock::now() - t0_);
+        timers_->currentScope_ = parent_;
+        if (parent_ != nullptr) parent_->excluded_ += sec;
+        timers_->addTime(stage_, sec - excluded_, fitterName_);
+      }
+    }
+  private:
+    StageTimers*       timers_;
+    Stage              stage_;
+    const std::string* fitterName_;
+    Scope*             parent_;
+    double             excluded_; // time spent in nested scopes.
+    Clock::time_point  t0_;
+  };
+
+  StageTimers(const Settings* settings);
+  ~StageTimers() {}
+
+  // Book histograms.
+  void book();
+
+  // Reset the time counters at the start of each event.
+  void startEvent();
+
+  // Note that the per-sector processing is about to start, so that time spent before it (e.g. on work done
+  // once per event for all sectors) isn't attributed to the first sector by fillSectorHT() & fillSectorFit().
+  void startSectors();
+
+  // Add time (in seconds) to the given stage, and optionally to the given fitter.
+  void addTime(Stage stage, double sec, const std::string* fitterName = nullptr);
+
+  // Histogram the time spent on routing, HT & r-z filters (or on track fitting & duplicate removal) in
+  // sector (iPhiSec, iEtaReg), i.e. since the previous call to the same function, as a function of the
+  // number of stubs (or track candidates) in the sector.
+  void fillSectorHT (unsigned int iPhiSec, unsigned int iEtaReg, unsigned int nStubs);
+  void fillSectorFit(unsigned int iPhiSec, unsigned int iEtaReg, unsigned int nTrkCands);
+
+  // Histogram the time taken by each stage in this event.
+  void endEvent();
+
+  // Convert duration to seconds.
+  static double seconds(Clock::duration dt) {return std::chrono::duration<double>(dt).count();}
+
+  // Name of each stage.
+  static const char* stageName(Stage stage) {return stageNames_[stage];}
+
+private:
+
+  const Settings* settings_;
+  edm::Service<TFileService> fs_;
+
+  static const char* stageNames_[NumStages];
+
+  // Innermost Scope currently timing.
+  Scope*                        currentScope_;
+
+  // Time (seconds) spent in each stage & fitter in this event.
+  std::vector<double>           eventTime_;
+  std::map<std::string, double> eventFitTime_;
+  // Time spent in this event when the previous sector was completed.
+  double                        htTimeAtLastSector_;
+  double                        fitTimeAtLastSector_;
+
+  // Histograms.
+  std::vector<TH1F*>              hisStageTime_;
+  std::map<std::string, TH1F*>    hisFitterTime_;
+  TH1F*     hisEventTime_;
+  TProfile* profStageTime_;
+  TH1F*     hisSectorHTtime_;
+  TH1F*     hisSectorFitTime_;
+  TProfile* profSectorHTtimeVsSector_;
+  TProfile* profSectorHTtimeVsNumStubs_;
+  TProfile* profSectorFitTimeVsSector_;
+  TProfile* profSectorFitTimeVsNumCands_;
+};
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DigitalStub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TPlist.h"
 
 #include "DataFormats/Common/interface/Ref.h"
 #include "DataFormats/Common/interface/DetSetVector.h"
@@ -21,12 +22,15 @@
 #include <set>
 #include <array>
 #include <map>
+#include <cstdint>
 
 
 
 class StackedTrackerGeometry;
-class StackedTrackerDetId;
+class ModuleGeometryCache;
+struct ModuleInfo;
 class TP;
+struct SnapshotStub;
 
 typedef edm::Ref< edm::DetSetVector< PixelDigi >, PixelDigi > Ref_PixelDigi_;
 
@@ -46,8 +50,13 @@ typedef TTClusterAssociationMap<Ref_PixelDigi_>        TTClusterAssMap;
 class Stub
 {
 public:
-	// Fill useful info about stub.
-	Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* settings, const StackedTrackerGeometry*  stackedGeometry);
+	// Fill useful info about stub. The info about the module it is in is taken from moduleCache, which queries the
+	// tracker geometry only for modules not already in the cache.
+	Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* settings, const StackedTrackerGeometry*  stackedGeometry,
+	     ModuleGeometryCache* moduleCache);
+	// Fill useful info about stub from a record in a snapshot file (see EventSnapshot.h). No tracker geometry is needed,
+	// but cmsswTTStubRef() will return a null reference.
+	Stub(const SnapshotStub& snapStub, unsigned int index_in_vStubs, const Settings* settings);
 	~Stub(){}
 
 	bool operator==(const Stub& stubOther) {return (index() == stubOther.index());}
@@ -55,6 +64,9 @@ public:
 	// Fill truth info with association from stub to tracking particles.
 	// The 1st argument is a map relating TrackingParticles to TP.
 	void fillTruth(const std::map<edm::Ptr< TrackingParticle >, const TP* >& translateTP, edm::Handle<TTStubAssMap> mcTruthTTStubHandle, edm::Handle<TTClusterAssMap> mcTruthTTClusterHandle);
+	// Fill truth info from a snapshot file record. The 2nd argument is the event's pool of truth links, 
+	// and the 3rd one the TPs read from the same event.
+	void fillTruth(const SnapshotStub& snapStub, const uint32_t* snapLinks, const std::vector<TP>& vTPs);
 
 	// Calculate bin range along q/Pt axis of r-phi Hough transform array consistent with bend of this stub.
 	void calcQoverPtrange();
@@ -113,11 +125,16 @@ public:
 	float                                 beta() const { return   (phi_ + dphi()); }
 	// Estimated phi angle at which track crosses a given radius rad, based on stub bend info. Also estimate uncertainty on this angle due to endcap 2S module strip length. 
 	// This is identical to beta() if rad=0.
-	std::pair<float, float> trkPhiAtR(float rad) const;
+	std::pair<float, float> trkPhiAtR(float rad) const { return trkPhiAtR(phi_, r_, rErr_, dphi(), rad); }
 	// Estimated resolution in trkPhiAtR(rad) based on nominal stub bend resolution.
-	float                trkPhiAtRres(float rad) const { return dphiRes() * fabs(1 - rad / r_); }
+	float                trkPhiAtRres(float rad) const { return trkPhiAtRres(r_, dphiRes(), rad); }
 	// Difference in phi between stub and angle at which track crosses given radius, assuming track has given Pt.
-	float           phiDiff(float rad, float Pt) const { return fabs(r_ - rad)*(settings_->invPtToDphi())/Pt; }
+	float           phiDiff(float rad, float Pt) const { return phiDiff(r_, rad, Pt, settings_->invPtToDphi()); }
+	// The same three quantities, calculated from the given stub coordinates (phi, r), radial uncertainty rErr, and bend 
+	// angle dphi & its resolution dphiRes. (Also used by Sector, which may read the stub coordinates from a StubTable).
+	static std::pair<float, float> trkPhiAtR(float phi, float r, float rErr, float dphi, float rad);
+	static float trkPhiAtRres(float r, float dphiRes, float rad) { return dphiRes * fabs(1 - rad / r); }
+	static float phiDiff(float r, float rad, float Pt, double invPtToDphi) { return fabs(r - rad)*invPtToDphi/Pt; }
 	// -- conversion factors
 	// Ratio of bend angle to bend, where bend is the displacement in strips between the two hits making up stub.
 	float                         dphiOverBend() const { check2(); return dphiOverBend_; }
@@ -190,8 +207,8 @@ public:
 	//--- Truth info
 
 	// Association of stub to tracking particles
-	std::set<const TP*>               assocTPs() const { return        assocTPs_; } // Return TPs associated to this stub. (Whether only TPs contributing to both clusters are returned is determined by "StubMatchStrict" config param.)
-	bool	 			     genuine() const { return (assocTPs_.size() > 0); } // Did stub match at least one TP?
+	const TPlist&                     assocTPs() const { return        assocTPs_; } // Return TPs associated to this stub, sorted by TP::index(). (Whether only TPs contributing to both clusters are returned is determined by "StubMatchStrict" config param.)
+	bool	 			     genuine() const { return ( ! assocTPs_.empty()); } // Did stub match at least one TP?
 	const TP*                          assocTP() const { return         assocTP_; } // If only one TP contributed to both clusters, this tells you which TP it is. Returns nullptr if none.
 
 	// Association of both clusters making up stub to tracking particles
@@ -210,10 +227,14 @@ public:
 	
 private:
 
+	// Set stub quantities derived from the module info and from the bend in the front-end chip, which depend on the 
+	// configuration parameters. Called by both constructors, after the stub coordinates & module info are set.
+	void setDerivedInfo(float bendInFrontend);
+
 	// Degrade assumed stub bend resolution.
 	// Also return boolean indicating if stub bend was outside assumed window, so stub should be rejected
 	// and return an integer indicating how many values of bend are merged into this single one.
-	void degradeResolution(float bend, const StackedTrackerDetId& stDetId,
+	void degradeResolution(float bend,
 						float& degradedBend, bool& reject, unsigned int& num) const;
 
 	// Set the frontendPass_ flag, indicating if frontend readout electronics will output this stub.  
@@ -221,7 +242,7 @@ private:
 	void setFrontend(bool rejectStub);          
 
 	// Set info about the module that this stub is in.
-	void  setModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId);
+	void  setModuleInfo(const ModuleInfo& mod);
 
 	// Function to set rho parameter value. Since the rho parameter is not a data member of this class, this is done by setting the value of 
 	// dphiOverBend_ (also known as "raw rho") from which rho is derived.
@@ -280,7 +301,7 @@ private:
 
 	//--- Truth info about stub.
 	const TP*                                assocTP_;
-	std::set<const TP*>                     assocTPs_;
+	TPlist                                  assocTPs_;
 	//--- Truth info about the two clusters that make up the stub
 	std::array<const TP*, 2>        assocTPofCluster_;
 
@@ -0,0 +1,110 @@
+#ifndef __STUBGENERATOR_H__
+#define __STUBGENERATOR_H__
+
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+#include <vector>
+#include <random>
+
+class Settings;
+
+//=== Generates stub-level events from helical tracks, for scaling & throughput studies that should not depend
+//=== on the availability of the official MC samples. Each event contains a configurable number of signal tracks
+//=== from the physics collision, plus a Poisson distributed number of pileup interactions.
+//===
+//=== The tracks are propagated through a simplified tracker, with 6 barrel layers & 5 endcap disks on each side,
+//=== whose PS & 2S modules are approximated as lying on cylinders or on disks respectively. The layer IDs &
+//=== endcap ring numbers follow the convention of Stub::layerId() & Stub::endcapRing().
+//=== Stub coordinates are quantized to the strip pitch and strip length of the module hit, and the stub bend
+//=== is smeared & rounded to half strips, as in the front-end chip. No multiple scattering is simulated.
+//===
+//=== The events are produced in the format of the snapshot files (see EventSnapshot.h), so can be written to
+//=== file with EventSnapshotWriter and replayed with the standalone tmttReplay executable.
+
+class StubGenerator {
+
+public:
+
+  // The ParameterSet contains the generator options (see test/tmtt_generate_cfg.py).
+  // The B-field must already have been set in Settings.
+  StubGenerator(const edm::ParameterSet& cfg, const Settings* settings);
+  ~StubGenerator() {}
+
+  // Generate the TPs, stubs & stub-to-TP links of a new event.
+  void generate(std::vector<SnapshotTP>& vTPs, std::vector<SnapshotStub>& vStubs, std::vector<uint32_t>& vLinks);
+
+private:
+
+  // Generated particle.
+  struct Particle {
+    int   pdgId;
+    int   charge;
+    float mass;
+    float pt;
+    float eta;
+    float phi0;
+    float d0;
+    float z0;
+    bool  physicsCollision;
+  };
+
+  // Properties of a module type.
+  struct ModuleType {
+    bool         ps;
+    float        pitch;
+    float        stripLength;
+    unsigned int nStrips;
+    unsigned int nRows;
+  };
+
+  // Generate a particle from the signal or pileup spectrum.
+  Particle generateParticle(bool physicsCollision, float z0);
+
+  // Produce the stubs from the given particle, appending them to vStubs. iTP is its index in the TP
+  // collection, or snapshotNoTP if it is not stored as a TP.
+  void makeStubs(const Particle& p, int32_t iTP, std::vector<SnapshotStub>& vStubs, std::vector<uint32_t>& vLinks);
+
+  // Fill stub in barrel layer (1-6) or endcap disk (1-5), returning false if the particle misses it.
+  bool barrelStub(const Particle& p, unsigned int iLayer, SnapshotStub& stub);
+  bool endcapStub(const Particle& p, unsigned int iDisk, SnapshotStub& stub);
+
+  // Phi of particle trajectory at given radius (or 999 if it never reaches this radius).
+  float phiAtR(const Particle& p, float r) const;
+
+  // Smeared stub bend, rounded to half strips, for a particle crossing a module at radius r,
+  // where deltaR is the difference in radius of the points where it crosses the two sensors.
+  float smearedBend(const Particle& p, float r, float deltaR, float pitch);
+
+  // Check if TP would be kept by InputData, and if it can be used for efficiency measurement.
+  bool tpUse(const Particle& p) const;
+  bool tpUseForEff(const Particle& p) const;
+
+private:
+
+  const Settings* settings_;
+
+  std::mt19937    rng_;
+
+  // Generator options.
+  unsigned int    numSignalTracks_;
+  int             signalPdgId_;
+  float           signalMinPt_;
+  float           signalMaxPt_;
+  float           signalD0Sigma_;
+  double          pileUp_;
+  double          tracksPerInteraction_;
+  float           pileUpMinPt_;
+  float           pileUpPtSlope_;
+  float           pileUpD0Sigma_;
+  float           maxAbsEta_;
+  float           beamSpotSigmaZ_;
+  float           bendResolution_;
+  float           maxBend_;
+  float           stubEfficiency_;
+
+  ModuleType      modulePS_;
+  ModuleType      module2S_;
+};
+
+#endif
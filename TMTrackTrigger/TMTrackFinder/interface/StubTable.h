@@ -0,0 +1,72 @@
+#ifndef __STUBTABLE_H__
+#define __STUBTABLE_H__
+
+#include <vector>
+#include <cstdint>
+
+class Stub;
+
+//=== Structure-of-arrays copy of the stub quantities used in the hot loops of the track finding,
+//=== (e.g. assigning every stub to every sector), for the stubs output by the front-end electronics.
+//=== Entry i corresponds to InputData::getStubs()[i], so loops over the table can visit the stubs
+//=== in the same order as loops over the Stub pointers, but read the values from contiguous arrays.
+//===
+//=== N.B. The table holds the undigitized stub quantities. It must not be used in place of the Stub
+//=== objects if Settings::enableDigitize() is true, as the digitization modifies the stubs.
+
+class StubTable {
+
+public:
+
+  StubTable() {}
+  ~StubTable() {}
+
+  // Fill the table from the given stubs, replacing any previous contents.
+  void fill(const std::vector<const Stub*>& stubs);
+
+  unsigned int size()                          const {return stub_.size();}
+  bool         empty()                         const {return stub_.empty();}
+
+  // Stub corresponding to entry i.
+  const Stub*  stub           (unsigned int i) const {return stub_[i];}
+
+  // Stub coordinates & their uncertainty due to strip length.
+  float        phi            (unsigned int i) const {return phi_[i];}
+  float        r              (unsigned int i) const {return r_[i];}
+  float        z              (unsigned int i) const {return z_[i];}
+  float        rErr           (unsigned int i) const {return rErr_[i];}
+  float        zErr           (unsigned int i) const {return zErr_[i];}
+  // Bend angle of track measured by stub and its estimated resolution.
+  float        dphi           (unsigned int i) const {return dphi_[i];}
+  float        dphiRes        (unsigned int i) const {return dphiRes_[i];}
+  // Tracker layer ID & reduced layer ID (see Stub.h).
+  unsigned int layerId        (unsigned int i) const {return layerId_[i];}
+  unsigned int layerIdReduced (unsigned int i) const {return layerIdReduced_[i];}
+  // Module type.
+  bool         psModule       (unsigned int i) const {return (flags_[i] & PS)     != 0;}
+  bool         barrel         (unsigned int i) const {return (flags_[i] & Barrel) != 0;}
+  // Range in q/Pt bins in HT array compatible with stub bend.
+  unsigned int min_qOverPt_bin(unsigned int i) const {return min_qOverPt_bin_[i];}
+  unsigned int max_qOverPt_bin(unsigned int i) const {return max_qOverPt_bin_[i];}
+
+private:
+
+  // Bits of flags_.
+  enum Flag {PS = 1, Barrel = 2};
+
+  std::vector<const Stub*>  stub_;
+  std::vector<float>        phi_;
+  std::vector<float>        r_;
+  std::vector<float>        z_;
+  std::vector<float>        rErr_;
+  std::vector<float>        zErr_;
+  std::vector<float>        dphi_;
+  std::vector<float>        dphiRes_;
+  std::vector<uint8_t>      layerId_;
+  std::vector<uint8_t>      layerIdReduced_;
+  std::vector<uint8_t>      flags_;
+  std::vector<uint16_t>     min_qOverPt_bin_;
+  std::vector<uint16_t>     max_qOverPt_bin_;
+};
+
+#endif
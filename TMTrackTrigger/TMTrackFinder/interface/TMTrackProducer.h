@@ -16,6 +16,11 @@
 class Settings;
 class Histos;
 class TrackFitGeneric;
+class EventSnapshotWriter;
+class DemoTestVectorWriter;
+class StageTimers;
+class HistosWorker;
+class ModuleGeometryCache;
 
 class TMTrackProducer : public edm::EDProducer {
 
@@ -38,6 +43,11 @@ private:
   Settings *settings_;
   Histos   *hists_;
   std::map<std::string, TrackFitGeneric*> fitterWorkerMap_;
+  EventSnapshotWriter *snapshotWriter_; // Optional writer of stubs & TPs to snapshot file.
+  DemoTestVectorWriter *testVectorWriter_; // Optional writer of HT output stubs to firmware test vector file.
+  StageTimers *stageTimers_; // Optional timing of processing stages.
+  HistosWorker *histosWorker_; // Fills histograms with results of each event, optionally in separate thread.
+  ModuleGeometryCache *moduleCache_; // Info about each tracker module, kept from one event to the next.
 };
 #endif
 
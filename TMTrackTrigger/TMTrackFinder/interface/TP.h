@@ -12,6 +12,7 @@
 
 
 class Stub;
+struct SnapshotTP;
 
 typedef edm::Ptr<TrackingParticle> TrackingParticlePtr;
 
@@ -20,12 +21,16 @@ class TP : public TrackingParticlePtr {
 public:
   // Fill useful info about tracking particle.
   TP(TrackingParticlePtr tpPtr, unsigned int index_in_vTPs, const Settings* settings);
+  // Fill useful info about tracking particle from a record in a snapshot file (see EventSnapshot.h).
+  // The edm::Ptr base class is then null, and the TP selection flags are those frozen when the snapshot was written.
+  TP(const SnapshotTP& snapTP, unsigned int index_in_vTPs, const Settings* settings);
   ~TP(){}
 
   bool operator==(const TP& tpOther) {return (this->index() == tpOther.index());}
 
-  // Fill truth info with association from tracking particle to stubs.
-  void fillTruth(const std::vector<Stub>& vStubs);
+  // Fill truth info with association from tracking particle to stubs, given the stubs it produced
+  // (see InputData::fillTruthOfTPs()).
+  void fillTruth(const std::vector<const Stub*>& assocStubs);
 
   // == Functions for returning info about tracking particles ===
 
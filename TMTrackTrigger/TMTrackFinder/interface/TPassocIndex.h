@@ -0,0 +1,88 @@
+#ifndef __TPASSOCINDEX_H__
+#define __TPASSOCINDEX_H__
+
+#include "boost/numeric/ublas/matrix.hpp"
+
+#include <vector>
+#include <cstdint>
+
+class InputData;
+class TP;
+class HTpair;
+class L1track3D;
+class FittedTrackStore;
+
+//=== Index of the HT track candidates & fitted tracks matched to each tracking particle in one event.
+//===
+//=== It is built with a single pass over all the track candidates & fitted tracks of the event, so that code
+//=== looping over tracking particles can then find the tracks matched to each of them directly, rather than by
+//=== searching all the tracks in all the sectors for each tracking particle (as HTpair::assocTrackCands3D() does).
+//===
+//=== The tracks of each TP are held consecutively in a single per-event pool, (indexed by TP::index()), in the
+//=== same order as a loop over sectors (iPhiSec outer, iEtaReg inner) & then over the tracks in each sector would
+//=== find them. So the track candidates of a TP in the same sector are adjacent.
+
+class TPassocIndex {
+
+public:
+
+  //--- HT track candidate matched to a TP, and the sector it was found in.
+
+  struct Cand {
+    const L1track3D* trk;
+    uint16_t         iPhiSec;
+    uint16_t         iEtaReg;
+  };
+
+  //--- Read-only range of entries in the index, allowing range-based for loops.
+
+  template <typename T>
+  class Range {
+  public:
+    Range(const T* begin, const T* end) : begin_(begin), end_(end) {}
+    const T*     begin() const {return begin_;}
+    const T*     end()   const {return end_;}
+    unsigned int size()  const {return end_ - begin_;}
+    bool         empty() const {return begin_ == end_;}
+  private:
+    const T* begin_;
+    const T* end_;
+  };
+
+public:
+
+  TPassocIndex() {}
+  ~TPassocIndex() {}
+
+  // Index the track candidates in the HT arrays & the fitted tracks of an event, replacing any previous contents.
+  void fill(const InputData& inputData, const boost::numeric::ublas::matrix<HTpair>& mHtPairs, const FittedTrackStore& fittedTracks);
+
+  // Get the HT track candidates matched to the given TP (as HTpair::assocTrackCands3D(), but for all sectors).
+  Range<Cand>     assocTrackCands3D(const TP& tp) const;
+
+  // Get the indices in the FittedTrackStore of the fitted tracks (from all fitters) matched to the given TP.
+  Range<uint32_t> assocFittedTracks(const TP& tp) const;
+
+private:
+
+  // Sort entries by TP index, keeping their order within each TP. "tpOfEntry" gives the TP index of each entry,
+  // and "offsets" is set to the start of the entries of each TP in the sorted list.
+  template <typename T>
+  static void sortByTP(unsigned int numTPs, const std::vector<T>& entries, const std::vector<int32_t>& tpOfEntry,
+                       std::vector<uint32_t>& offsets, std::vector<T>& sorted);
+
+private:
+
+  // Track candidates & fitted tracks of each TP, with those of TP i between offsets[i] & offsets[i+1].
+  std::vector<uint32_t> candOffsets_;
+  std::vector<Cand>     cands_;
+  std::vector<uint32_t> fitOffsets_;
+  std::vector<uint32_t> fits_;
+
+  // Work space, reused from one event to the next.
+  std::vector<Cand>     unsortedCands_;
+  std::vector<uint32_t> unsortedFits_;
+  std::vector<int32_t>  tpOfEntry_;
+};
+
+#endif
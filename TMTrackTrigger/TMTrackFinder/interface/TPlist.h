@@ -0,0 +1,97 @@
+#ifndef __TPLIST_H__
+#define __TPLIST_H__
+
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+class TP;
+
+//=== Small sorted list of distinct tracking particles, as used for the TPs associated to a stub.
+//===
+//=== Up to nInline TPs are stored inside the object itself, so the usual case of a stub with 0-2 associated TPs
+//=== needs no memory allocation. Longer lists are moved to the heap. The TPs are sorted by address, which since
+//=== they are all held in the vector InputData::getTPs(), is the same as sorting them by TP::index().
+//=== Iterating over the list therefore gives the same order as the std::set<const TP*> it replaces.
+
+class TPlist {
+
+public:
+
+  typedef const TP* const* const_iterator;
+
+  TPlist() : inline_(), heap_(nullptr), size_(0), capacity_(nInline) {}
+  TPlist(const TPlist& other) : inline_(), heap_(nullptr), size_(0), capacity_(nInline) {this->append(other);}
+  // N.B. The moves are noexcept, so that std::vector<Stub> moves the lists when it reallocates, rather than copying them.
+  TPlist(TPlist&& other) noexcept : inline_(), heap_(nullptr), size_(0), capacity_(nInline) {this->swap(other);}
+  ~TPlist() {delete [] heap_;}
+
+  TPlist& operator=(const TPlist& other) {TPlist copy(other); this->swap(copy); return *this;}
+  TPlist& operator=(TPlist&& other) noexcept {this->swap(other); return *this;}
+
+  // Add a TP to the list, unless it is already there.
+  void insert(const TP* tp) {
+    const TP** first = this->data();
+    const TP** pos   = std::lower_bound(first, first + size_, tp, std::less<const TP*>());
+    if (pos != first + size_ && *pos == tp) return;
+    const unsigned int iPos = pos - first;
+    if (size_ == capacity_) this->grow();
+    const TP** d = this->data();
+    std::copy_backward(d + iPos, d + size_, d + size_ + 1);
+    d[iPos] = tp;
+    size_++;
+  }
+
+  // Is the given TP in the list?
+  bool contains(const TP* tp) const {
+    for (const TP* t : *this) {
+      if (t == tp) return true;
+    }
+    return false;
+  }
+
+  unsigned int   size()                  const {return size_;}
+  bool           empty()                 const {return size_ == 0;}
+  const TP*      operator[](unsigned int i) const {return this->data()[i];}
+  const_iterator begin()                 const {return this->data();}
+  const_iterator end()                   const {return this->data() + size_;}
+
+private:
+
+  const TP* const* data() const {return (heap_ != nullptr)  ?  heap_  :  inline_;}
+  const TP**       data()       {return (heap_ != nullptr)  ?  heap_  :  inline_;}
+
+  // Append the TPs of another (sorted) list to this empty one.
+  void append(const TPlist& other) {
+    while (capacity_ < other.size_) this->grow();
+    std::copy(other.begin(), other.end(), this->data());
+    size_ = other.size_;
+  }
+
+  // Double the capacity, moving the list to the heap.
+  void grow() {
+    const TP** newHeap = new const TP*[2*capacity_];
+    std::copy(this->data(), this->data() + size_, newHeap);
+    delete [] heap_;
+    heap_ = newHeap;
+    capacity_ *= 2;
+  }
+
+  void swap(TPlist& other) noexcept {
+    std::swap(heap_,     other.heap_);
+    std::swap(size_,     other.size_);
+    std::swap(capacity_, other.capacity_);
+    for (unsigned int i = 0; i < nInline; i++) std::swap(inline_[i], other.inline_[i]);
+  }
+
+private:
+
+  static const unsigned int nInline = 2;
+
+  const TP*  inline_[nInline];
+  const TP** heap_; // Holds the list instead of inline_, if it has more than nInline entries.
+  uint32_t   size_;
+  uint32_t   capacity_;
+};
+
+#endif
@@ -36,6 +36,11 @@ public:
   // Specify which phi sector and eta region it is in.
   virtual L1fittedTrack fit( const L1track3D& l1track3D,  unsigned int iPhiSec, unsigned int iEtaReg );
 
+  // Fit all track candidates in a sector, returning one fitted track per candidate, in the same order.
+  // By default, this just calls fit() for each candidate, but fitters may override it to fit several
+  // candidates in parallel.
+  virtual std::vector<L1fittedTrack> fitBatch( const std::vector<L1track3D>& l1track3Ds, unsigned int iPhiSec, unsigned int iEtaReg );
+
   virtual std::string getParams() = 0;
   const Settings* getSettings() const {return settings_;}
   unsigned nDupStubs() const { return nDupStubs_; }
@@ -11,6 +11,9 @@
 // Don't fit track candidates if they have more than this number of stubs.
 #define __MAX_STUBS_PER_TRK__   30
 
+// Number of track candidates fitted in parallel by fitBatch(), one per SIMD lane.
+#define __FIT_BATCH_LANES__     8
+
 #include "TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
@@ -37,21 +40,37 @@ public:
   // Specify which phi sector and eta region it is in.
    L1fittedTrack fit( const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg );
 
+  // Fit all track candidates in a sector, giving the same results as fit(). Candidates with similar numbers
+  // of stubs are grouped into batches of __FIT_BATCH_LANES__, which are fitted together, with the data
+  // stored as structure-of-arrays, so that the loops over the candidates in the batch can be vectorized.
+   std::vector<L1fittedTrack> fitBatch( const std::vector<L1track3D>& l1track3Ds, unsigned int iPhiSec, unsigned int iEtaReg );
+
    std::string getParams();
 
 private:
-  // Method to invert matrix by hand
-  void invert( float M[5][10], unsigned int n );
+  // Method to solve M*x = b for symmetric, positive definite n x n matrix M, by Cholesky decomposition
+  static void solveSymmetric( const float M[5][5], const double b[5], double x[5], unsigned int n );
+
+  // Method to split stubs_ into barrel & disk groups
+  void fillStubGroups();
 
-  // Method to calculate derivatives
-  void calculateDerivatives( bool withd0 );
+  // Method to calculate derivatives, and M for the 4 parameter fit
+  void calculateDerivatives();
 
   // Method to calculate residuals
   void residuals( float& largestresid, int& ilargestresid );
 
-  // Linear track fitting method
+  // Linear track fitting method. The 5 parameter fit reuses the derivatives & residuals
+  // of the last 4 parameter fit, which were calculated with the same helix params & stubs.
   void linearTrackFit( bool withd0 );
 
+  // Equivalents of the above methods for fitBatch(), each processing all lanes of the batch.
+  void loadBatchLane( unsigned int iLane );
+  void calculateDerivativesBatch();
+  void residualsBatch();
+  void linearTrackFitBatch( bool withd0 );
+  L1fittedTrack fittedTrackBatch( unsigned int iLane, unsigned int iPhiSec, unsigned int iEtaReg ) const;
+
 private:
   // Configuration parameters
   const Settings* settings_;
@@ -84,11 +103,79 @@ private:
   int ichisq1_;
   int ichisq2_;
 
+  // Stubs in barrel or disks, stored as structure-of-arrays, so the loops over them have no branches.
+  // Includes the index of each stub in stubs_, and data that doesn't depend on the helix params.
+  struct StubGroup {
+    unsigned int n;
+    unsigned int index  [__MAX_STUBS_PER_TRK__];
+    double       r      [__MAX_STUBS_PER_TRK__];
+    double       z      [__MAX_STUBS_PER_TRK__];
+    double       phi    [__MAX_STUBS_PER_TRK__];
+    double       sigmaX [__MAX_STUBS_PER_TRK__];
+    double       sigmaZ [__MAX_STUBS_PER_TRK__];
+    double       deltai [__MAX_STUBS_PER_TRK__];
+    double       theta0 [__MAX_STUBS_PER_TRK__];
+  };
+
+  StubGroup barrelStubs_;
+  StubGroup diskStubs_;
+
   float D_[5][2*__MAX_STUBS_PER_TRK__];
   
-  float M_[5][10];
-  
-  float MinvDt_[5][2*__MAX_STUBS_PER_TRK__];
+  float M_[5][5];
+
+  // Residuals, their sum of squares and D*residuals from the last 4 parameter fit.
+  double delta_[2*__MAX_STUBS_PER_TRK__];
+  double chisqDelta_;
+  double cov_[5];
+
+  // Batch of track candidates being fitted by fitBatch(), with one lane per candidate.
+  // Arrays are indexed [...][lane]. Lanes with fewer stubs than nStubsMax are padded with masked stubs.
+  struct Batch {
+    unsigned int nLanes;
+    unsigned int nStubsMax;
+    const L1track3D*           trk   [__FIT_BATCH_LANES__];
+    std::vector< const Stub* > stubs [__FIT_BATCH_LANES__];
+
+    // Stub data, which does not depend on the helix params.
+    bool   valid  [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    bool   barrel [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double r      [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double z      [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double phi    [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double sigmaX [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double sigmaZ [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double deltai [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double theta0 [__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+
+    // Helix params & fit results.
+    float rinv [__FIT_BATCH_LANES__];
+    float phi0 [__FIT_BATCH_LANES__];
+    float z0   [__FIT_BATCH_LANES__];
+    float t    [__FIT_BATCH_LANES__];
+    float d0   [__FIT_BATCH_LANES__];
+    float rinvfit4par [__FIT_BATCH_LANES__];
+    float phi0fit4par [__FIT_BATCH_LANES__];
+    float z0fit4par   [__FIT_BATCH_LANES__];
+    float tfit4par    [__FIT_BATCH_LANES__];
+    float rinvfit [__FIT_BATCH_LANES__];
+    float phi0fit [__FIT_BATCH_LANES__];
+    float d0fit   [__FIT_BATCH_LANES__];
+    float z0fit   [__FIT_BATCH_LANES__];
+    float tfit    [__FIT_BATCH_LANES__];
+    float chisq     [__FIT_BATCH_LANES__];
+    float chisq4par [__FIT_BATCH_LANES__];
+    float largestresid  [__FIT_BATCH_LANES__];
+    int   ilargestresid [__FIT_BATCH_LANES__];
+
+    float  D          [5][2*__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    float  M          [5][5][__FIT_BATCH_LANES__];
+    double delta      [2*__MAX_STUBS_PER_TRK__][__FIT_BATCH_LANES__];
+    double chisqDelta [__FIT_BATCH_LANES__];
+    double cov        [5][__FIT_BATCH_LANES__];
+  };
+
+  Batch batch_;
 
   // Configuration parameters
   int numFittingIterations_;
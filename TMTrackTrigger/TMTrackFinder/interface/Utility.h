@@ -9,6 +9,9 @@ class Stub;
 class Settings;
 
 namespace Utility {
+  // Number of distinct tracker layers that countLayers() can distinguish.
+  const unsigned int maxLayerForCounting = 30;
+
   // Count number of tracker layers a given list of stubs are in.
   //
   // By default uses the "reduced" layer ID if the configuration file requested it. However, 
@@ -25,6 +28,11 @@ namespace Utility {
   
   unsigned int countLayers(const Settings* settings, const std::vector<const Stub*>& stubs, bool disableReducedLayerID = false, bool onlyPS = false);
 
+  // Tracker layer of a stub, as used by countLayers(), in range 0 to maxLayerForCounting-1.
+  // Allows layer counts to be updated incrementally as stubs are added to or removed from a track.
+
+  unsigned int layerForCounting(const Settings* settings, const Stub* stub, bool disableReducedLayerID = false);
+
   // Given a set of stubs (presumably on a reconstructed track candidate)
   // return the best matching Tracking Particle (if any),
   // the number of tracker layers in which one of the stubs matched one from this tracking particle,
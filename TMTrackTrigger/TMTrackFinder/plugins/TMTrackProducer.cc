@@ -4,6 +4,7 @@
 #include <TMTrackTrigger/TMTrackFinder/interface/Settings.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/Histos.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/Sector.h>
+#include <TMTrackTrigger/TMTrackFinder/interface/SectorMembership.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/HTpair.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/KillDupFitTrks.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/TrackFitGeneric.h>
@@ -12,6 +13,12 @@
 /*CMSSW_8_MIGRATION*/ // #include <TMTrackTrigger/TMTrackFinder/interface/ConverterToTTTrack.h>
 #include "TMTrackTrigger/TMTrackFinder/interface/HTcell.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DemoOutput.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/DemoTestVectorWriter.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/StageTimers.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HistosWorker.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleGeometryCache.h"
 
 #include "FWCore/Framework/interface/ESHandle.h"
 #include "FWCore/Framework/interface/Event.h"
@@ -23,6 +30,7 @@
 #include <iostream>
 #include <vector>
 #include <set>
+#include <memory>
 
 using namespace std;
 using  boost::numeric::ublas::matrix;
@@ -35,9 +43,8 @@ TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) {
   cout.setf(ios::fixed, ios::floatfield);
   cout.precision(4);
 
-  // Book histograms.
+  // Create histograms. (Each family of histograms is booked when first filled).
   hists_ = new Histos( settings_ );
-  hists_->book();
 
   // Create track fitting algorithm (& internal histograms if it uses them)
   for (const string& fitterName : settings_->trackFitters()) {
@@ -45,6 +52,27 @@ TMTrackProducer::TMTrackProducer(const edm::ParameterSet& iConfig) {
     fitterWorkerMap_[ fitterName ]->bookHists(); 
   }
 
+  // Fills the histograms with the results of each event, optionally in a separate thread.
+  histosWorker_ = new HistosWorker( settings_, hists_ );
+
+  // Cache of the tracker module info needed to unpack the stubs, filled as modules are encountered.
+  moduleCache_ = new ModuleGeometryCache;
+
+  // Optionally histogram the time spent in each processing stage & sector.
+  stageTimers_ = nullptr;
+  if (settings_->stageTiming()) {
+    stageTimers_ = new StageTimers( settings_ );
+    stageTimers_->book();
+  }
+
+  // Optionally write stubs & tracking particles to a snapshot file, so they can be replayed without CMSSW.
+  snapshotWriter_ = nullptr;
+  if (settings_->snapshotFile() != "") snapshotWriter_ = new EventSnapshotWriter(settings_->snapshotFile(), settings_->stubMatchStrict());
+
+  // Optionally write the digitized stubs at the HT output to a file of test vectors for the firmware.
+  testVectorWriter_ = nullptr;
+  if (settings_->testVectorFile() != "") testVectorWriter_ = new DemoTestVectorWriter(settings_->testVectorFile(), settings_);
+
   //--- Define EDM output to be written to file (if required) 
 
 /*CMSSW_8_MIGRATION*/ //  // L1 tracks found by Hough Transform without any track fit.
@@ -72,8 +100,14 @@ void TMTrackProducer::beginRun(const edm::Run& iRun, const edm::EventSetup& iSet
   float bField = theMagneticField->inTesla(GlobalPoint(0,0,0)).z(); // B field in Tesla.
   cout<<endl<<"--- B field = "<<bField<<" Tesla ---"<<endl<<endl;
 
+  // Don't change the B-field while the previous run is still being histogrammed.
+  histosWorker_->wait();
+
   settings_->setBfield(bField);
 
+  // The tracker geometry may change between runs, so forget the cached module info.
+  moduleCache_->clear();
+
   // Initialize track fitting algorithm at start of run (especially with B-field dependent variables).
   for (const string& fitterName : settings_->trackFitters()) {
     fitterWorkerMap_[ fitterName ]->initRun(); 
@@ -82,22 +116,32 @@ void TMTrackProducer::beginRun(const edm::Run& iRun, const edm::EventSetup& iSet
 
 void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 {
+  // N.B. Each StageTimers::Scope object below adds the time until it is destroyed to the named stage.
+  if (stageTimers_ != nullptr) stageTimers_->startEvent();
+  std::unique_ptr<StageTimers::Scope> timerInput(new StageTimers::Scope(stageTimers_, StageTimers::InputDecoding));
 
   // Note useful info about MC truth particles and about reconstructed stubs .
-  InputData inputData(iEvent, iSetup, settings_);
+  InputData* newInputData = new InputData(iEvent, iSetup, settings_, moduleCache_);
+  timerInput.reset();
+
+  // Storage for all the results of this event that are histogrammed, which will contain the InputData,
+  // the Sector and HT arrays and the fitted tracks. (Reused from an earlier event if possible).
+  std::unique_ptr<HistosEvent> histosEvent = histosWorker_->newEvent();
+  histosEvent->reset( newInputData );
+  const InputData& inputData = *(histosEvent->inputData);
 
   const vector<TP>&          vTPs   = inputData.getTPs();
   const vector<const Stub*>& vStubs = inputData.getStubs(); 
 
   cout<<"INPUT #TPs = "<<vTPs.size()<<" #STUBs = "<<vStubs.size()<<endl;
 
-  //=== Fill histograms with stubs and tracking particles from input data.
-  hists_->fillInputData(inputData);
+  // Save the stubs & tracking particles to the snapshot file if requested (before the stubs are digitized).
+  if (snapshotWriter_ != nullptr) snapshotWriter_->write(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event(), inputData);
 
-  // Creates matrix of Sector objects, which decide which stubs are in which (eta,phi) sector
-  matrix<Sector>  mSectors(settings_->numPhiSectors(), settings_->numEtaRegions());
-  // Create matrix of Hough-Transform arrays, with one-to-one correspondence to sectors.
-  matrix<HTpair>  mHtPairs(settings_->numPhiSectors(), settings_->numEtaRegions());
+  // Matrix of Sector objects, which decide which stubs are in which (eta,phi) sector
+  matrix<Sector>& mSectors = histosEvent->mSectors;
+  // Matrix of Hough-Transform arrays, with one-to-one correspondence to sectors.
+  matrix<HTpair>& mHtPairs = histosEvent->mHtPairs;
 
   //=== Initialization
 /*CMSSW_8_MIGRATION*/ //  // Create utility for converting L1 tracks from our private format to official CMSSW EDM format.
@@ -121,6 +165,23 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 /*CMSSW_8_MIGRATION*/ //    std::auto_ptr<HwTrackCollection>         effTracks(new HwTrackCollection);
 /*CMSSW_8_MIGRATION*/ //    std::auto_ptr<HwTrackCollection>     algoEffTracks(new HwTrackCollection);
 
+  //=== Initialize the sectors, and note which of them each stub is inside.
+  //=== (This is done before the stubs are digitized, so is used by the histogramming even if digitization is enabled).
+
+  for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
+    for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
+      mSectors(iPhiSec, iEtaReg).init(settings_, iPhiSec, iEtaReg); 
+    }
+  }
+
+  const SectorMembership& sectorMembership = histosEvent->sectorMembership;
+  {
+    StageTimers::Scope timerMembership(stageTimers_, settings_->enableDigitize()  ?  StageTimers::Histogramming  :  StageTimers::Routing);
+    histosEvent->sectorMembership.fill(mSectors, inputData);
+  }
+  // Don't attribute the time spent above to the first sector in the per-sector timing histograms.
+  if (stageTimers_ != nullptr) stageTimers_->startSectors();
+
   //=== Loop over matrix of Hough-Transform arrays, filling them with stubs.
 
   unsigned ntracks(0);
@@ -132,32 +193,59 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
       HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
 
       // Initialize constants for this sector.
-      sector.init(settings_, iPhiSec, iEtaReg); 
       htPair.init(settings_, sector.etaMin(), sector.etaMax(), sector.phiCentre());
+      htPair.setStageTimers(stageTimers_);
+
+      // Route stubs to this sector. (This is done before filling the HT, so that the two can be timed separately).
+      vector<pair<const Stub*, vector<bool>>> stubsInSector;
+      {
+	StageTimers::Scope timerRouting(stageTimers_, StageTimers::Routing);
+
+	if (settings_->enableDigitize()) {
+	  for (const Stub* stub: vStubs) {
+	    // Digitize stub as would be at input to GP. This doesn't need the octant number, since we assumed an integer number of
+	    // phi digitisation  bins inside an octant. N.B. This changes the coordinates & bend stored in the stub.
+	    // The cast allows us to ignore the "const".
+	    (const_cast<Stub*>(stub))->digitizeForGPinput(iPhiSec);
+
+	    // Check if stub is inside this sector
+	    bool inside = sector.inside( stub );
+
+	    if (inside) {
+	      // Check which eta subsectors within the sector the stub is compatible with (if subsectors being used).
+	      const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
+
+	      // Digitize stub if as would be at input to HT, which slightly degrades its coord. & bend resolution, affecting the HT performance.
+	      (const_cast<Stub*>(stub))->digitizeForHTinput(iPhiSec);
+
+	      stubsInSector.push_back( make_pair(stub, inEtaSubSecs) );
+	    }
+	  }
+
+	} else {
+	  // Without digitization, the stub coordinates don't change, so the stubs inside this sector are already known.
+	  for (const Stub* stub : sectorMembership.stubsInSector(iPhiSec, iEtaReg)) {
+	    stubsInSector.push_back( make_pair(stub, sector.insideEtaSubSecs( stub )) );
+	  }
+	}
+      }
 
-      for (const Stub* stub: vStubs) {
-	// Digitize stub as would be at input to GP. This doesn't need the octant number, since we assumed an integer number of
-	// phi digitisation  bins inside an octant. N.B. This changes the coordinates & bend stored in the stub.
-	// The cast allows us to ignore the "const".
-	if (settings_->enableDigitize()) (const_cast<Stub*>(stub))->digitizeForGPinput(iPhiSec);
-
-	// Check if stub is inside this sector
-        bool inside = sector.inside( stub );
-
-        if (inside) {
-	  // Check which eta subsectors within the sector the stub is compatible with (if subsectors being used).
-	  const vector<bool> inEtaSubSecs =  sector.insideEtaSubSecs( stub );
-
-	  // Digitize stub if as would be at input to HT, which slightly degrades its coord. & bend resolution, affecting the HT performance.
-	  if (settings_->enableDigitize()) (const_cast<Stub*>(stub))->digitizeForHTinput(iPhiSec);
+      {
+	StageTimers::Scope timerFill(stageTimers_, StageTimers::HTfill);
 
-	  // Store stub in Hough transform array for this sector, indicating its compatibility with eta subsectors with sector.
-	  htPair.store( stub, inEtaSubSecs );
+	// Store stub in Hough transform array for this sector, indicating its compatibility with eta subsectors with sector.
+	for (const auto& stubInSector : stubsInSector) {
+	  htPair.store( stubInSector.first, stubInSector.second );
 	}
       }
 
-      // Finish. Look for tracks in r-phi HT array etc.
-      htPair.end();
+      // Finish. Look for tracks in r-phi HT array etc. (The r-z filters run inside this are timed separately).
+      {
+	StageTimers::Scope timerEnd(stageTimers_, StageTimers::HTend);
+	htPair.end();
+      }
+
+      if (stageTimers_ != nullptr) stageTimers_->fillSectorHT(iPhiSec, iEtaReg, stubsInSector.size());
 
       // Convert these tracks to EDM format for output (not used by Histos class).
       const vector<L1track3D>& vecTrk3D = htPair.trackCands3D();
@@ -175,7 +263,8 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
   
   //=== Do a helix fit to all the track candidates.
 
-  vector<std::pair<std::string, L1fittedTrack>> fittedTracks;
+  FittedTrackStore& fittedTracks = histosEvent->fittedTracks;
+  fittedTracks.clear(inputData);
   for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
@@ -188,32 +277,41 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 
       // Get track candidate sfound by Hough transform in this sector.
       const vector<L1track3D>& vecTrk3D = htPair.trackCands3D();
+      fittedTracks.beginSector(vecTrk3D);
       // Loop over all the fitting algorithms we are trying.
-      for (const string& fitterName : settings_->trackFitters()) {
+      for (unsigned int fitterId = 0; fitterId < settings_->trackFitters().size(); fitterId++) {
+	const string& fitterName = settings_->trackFitters()[fitterId];
         // Fit all tracks in this sector
 	vector<L1fittedTrack> fittedTracksInSec;
-        for (const L1track3D& trk : vecTrk3D) {
-	  L1fittedTrack fitTrack = fitterWorkerMap_[fitterName]->fit(trk, iPhiSec, iEtaReg);
+	{
+	  StageTimers::Scope timerFit(stageTimers_, StageTimers::Fit, &fitterName);
+
 	  // Store fitted tracks, such that there is one fittedTracks corresponding to each HT tracks.
 	  // N.B. Tracks rejected by the fit are also stored, but marked.
-	  fittedTracksInSec.push_back(fitTrack);
+	  fittedTracksInSec = fitterWorkerMap_[fitterName]->fitBatch(vecTrk3D, iPhiSec, iEtaReg);
 	}
 
 	// Run duplicate track removal on the fitted tracks if requested.
 	// N.B. If a duplicate removal algorithm is run, it will also remove tracks rejected by the fitter.
-	const vector<L1fittedTrack> filtFittedTracksInSec = killDupFitTrks.filter( fittedTracksInSec );
+	vector<L1fittedTrack> filtFittedTracksInSec;
+	{
+	  StageTimers::Scope timerDup(stageTimers_, StageTimers::DupRemoval);
+	  filtFittedTracksInSec = killDupFitTrks.filter( fittedTracksInSec );
+	}
 
 	// Store fitted tracks from entire tracker.
-	for (const L1fittedTrack& fitTrk : filtFittedTracksInSec) {
-	  fittedTracks.push_back(std::make_pair(fitterName, fitTrk));
-	  // Convert these fitted tracks to EDM format for output (not used by Histos class).
-	  // Only do this for valid fitted tracks, meaning that these EDM tracks do not correspond 1 to 1 with fittedTracks.
+	fittedTracks.add(fitterId, filtFittedTracksInSec);
+	// Convert these fitted tracks to EDM format for output (not used by Histos class).
+	// Only do this for valid fitted tracks, meaning that these EDM tracks do not correspond 1 to 1 with fittedTracks.
+/*CMSSW_8_MIGRATION*/ //	for (const L1fittedTrack& fitTrk : filtFittedTracksInSec) {
 /*CMSSW_8_MIGRATION*/ //	  if (fitTrk.accepted()) {
 /*CMSSW_8_MIGRATION*/ //	    TTTrack< Ref_PixelDigi_ > fitTTTrack = converter.makeTTTrack(fitTrk, iPhiSec, iEtaReg);
 /*CMSSW_8_MIGRATION*/ //	    allFitTTTracksForOutput[locationInsideArray[fitterName]]->push_back(fitTTTrack);
 /*CMSSW_8_MIGRATION*/ //	  }
-	}
+/*CMSSW_8_MIGRATION*/ //	}
       }
+
+      if (stageTimers_ != nullptr) stageTimers_->fillSectorFit(iPhiSec, iEtaReg, vecTrk3D.size());
     }
   }
 
@@ -223,32 +321,30 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
     if (settings_->enableDigitize()) (const_cast<Stub*>(stub))->reset_digitize();
   }
 
-  //=== Fill histograms that check if choice of (eta,phi) sectors is good.
-  hists_->fillEtaPhiSectors(inputData, mSectors);
-
-  //=== Fill histograms that look at filling of r-phi HT arrays.
-  hists_->fillRphiHT(mHtPairs);
-
-  //=== Fill histograms that look at r-z filters (or other filters run after r-phi HT).
-  hists_->fillRZfilters(mHtPairs);
-
-  //=== Fill histograms studying track candidates found by r-phi Hough Transform.
-  hists_->fillTrackCands(inputData, mSectors, mHtPairs);
-
-  //=== Fill histograms studying track fitting performance
-  hists_->fillTrackFitting(inputData, fittedTracks,  settings_->chi2OverNdfCut() );
-
   //=== Output digitized stubs in format expected by hardware for use by the comparison software,
-  //=== which compares hardware with software.
+  //=== which compares hardware with software, and/or as firmware test vectors.
+
+  if (settings_->enableDigitize() && (settings_->writeOutEdmFile() || testVectorWriter_ != nullptr)) {
 
-  if (settings_->enableDigitize() && settings_->writeOutEdmFile()) {
+    StageTimers::Scope timerDemo(stageTimers_, StageTimers::DemoOutput);
 
     DemoOutput demoOutput(settings_);
 
-    // Fill allOutputSimStubs and outputSimStubs with stubs stored in HardwareStub class.
+    // If only test vectors are wanted, make the stub collections locally, so the EDM collections stay empty.
+    std::auto_ptr<HwStubCollection>    localAllStubs(new HwStubCollection);
+    std::auto_ptr<HwStubCollection> localStubsOnTracks(new HwStubCollection);
+    std::auto_ptr<HwStubCollection>& allStubs      = settings_->writeOutEdmFile()  ?  allOutputSimStubs  :  localAllStubs;
+    std::auto_ptr<HwStubCollection>& stubsOnTracks = settings_->writeOutEdmFile()  ?  outputSimStubs     :  localStubsOnTracks;
+
+    // Fill allStubs and stubsOnTracks with stubs stored in HardwareStub class.
     // The former contains all stubs; the latter only stubs assigned to L1 tracks.
+    // (This digitizes copies of the stubs' digitized data, so doesn't modify the stubs themselves).
     demoOutput.getStubCollection(mHtPairs,
-   	   	                 allOutputSimStubs, outputSimStubs);
+   	   	                 allStubs, stubsOnTracks);
+
+    // Pack all the stubs into link words, and write them to the test vector file if requested.
+    if (testVectorWriter_ != nullptr) testVectorWriter_->write(iEvent.id().run(), iEvent.id().luminosityBlock(), iEvent.id().event(),
+							       mHtPairs, *allStubs);
 
 /*CMSSW_8_MIGRATION*/ //    // Fill effTracks and algoEffTracks with stubs on tracking particles stored in HardwareTrack class.
 /*CMSSW_8_MIGRATION*/ //    // The former contains all TP, whilst the latter contains only those uses for algorithmic efficiency measurment.
@@ -256,6 +352,13 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 /*CMSSW_8_MIGRATION*/ //				   effTracks, algoEffTracks);
   }
 
+  //=== Fill histograms with the results of this event. (With option AsyncHistos, this is done later by
+  //=== a separate thread, so the timer only measures the time spent waiting for it to accept the event).
+  {
+    StageTimers::Scope timerHists(stageTimers_, StageTimers::Histogramming);
+    histosWorker_->fill( std::move(histosEvent) );
+  }
+
 /*CMSSW_8_MIGRATION*/ //  //=== Store output EDM track and hardware stub collections.
 /*CMSSW_8_MIGRATION*/ //  iEvent.put(htTTTracksForOutput,  "TML1TracksHT");
 /*CMSSW_8_MIGRATION*/ //  for (const string& fitterName : settings_->trackFitters()) {
@@ -264,6 +367,8 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 /*CMSSW_8_MIGRATION*/ //  }
   iEvent.put(outputSimStubs,       "OutputSimStub");
   iEvent.put(allOutputSimStubs, "AllOutputSimStub");
+
+  if (stageTimers_ != nullptr) stageTimers_->endEvent();
 /*CMSSW_8_MIGRATION*/ //  iEvent.put(effTracks,          "EfficiencyTrack");
 /*CMSSW_8_MIGRATION*/ //  iEvent.put(algoEffTracks,  "AlgoEfficiencyTrack");
 }
@@ -271,6 +376,10 @@ void TMTrackProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
 
 void TMTrackProducer::endJob() 
 {
+  // Finish histogramming any events still queued.
+  histosWorker_->finish();
+  delete histosWorker_;
+
   hists_->endJobAnalysis();
 
   for (const string& fitterName : settings_->trackFitters()) {
@@ -278,6 +387,11 @@ void TMTrackProducer::endJob()
     delete fitterWorkerMap_[ string(fitterName) ];
   }
 
+  delete moduleCache_;
+  delete snapshotWriter_;
+  delete testVectorWriter_;
+  delete stageTimers_;
+
   cout<<endl<<"Number of (eta,phi) sectors used = (" << settings_->numEtaRegions() << "," << settings_->numPhiSectors()<<")"<<endl; 
 }
 
@@ -0,0 +1,53 @@
+import FWCore.ParameterSet.Config as cms
+
+#=== Default options for the StubGenerator, which makes stub-level events from helical tracks in a simplified
+#=== tracker. Used by the standalone executables tmttGenerate & tmttBenchmark.
+
+StubGenerator = cms.PSet(
+  # Random number seed (same seed gives same events).
+  Seed                 = cms.uint32(12345),
+  # B-field in Tesla.
+  BField               = cms.double(3.8112),
+  #
+  #--- Physics collision: signal tracks flat in 1/Pt, eta & phi.
+  #
+  NumSignalTracks      = cms.uint32(1),
+  SignalPdgId          = cms.int32(13),
+  SignalMinPt          = cms.double(3.0),
+  SignalMaxPt          = cms.double(100.0),
+  # Impact parameter smearing (cm).
+  SignalD0Sigma        = cms.double(0.0),
+  #
+  #--- Pileup: Poisson number of interactions, each with Poisson number of charged pions with exponential Pt spectrum.
+  #
+  PileUp               = cms.double(200.),
+  TracksPerInteraction = cms.double(7.),
+  PileUpMinPt          = cms.double(1.0),
+  # Slope of exponential Pt spectrum (GeV).
+  PileUpPtSlope        = cms.double(0.7),
+  PileUpD0Sigma        = cms.double(0.002),
+  #
+  #--- Common to all particles.
+  #
+  MaxAbsEta            = cms.double(2.5),
+  # Gaussian spread of interaction vertices along beam (cm).
+  BeamSpotSigmaZ       = cms.double(5.0),
+  #
+  #--- Detector response.
+  #
+  # Gaussian smearing of stub bend (strips), before rounding to half strips.
+  BendResolution       = cms.double(0.25),
+  # Stubs with larger |bend| (strips) are not formed.
+  MaxBend              = cms.double(7.5),
+  # Probability that a stub is produced in each layer crossed.
+  StubEfficiency       = cms.double(0.99),
+  # Properties of PS & 2S modules (cm).
+  StripPitchPS         = cms.double(0.01),
+  StripLengthPS        = cms.double(0.1467),
+  NumStripsPS          = cms.uint32(960),
+  NumRowsPS            = cms.uint32(32),
+  StripPitch2S         = cms.double(0.009),
+  StripLength2S        = cms.double(5.025),
+  NumStrips2S          = cms.uint32(1016),
+  NumRows2S            = cms.uint32(2)
+)
@@ -39,8 +39,8 @@ std::vector<double> ChiSquared4ParamsApprox::seed(const L1track3D& l1track3D){
     return mapToVec(x);
 }
  
-Matrix<double> ChiSquared4ParamsApprox::D(std::vector<double> x){
-    Matrix<double> D(2 * stubs_.size(), nPar_, 0.0); // Empty matrix
+void ChiSquared4ParamsApprox::D(const std::vector<double>& x, std::vector<double>& d){
+    d.assign(2 * stubs_.size() * nPar_, 0.0); // Empty matrix
     int j = 0;
     std::map<std::string, double> y = vecToMap(x); // Get the track params by label
     double rInv = y["rInv"];
@@ -51,15 +51,15 @@ Matrix<double> ChiSquared4ParamsApprox::D(std::vector<double> x){
         double ri=stubs_[i]->r();
         double zi=stubs_[i]->z();
         if( stubs_[i]->barrel() ){
-	  D(j, 0) = -0.5*ri*ri; // Fine for now;
-	  D(j, 1) = ri; // Fine
-	  //D(j, 2);
-	  //D(j, 3);
+	  d[j*nPar_ + 0] = -0.5*ri*ri; // Fine for now;
+	  d[j*nPar_ + 1] = ri; // Fine
+	  //d[j*nPar_ + 2];
+	  //d[j*nPar_ + 3];
 	  j++;
-	  //D(j, 0)
-	  //D(j, 1)
-	  D(j, 2) = ri; // ri; // Fine for now
-	  D(j, 3) = 1; // Fine
+	  //d[j*nPar_ + 0]
+	  //d[j*nPar_ + 1]
+	  d[j*nPar_ + 2] = ri; // ri; // Fine for now
+	  d[j*nPar_ + 3] = 1; // Fine
 	  j++;
         } 
 	else {
@@ -83,31 +83,30 @@ Matrix<double> ChiSquared4ParamsApprox::D(std::vector<double> x){
 	  
 	  double tInv = 1/t;
 	  
-	  D(j, 0) = -0.167*ri*ri*ri*rInv; // Tweaking of constant?
-	  D(j, 1) = 0; // Exact
-	  D(j, 2) = -ri*tInv; // Fine;
-	  D(j, 3) = -1*tInv; // Fine
+	  d[j*nPar_ + 0] = -0.167*ri*ri*ri*rInv; // Tweaking of constant?
+	  d[j*nPar_ + 1] = 0; // Exact
+	  d[j*nPar_ + 2] = -ri*tInv; // Fine;
+	  d[j*nPar_ + 3] = -1*tInv; // Fine
 	  j++;
 	  //second the rphi position
-	  D(j, 0) = -0.5 * ri * ri; // Needs fine tuning, was (phimultiplier*-0.5*(zi-z0)/t+rmultiplier*drdrinv);
-	  D(j, 1) = ri; // Fine, originally phimultiplier
-	  D(j, 2) = ri*0.5*rInv*ri*tInv - ((phi_track-phii)-theta0)*ri*tInv;
-	  D(j, 3) = ri*0.5*rInv*tInv    - ((phi_track-phii)-theta0)*tInv;
+	  d[j*nPar_ + 0] = -0.5 * ri * ri; // Needs fine tuning, was (phimultiplier*-0.5*(zi-z0)/t+rmultiplier*drdrinv);
+	  d[j*nPar_ + 1] = ri; // Fine, originally phimultiplier
+	  d[j*nPar_ + 2] = ri*0.5*rInv*ri*tInv - ((phi_track-phii)-theta0)*ri*tInv;
+	  d[j*nPar_ + 3] = ri*0.5*rInv*tInv    - ((phi_track-phii)-theta0)*tInv;
 	  j++;
         }
     }
-    return D;
 }
  
-Matrix<double> ChiSquared4ParamsApprox::Vinv(){
-    Matrix<double> Vinv(2*stubs_.size(), 2*stubs_.size(), 0.0);
+std::vector<double> ChiSquared4ParamsApprox::Vinv(){
+    std::vector<double> Vinv(2*stubs_.size(), 0.0);
     for(unsigned i = 0; i < stubs_.size(); i++){
         if(stubs_[i]->barrel()){
-            Vinv(2*i, 2*i) = 1/stubs_[i]->sigmaX();
-            Vinv(2*i + 1, 2*i + 1) = 1/stubs_[i]->sigmaZ();
+            Vinv[2*i] = 1/stubs_[i]->sigmaX();
+            Vinv[2*i + 1] = 1/stubs_[i]->sigmaZ();
         }else{
-            Vinv(2*i, 2*i) = 1/stubs_[i]->sigmaZ();
-            Vinv(2*i + 1, 2*i + 1) = 1/stubs_[i]->sigmaX();
+            Vinv[2*i] = 1/stubs_[i]->sigmaZ();
+            Vinv[2*i + 1] = 1/stubs_[i]->sigmaX();
         }
  
     }
@@ -39,8 +39,8 @@ std::vector<double> ChiSquared4ParamsTrackletStyle::seed(const L1track3D& l1trac
     return mapToVec(x);
 }
  
-Matrix<double> ChiSquared4ParamsTrackletStyle::D(std::vector<double> x){
-    Matrix<double> D(2 * stubs_.size(), nPar_, 0.0); // Empty matrix
+void ChiSquared4ParamsTrackletStyle::D(const std::vector<double>& x, std::vector<double>& d){
+    d.assign(2 * stubs_.size() * nPar_, 0.0); // Empty matrix
     int j = 0;
     std::map<std::string, double> y = vecToMap(x); // Get the track params by label
     double rInv = y["rInv"];
@@ -51,15 +51,15 @@ Matrix<double> ChiSquared4ParamsTrackletStyle::D(std::vector<double> x){
         double ri=stubs_[i]->r();
         double zi=stubs_[i]->z();
         if(stubs_[i]->barrel()){
-            D(j, 0) = -0.5*ri*ri/sqrt(1-0.25*ri*ri*rInv*rInv);
-            D(j, 1) = ri;
-            //D(j, 2) = 0;
-            //D(j, 3) = 0;
+            d[j*nPar_ + 0] = -0.5*ri*ri/sqrt(1-0.25*ri*ri*rInv*rInv);
+            d[j*nPar_ + 1] = ri;
+            //d[j*nPar_ + 2] = 0;
+            //d[j*nPar_ + 3] = 0;
             j++;
-            //D(j, 0)
-            //D(j, 1)
-            D(j, 2) = (2/rInv)*asin(0.5*ri*rInv);
-            D(j, 3) = 1;
+            //d[j*nPar_ + 0]
+            //d[j*nPar_ + 1]
+            d[j*nPar_ + 2] = (2/rInv)*asin(0.5*ri*rInv);
+            d[j*nPar_ + 3] = 1;
             j++;
         }else{
             //here we handle a disk hit
@@ -95,31 +95,30 @@ Matrix<double> ChiSquared4ParamsTrackletStyle::D(std::vector<double> x){
             double dphidt=0.5*rInv*(zi-z0)/(t*t);
             double dphidz0=0.5*rInv/t;
        
-            D(j, 0) = drdrinv;
-            D(j, 1) = drdphi0;
-            D(j, 2) = drdt;
-            D(j, 3) = drdz0;
+            d[j*nPar_ + 0] = drdrinv;
+            d[j*nPar_ + 1] = drdphi0;
+            d[j*nPar_ + 2] = drdt;
+            d[j*nPar_ + 3] = drdz0;
             j++;
             //second the rphi position
-            D(j, 0) = (phimultiplier*dphidrinv+rmultiplier*drdrinv);
-            D(j, 1) = (phimultiplier*dphidphi0+rmultiplier*drdphi0);
-            D(j, 2) = (phimultiplier*dphidt+rmultiplier*drdt);
-            D(j, 3) = (phimultiplier*dphidz0+rmultiplier*drdz0);
+            d[j*nPar_ + 0] = (phimultiplier*dphidrinv+rmultiplier*drdrinv);
+            d[j*nPar_ + 1] = (phimultiplier*dphidphi0+rmultiplier*drdphi0);
+            d[j*nPar_ + 2] = (phimultiplier*dphidt+rmultiplier*drdt);
+            d[j*nPar_ + 3] = (phimultiplier*dphidz0+rmultiplier*drdz0);
             j++;
         }
     }
-    return D;
 }
  
-Matrix<double> ChiSquared4ParamsTrackletStyle::Vinv(){
-    Matrix<double> Vinv(2*stubs_.size(), 2*stubs_.size(), 0.0);
+std::vector<double> ChiSquared4ParamsTrackletStyle::Vinv(){
+    std::vector<double> Vinv(2*stubs_.size(), 0.0);
     for(unsigned i = 0; i < stubs_.size(); i++){
         if(stubs_[i]->barrel()){
-            Vinv(2*i, 2*i) = 1/stubs_[i]->sigmaX();
-            Vinv(2*i + 1, 2*i + 1) = 1/stubs_[i]->sigmaZ();
+            Vinv[2*i] = 1/stubs_[i]->sigmaX();
+            Vinv[2*i + 1] = 1/stubs_[i]->sigmaZ();
         }else{
-            Vinv(2*i, 2*i) = 1/stubs_[i]->sigmaZ();
-            Vinv(2*i + 1, 2*i + 1) = 1/stubs_[i]->sigmaX();
+            Vinv[2*i] = 1/stubs_[i]->sigmaZ();
+            Vinv[2*i + 1] = 1/stubs_[i]->sigmaX();
         }
  
     }
@@ -42,8 +42,8 @@ std::vector<double> ChiSquared5ParamsApprox::seed(const L1track3D& l1track3D){
     return mapToVec(x);
 }
  
-Matrix<double> ChiSquared5ParamsApprox::D(std::vector<double> x){
-    Matrix<double> D(2 * stubs_.size(), nPar_, 0.0); // Empty matrix
+void ChiSquared5ParamsApprox::D(const std::vector<double>& x, std::vector<double>& d){
+    d.assign(2 * stubs_.size() * nPar_, 0.0); // Empty matrix
     int j = 0;
     std::map<std::string, double> y = vecToMap(x); // Get the track params by label
     double rInv = y["2r1Inv"];
@@ -55,26 +55,25 @@ Matrix<double> ChiSquared5ParamsApprox::D(std::vector<double> x){
         double ri=stubs_[i]->r();
         double zi=stubs_[i]->z();
    
-        D(j, 0) = ri;
-        D(j, 1) = 1;
-        D(j, 2) = 1/ri;
-        //D(j, 3) = 0;
+        d[j*nPar_ + 0] = ri;
+        d[j*nPar_ + 1] = 1;
+        d[j*nPar_ + 2] = 1/ri;
+        //d[j*nPar_ + 3] = 0;
  
         j++;
-        //D(j, 0)
-        //D(j, 1)
-        D(j, 3) = 1;
-        D(j, 4) = ri;
+        //d[j*nPar_ + 0]
+        //d[j*nPar_ + 1]
+        d[j*nPar_ + 3] = 1;
+        d[j*nPar_ + 4] = ri;
         j++;
     }
-    return D;
 }
  
-Matrix<double> ChiSquared5ParamsApprox::Vinv(){
-    Matrix<double> Vinv(2*stubs_.size(), 2*stubs_.size(), 0.0);
+std::vector<double> ChiSquared5ParamsApprox::Vinv(){
+    std::vector<double> Vinv(2*stubs_.size(), 0.0);
     for(unsigned i = 0; i < stubs_.size(); i++){
-        Vinv(2*i, 2*i) = 1/stubs_[i]->sigmaX();
-        Vinv(2*i + 1, 2*i + 1) = 1/stubs_[i]->sigmaZ();
+        Vinv[2*i] = 1/stubs_[i]->sigmaX();
+        Vinv[2*i + 1] = 1/stubs_[i]->sigmaZ();
  
     }
     return Vinv;
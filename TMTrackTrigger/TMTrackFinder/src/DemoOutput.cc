@@ -1,7 +1,9 @@
 #include <TMTrackTrigger/TMTrackFinder/interface/DemoOutput.h>
 #include <TMTrackTrigger/TMTrackFinder/interface/Settings.h>
+#include <TMTrackTrigger/TMTrackFinder/interface/DigitalStub.h>
 
 #include <iostream>
+#include <unordered_map>
 
 
 //=== Create EDM collections of all stubs and of the subset of stubs that are on L1 tracks, stored in the HardwareStub class.
@@ -14,6 +16,10 @@ void DemoOutput::getStubCollection(
 {
 	using namespace boost::numeric::ublas;
 	
+  // Copies of the stubs' digitized data, digitized relative to the current sector. (So the stubs themselves,
+  // which are shared by all sectors, are not modified).
+  std::unordered_map<const Stub*, DigitalStub> digiStubsInSector;
+
   for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
@@ -23,17 +29,32 @@ void DemoOutput::getStubCollection(
       const HTrphi& htRphi = htPair.getRphiHT();
       const matrix<HTcell>& htArray = htRphi.getAllCells();
 
+      // Note which cells of the array have track candidates that were read out.
+      // An individual HT cell doesn't know if tracks were killed because the sector was too "busy".
+      // So check if this track was read out within TM period. The r-phi HT array object knows this.
+      const bool busySectorKill = settings_->busySectorKill(); // Is option to kill tracks not read out in TM period enabled?
+      matrix<bool> survivedCells(htArray.size1(), htArray.size2(), ! busySectorKill);
+      if (busySectorKill) {
+	for (const L1track2D& trk: htRphi.trackCands2D()) {
+	  survivedCells(trk.getCellLocation().first, trk.getCellLocation().second) = true;
+	}
+      }
+
+      digiStubsInSector.clear();
+
       // Loop over cells in the array
       for(unsigned int j = 0 ; j< htArray.size2(); ++j ){
 	for(unsigned int i = 0 ; i < htArray.size1(); ++i) {
 	  const std::vector < const Stub* >& stubs = htArray(i,j).stubs();
 	  for(const Stub* stub : stubs) {
-	    // Digitize stub relative to this phi sector for input to GP.
-	    (const_cast<Stub*>(stub))->digitizeForGPinput(iPhiSec);
-	    // Now digitize stub relative to this phi sector for input to HT.
-	    (const_cast<Stub*>(stub))->digitizeForHTinput(iPhiSec);
+	    // Digitize stub relative to this phi sector for input to HT (and hence GP), unless already done for this sector.
+	    auto digiIter = digiStubsInSector.find(stub);
+	    if (digiIter == digiStubsInSector.end()) {
+	      digiIter = digiStubsInSector.insert( std::make_pair(stub, stub->digitalStub()) ).first;
+	      digiIter->second.makeHTinput(iPhiSec);
+	    }
 
-	    const DigitalStub& digiStub = stub->digitalStub();
+	    const DigitalStub& digiStub = digiIter->second;
 
 	    // Calculate bin in Hough transform array of this stub, in format expect by hardware
 	    int mbin = i;
@@ -48,22 +69,8 @@ void DemoOutput::getStubCollection(
 
 	    // Store stub.
 	    hwStubs->push_back(lstub);
-	    // Also store only stubs associated with reconstructed L1 tracks.
-	    if (htArray(i,j).trackCandFound()) {
-	      // An individual HT cell doesn't know if tracks were killed because the sector was too "busy".
-	      // So check if this track was read out within TM period. The r-phi HT array object knows this.
-	      bool survived;
-	      if (settings_->busySectorKill()) { // Is option to kill tracks not read out in TM period enabled?
-		survived = false;
-		const std::vector<L1track2D>& tracks = htRphi.trackCands2D();  
-		for (const L1track2D& trk: tracks) {
-		  if (i ==  trk.getCellLocation().first && j == trk.getCellLocation().second) survived = true;
-		}
-	      } else {
-		survived = true;
-	      }
-	      if (survived) hwStubsOnTracks->push_back(lstub);
-	    }
+	    // Also store only stubs associated with reconstructed L1 tracks, that were read out.
+	    if (htArray(i,j).trackCandFound() && survivedCells(i,j)) hwStubsOnTracks->push_back(lstub);
 	  }
 	}
       }
@@ -0,0 +1,145 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/DemoTestVectorWriter.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+  const char         testVectorMagic[8]   = {'T','M','T','T','L','I','N','K'};
+  const uint32_t     testVectorVersion    = 1;
+
+  // Number of bits needed to store numbers in range 0 to n-1.
+  unsigned int bitsFor(unsigned int n) {
+    unsigned int nBits = 1;
+    while ((1u << nBits) < n) nBits++;
+    return nBits;
+  }
+}
+
+//=== Open test vector file. (Its header is written with the first event).
+
+DemoTestVectorWriter::DemoTestVectorWriter(const string& fileName, const Settings* settings) :
+  settings_(settings),
+  fileName_(fileName),
+  out_(fileName.c_str(), ios::out | ios::binary | ios::trunc),
+  nEvents_(0)
+{
+  if (! settings_->enableDigitize()) throw cms::Exception("DemoTestVectorWriter: Writing test vectors requires stub digitization to be enabled")<<endl;
+  if (! out_.good()) throw cms::Exception("DemoTestVectorWriter: Failed to open output file ")<<fileName_<<endl;
+
+  vWords_.reserve(100000);
+}
+
+DemoTestVectorWriter::~DemoTestVectorWriter() {
+  out_.close();
+  cout<<"DemoTestVectorWriter: wrote "<<nEvents_<<" events to "<<fileName_<<endl;
+}
+
+//=== Define the link word format, taking the field widths from the digitization configuration
+//=== & the HT array dimensions, and write the file header.
+
+void DemoTestVectorWriter::writeFileHeader(unsigned int nBinsM, unsigned int nBinsC) {
+
+  l1t::HardwareStubLinkFormat::Widths widths;
+  widths.phiSec  = 0; // Given by the TestVectorSector records.
+  widths.etaReg  = 0;
+  widths.subEta  = settings_->numSubSecsEta(); // Bit mask of the eta subsectors of the stub.
+  widths.layerId = settings_->reduceLayerID()  ?  3  :  4;
+  widths.phiS    = settings_->phiSBits();
+  widths.rT      = settings_->rtBits();
+  widths.z       = settings_->zBits();
+  widths.dphi    = settings_->dPhiBits();
+  widths.rho     = settings_->rhoBits();
+  widths.mBin    = bitsFor(nBinsM);
+  widths.cBin    = bitsFor(nBinsC);
+  linkFormat_.reset(new l1t::HardwareStubLinkFormat(l1t::HardwareStubLinkFormat::HToutput, widths));
+
+  TestVectorFileHeader fileHeader;
+  memset(&fileHeader, 0, sizeof(fileHeader));
+  memcpy(fileHeader.magic, testVectorMagic, sizeof(testVectorMagic));
+  fileHeader.version       = testVectorVersion;
+  fileHeader.format        = linkFormat_->format();
+  fileHeader.numBits       = linkFormat_->numBits();
+  fileHeader.numFields     = linkFormat_->fields().size();
+  fileHeader.numPhiSectors = settings_->numPhiSectors();
+  fileHeader.numEtaRegions = settings_->numEtaRegions();
+  for (unsigned int i = 0; i < linkFormat_->fields().size(); i++) {
+    const l1t::HardwareStubLinkFormat::Field& field = linkFormat_->fields()[i];
+    TestVectorField& rec = fileHeader.fields[i];
+    strncpy(rec.name, field.name, sizeof(rec.name) - 1);
+    rec.shift    = field.shift;
+    rec.width    = field.width;
+    rec.isSigned = field.isSigned;
+  }
+  out_.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+}
+
+//=== Append the HT output stubs of one event to the file.
+
+void DemoTestVectorWriter::write(uint32_t run, uint32_t lumi, uint64_t event, const boost::numeric::ublas::matrix<HTpair>& mHtPairs, const vector<l1t::HardwareStub>& hwStubs) {
+
+  const unsigned int numPhiSectors = settings_->numPhiSectors();
+  const unsigned int numEtaRegions = settings_->numEtaRegions();
+
+  if (linkFormat_ == nullptr) {
+    const auto& htArray = mHtPairs(0, 0).getRphiHT().getAllCells();
+    this->writeFileHeader(htArray.size1(), htArray.size2());
+  }
+
+  // Count the stubs in each sector, and hence find where the words of each sector start.
+  vSectors_.resize(numPhiSectors*numEtaRegions);
+  for (unsigned int iPhiSec = 0; iPhiSec < numPhiSectors; iPhiSec++) {
+    for (unsigned int iEtaReg = 0; iEtaReg < numEtaRegions; iEtaReg++) {
+      TestVectorSector& sec = vSectors_[iPhiSec*numEtaRegions + iEtaReg];
+      sec.iPhiSec = iPhiSec;
+      sec.iEtaReg = iEtaReg;
+      sec.nWords  = 0;
+    }
+  }
+  for (const l1t::HardwareStub& stub : hwStubs) {
+    if (stub.phiSec() >= numPhiSectors || stub.etaRegion() >= numEtaRegions) throw cms::Exception("DemoTestVectorWriter: Stub in invalid sector ")<<stub.phiSec()<<" "<<stub.etaRegion()<<endl;
+    vSectors_[stub.phiSec()*numEtaRegions + stub.etaRegion()].nWords++;
+  }
+  vNext_.resize(vSectors_.size());
+  uint32_t nWords = 0;
+  for (unsigned int i = 0; i < vSectors_.size(); i++) {
+    vNext_[i] = nWords;
+    nWords += vSectors_[i].nWords;
+  }
+
+  // Pack each stub directly into its place in the output buffer. DemoOutput makes the stubs sector by sector,
+  // so if this is still the case, pack them all in one go.
+  vWords_.resize(nWords);
+  bool sectorOrdered = true;
+  for (unsigned int i = 1; i < hwStubs.size() && sectorOrdered; i++) {
+    sectorOrdered = (hwStubs[i-1].phiSec()*numEtaRegions + hwStubs[i-1].etaRegion() <= hwStubs[i].phiSec()*numEtaRegions + hwStubs[i].etaRegion());
+  }
+  if (sectorOrdered) {
+    linkFormat_->encode(hwStubs, vWords_.data());
+  } else {
+    for (const l1t::HardwareStub& stub : hwStubs) {
+      vWords_[ vNext_[stub.phiSec()*numEtaRegions + stub.etaRegion()]++ ] = linkFormat_->encode(stub);
+    }
+  }
+
+  TestVectorEventHeader eventHeader;
+  memset(&eventHeader, 0, sizeof(eventHeader));
+  eventHeader.run      = run;
+  eventHeader.lumi     = lumi;
+  eventHeader.event    = event;
+  eventHeader.nSectors = vSectors_.size();
+  eventHeader.nWords   = nWords;
+
+  out_.write(reinterpret_cast<const char*>(&eventHeader),    sizeof(eventHeader));
+  out_.write(reinterpret_cast<const char*>(vSectors_.data()), vSectors_.size()*sizeof(TestVectorSector));
+  out_.write(reinterpret_cast<const char*>(vWords_.data()),   vWords_.size()*sizeof(uint64_t));
+
+  if (! out_.good()) throw cms::Exception("DemoTestVectorWriter: Failed writing to file ")<<fileName_<<endl;
+
+  nEvents_++;
+}
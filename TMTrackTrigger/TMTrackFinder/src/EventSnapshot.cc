@@ -0,0 +1,228 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+  const char         snapshotMagic[8]   = {'T','M','T','T','S','N','A','P'};
+  const uint32_t     snapshotVersion    = 1;
+
+  // Number of padding bytes needed after an event's records to keep the next event header 8 byte aligned.
+  size_t padding(size_t nBytes) {return (8 - nBytes%8)%8;}
+
+  int32_t tpIndex(const TP* tp) {return (tp != nullptr)  ?  int32_t(tp->index())  :  snapshotNoTP;}
+}
+
+//=== Open snapshot file and write its header.
+
+EventSnapshotWriter::EventSnapshotWriter(const string& fileName, bool stubMatchStrict) :
+  fileName_(fileName),
+  out_(fileName.c_str(), ios::out | ios::binary | ios::trunc),
+  nEvents_(0)
+{
+  if (! out_.good()) throw cms::Exception("EventSnapshotWriter: Failed to open output file ")<<fileName_<<endl;
+
+  SnapshotFileHeader fileHeader;
+  memset(&fileHeader, 0, sizeof(fileHeader));
+  memcpy(fileHeader.magic, snapshotMagic, sizeof(snapshotMagic));
+  fileHeader.version         = snapshotVersion;
+  fileHeader.stubMatchStrict = stubMatchStrict;
+  fileHeader.sizeOfTP        = sizeof(SnapshotTP);
+  fileHeader.sizeOfStub      = sizeof(SnapshotStub);
+  out_.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+
+  vTPs_.reserve(2500);
+  vStubs_.reserve(35000);
+  vLinks_.reserve(50000);
+}
+
+EventSnapshotWriter::~EventSnapshotWriter() {
+  out_.close();
+  cout<<"EventSnapshotWriter: wrote "<<nEvents_<<" events to "<<fileName_<<endl;
+}
+
+//=== Append the stubs & tracking particles of one event to the file.
+//=== N.B. Must be called before the stubs are digitized, as the original stub coordinates are stored.
+
+void EventSnapshotWriter::write(uint32_t run, uint32_t lumi, uint64_t event, const InputData& inputData) {
+
+  const vector<TP>&   vTPs      = inputData.getTPs();
+  const vector<Stub>& vAllStubs = inputData.getAllStubs();
+
+  vTPs_.clear();
+  vStubs_.clear();
+  vLinks_.clear();
+
+  for (const TP& tp : vTPs) {
+    SnapshotTP rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.pdgId            = tp.pdgId();
+    rec.charge           = tp.charge();
+    rec.mass             = tp.mass();
+    rec.pt               = tp.pt();
+    rec.eta              = tp.eta();
+    rec.theta            = tp.theta();
+    rec.phi0             = tp.phi0();
+    rec.vx               = tp.vx();
+    rec.vy               = tp.vy();
+    rec.vz               = tp.vz();
+    rec.inTimeBx         = tp.inTimeBx();
+    rec.physicsCollision = tp.physicsCollision();
+    rec.useForEff        = tp.useForEff();
+    vTPs_.push_back(rec);
+  }
+
+  for (const Stub& s : vAllStubs) {
+    SnapshotStub rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.phi            = s.phi();
+    rec.r              = s.r();
+    rec.z              = s.z();
+    rec.bendInFrontend = s.bendInFrontend();
+    for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+      rec.localU_cluster[iClus]   = s.localU_cluster()[iClus];
+      rec.localV_cluster[iClus]   = s.localV_cluster()[iClus];
+      rec.assocTPofCluster[iClus] = tpIndex(s.assocTPofCluster()[iClus]);
+    }
+    rec.idDet          = s.idDet();
+    rec.moduleMinR     = s.minR();
+    rec.moduleMaxR     = s.maxR();
+    rec.moduleMinPhi   = s.minPhi();
+    rec.moduleMaxPhi   = s.maxPhi();
+    rec.moduleMinZ     = s.minZ();
+    rec.moduleMaxZ     = s.maxZ();
+    rec.stripPitch     = s.stripPitch();
+    rec.stripLength    = s.stripLength();
+    rec.sensorWidth    = s.sensorWidth();
+    rec.nStrips        = s.nStrips();
+    rec.layerId        = s.layerId();
+    rec.endcapRing     = s.endcapRing();
+    rec.psModule       = s.psModule();
+    rec.barrel         = s.barrel();
+    rec.assocTP        = tpIndex(s.assocTP());
+    rec.firstLink      = vLinks_.size();
+    for (const TP* tp : s.assocTPs()) vLinks_.push_back(tp->index());
+    rec.numLinks       = vLinks_.size() - rec.firstLink;
+    vStubs_.push_back(rec);
+  }
+
+  this->write(run, lumi, event, vTPs_, vStubs_, vLinks_);
+}
+
+//=== Append one event, whose records are already prepared, to the file.
+
+void EventSnapshotWriter::write(uint32_t run, uint32_t lumi, uint64_t event, const vector<SnapshotTP>& vTPs, const vector<SnapshotStub>& vStubs, const vector<uint32_t>& vLinks) {
+
+  SnapshotEventHeader eventHeader;
+  memset(&eventHeader, 0, sizeof(eventHeader));
+  eventHeader.run    = run;
+  eventHeader.lumi   = lumi;
+  eventHeader.event  = event;
+  eventHeader.nTPs   = vTPs.size();
+  eventHeader.nStubs = vStubs.size();
+  eventHeader.nLinks = vLinks.size();
+
+  const size_t nBytes = vTPs.size()*sizeof(SnapshotTP) + vStubs.size()*sizeof(SnapshotStub) + vLinks.size()*sizeof(uint32_t);
+  const char zeros[8] = {0};
+
+  out_.write(reinterpret_cast<const char*>(&eventHeader), sizeof(eventHeader));
+  out_.write(reinterpret_cast<const char*>(vTPs.data()),   vTPs.size()*sizeof(SnapshotTP));
+  out_.write(reinterpret_cast<const char*>(vStubs.data()), vStubs.size()*sizeof(SnapshotStub));
+  out_.write(reinterpret_cast<const char*>(vLinks.data()), vLinks.size()*sizeof(uint32_t));
+  out_.write(zeros, padding(nBytes));
+
+  if (! out_.good()) throw cms::Exception("EventSnapshotWriter: Failed writing to file ")<<fileName_<<endl;
+
+  nEvents_++;
+}
+
+//=== Open snapshot file, and memory map it.
+
+EventSnapshotReader::EventSnapshotReader(const string& fileName) :
+  fileName_(fileName),
+  fd_(-1),
+  data_(nullptr),
+  size_(0),
+  stubMatchStrict_(false)
+{
+  fd_ = open(fileName_.c_str(), O_RDONLY);
+  if (fd_ < 0) throw cms::Exception("EventSnapshotReader: Failed to open input file ")<<fileName_<<endl;
+
+  // The destructor isn't called if the constructor throws, so release the file & mapping here if it does.
+  try {
+    this->mapFile();
+  } catch (...) {
+    this->release();
+    throw;
+  }
+}
+
+//=== Memory map the opened snapshot file, check its header, and index its events.
+
+void EventSnapshotReader::mapFile() {
+
+  struct stat fileStat;
+  if (fstat(fd_, &fileStat) != 0) throw cms::Exception("EventSnapshotReader: Failed to stat input file ")<<fileName_<<endl;
+  size_ = fileStat.st_size;
+  if (size_ < sizeof(SnapshotFileHeader)) throw cms::Exception("EventSnapshotReader: File too short to be a snapshot ")<<fileName_<<endl;
+
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (addr == MAP_FAILED) throw cms::Exception("EventSnapshotReader: Failed to memory map input file ")<<fileName_<<endl;
+  data_ = static_cast<const char*>(addr);
+  // Events are read sequentially by the replay jobs.
+  madvise(addr, size_, MADV_SEQUENTIAL);
+
+  const SnapshotFileHeader* fileHeader = reinterpret_cast<const SnapshotFileHeader*>(data_);
+  if (memcmp(fileHeader->magic, snapshotMagic, sizeof(snapshotMagic)) != 0) throw cms::Exception("EventSnapshotReader: Not a snapshot file ")<<fileName_<<endl;
+  if (fileHeader->version != snapshotVersion || fileHeader->sizeOfTP != sizeof(SnapshotTP) || fileHeader->sizeOfStub != sizeof(SnapshotStub)) {
+    throw cms::Exception("EventSnapshotReader: Snapshot file written with incompatible software version ")<<fileName_<<" version="<<fileHeader->version<<" expected="<<snapshotVersion<<endl;
+  }
+  stubMatchStrict_ = fileHeader->stubMatchStrict;
+
+  // Index the events.
+  size_t pos = sizeof(SnapshotFileHeader);
+  while (pos < size_) {
+    if (pos + sizeof(SnapshotEventHeader) > size_) throw cms::Exception("EventSnapshotReader: Truncated event header in file ")<<fileName_<<endl;
+    SnapshotEvent ev;
+    ev.header = reinterpret_cast<const SnapshotEventHeader*>(data_ + pos);
+    pos += sizeof(SnapshotEventHeader);
+    const size_t nBytes = ev.header->nTPs*sizeof(SnapshotTP) + ev.header->nStubs*sizeof(SnapshotStub) + ev.header->nLinks*sizeof(uint32_t);
+    if (pos + nBytes > size_) throw cms::Exception("EventSnapshotReader: Truncated event in file ")<<fileName_<<" event="<<ev.header->event<<endl;
+    ev.tps   = reinterpret_cast<const SnapshotTP*>  (data_ + pos);
+    ev.stubs = reinterpret_cast<const SnapshotStub*>(data_ + pos + ev.header->nTPs*sizeof(SnapshotTP));
+    ev.links = reinterpret_cast<const uint32_t*>    (data_ + pos + ev.header->nTPs*sizeof(SnapshotTP) + ev.header->nStubs*sizeof(SnapshotStub));
+    pos += nBytes + padding(nBytes);
+    events_.push_back(ev);
+  }
+}
+
+EventSnapshotReader::~EventSnapshotReader() {
+  this->release();
+}
+
+//=== Unmap & close the file.
+
+void EventSnapshotReader::release() {
+  if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+  if (fd_ >= 0) close(fd_);
+  data_ = nullptr;
+  fd_   = -1;
+}
+
+//=== Access the records of a given event.
+
+const SnapshotEvent& EventSnapshotReader::event(unsigned int iEvent) const {
+  if (iEvent >= events_.size()) throw cms::Exception("EventSnapshotReader: Requested event beyond end of file ")<<fileName_<<" iEvent="<<iEvent<<" nEvents="<<events_.size()<<endl;
+  return events_[iEvent];
+}
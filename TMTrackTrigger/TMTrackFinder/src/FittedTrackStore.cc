@@ -0,0 +1,119 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+using namespace std;
+
+//=== Store configuration parameters.
+
+FittedTrackStore::FittedTrackStore(const Settings* settings) :
+  settings_(settings), inputData_(nullptr), fitterNames_(settings->trackFitters()),
+  sectorCandBegin_(0), candHint_(0)
+{
+  if (fitterNames_.size() > 255) throw cms::Exception("FittedTrackStore: too many track fitters: ")<<fitterNames_.size();
+}
+
+//=== Empty the store at the start of a new event. The vectors keep their capacity, so after the first few
+//=== events, filling the store needs no memory allocation.
+
+void FittedTrackStore::clear(const InputData& inputData) {
+  inputData_ = &inputData;
+  cands_.clear();
+  sectorCandBegin_ = 0;
+  candHint_        = 0;
+  stubPool_.clear();
+  qOverPt_.clear();
+  d0_.clear();
+  phi0_.clear();
+  z0_.clear();
+  tanLambda_.clear();
+  chi2_.clear();
+  stubOffset_.clear();
+  stubCount_.clear();
+  nMatchedStubs_.clear();
+  nKilledMatchedStubs_.clear();
+  cand_.clear();
+  matchedTP_.clear();
+  nLayers_.clear();
+  nHelixParam_.clear();
+  fitterId_.clear();
+  flags_.clear();
+  iPhiSec_.clear();
+  iEtaReg_.clear();
+}
+
+//=== Register the HT track candidates of a sector.
+
+void FittedTrackStore::beginSector(const vector<L1track3D>& cands) {
+  sectorCandBegin_ = cands_.size();
+  candHint_        = sectorCandBegin_;
+  for (const L1track3D& trk : cands) cands_.push_back(&trk);
+}
+
+//=== Store the fitted tracks produced by a fitter in the current sector.
+
+void FittedTrackStore::add(unsigned int fitterId, const vector<L1fittedTrack>& fitTrks) {
+
+  if (inputData_ == nullptr) throw cms::Exception("FittedTrackStore: add() called before clear()");
+  if (fitterId >= fitterNames_.size()) throw cms::Exception("FittedTrackStore: invalid fitter ID ")<<fitterId;
+
+  // The fitters produce tracks in the same order as the HT track candidates, so start the search
+  // for the parent candidate of the first track at the beginning of the sector.
+  candHint_ = sectorCandBegin_;
+
+  for (const L1fittedTrack& fitTrk : fitTrks) {
+    const vector<const Stub*>& stubs = fitTrk.getStubs();
+    const TP* tp = fitTrk.getMatchedTP();
+
+    stubOffset_.push_back(stubPool_.size());
+    stubCount_.push_back(stubs.size());
+    for (const Stub* s : stubs) stubPool_.push_back(s->index());
+
+    qOverPt_.push_back(fitTrk.qOverPt());
+    d0_.push_back(fitTrk.d0());
+    phi0_.push_back(fitTrk.phi0());
+    z0_.push_back(fitTrk.z0());
+    tanLambda_.push_back(fitTrk.tanLambda());
+    chi2_.push_back(fitTrk.chi2());
+    nMatchedStubs_.push_back(fitTrk.getNumMatchedStubs());
+    nKilledMatchedStubs_.push_back(fitTrk.getNumKilledMatchedStubs());
+    cand_.push_back(this->findCandidate(fitTrk));
+    matchedTP_.push_back(tp != nullptr  ?  int32_t(tp->index())  :  -1);
+    nLayers_.push_back(fitTrk.getNumLayers());
+    nHelixParam_.push_back(fitTrk.nHelixParam());
+    fitterId_.push_back(fitterId);
+    flags_.push_back(fitTrk.accepted()  ?  Accepted  :  0);
+    iPhiSec_.push_back(fitTrk.iPhiSec());
+    iEtaReg_.push_back(fitTrk.iEtaReg());
+  }
+}
+
+//=== Get truth particle matched to i-th track (=nullptr if none).
+
+const TP* FittedTrackStore::matchedTP(unsigned int i) const {
+  return (matchedTP_[i] >= 0)  ?  &(inputData_->getTPs()[matchedTP_[i]])  :  nullptr;
+}
+
+//=== Find index in cands_ of the HT track candidate from which fitted track was produced.
+//=== The fitted track holds a copy of it, so it is identified by its HT cell & stubs.
+//=== The search starts just after the candidate found for the previous track, so is usually immediate.
+
+unsigned int FittedTrackStore::findCandidate(const L1fittedTrack& fitTrk) {
+  const L1track3D& htTrk = fitTrk.getL1track3D();
+  const unsigned int nCands = cands_.size() - sectorCandBegin_;
+  for (unsigned int j = 0; j < nCands; j++) {
+    const unsigned int iCand = sectorCandBegin_ + (candHint_ - sectorCandBegin_ + j) % nCands;
+    const L1track3D* cand = cands_[iCand];
+    if (cand->getCellLocationRphi() == htTrk.getCellLocationRphi() &&
+        cand->getCellLocationRz()   == htTrk.getCellLocationRz()   &&
+        cand->getStubs()            == htTrk.getStubs()) {
+      candHint_ = sectorCandBegin_ + (iCand + 1 - sectorCandBegin_) % nCands;
+      return iCand;
+    }
+  }
+  throw cms::Exception("FittedTrackStore: fitted track does not come from any track candidate in sector ")<<fitTrk.iPhiSec()<<" "<<fitTrk.iEtaReg();
+}
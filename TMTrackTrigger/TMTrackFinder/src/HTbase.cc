@@ -16,7 +16,7 @@ void HTbase::end() {
   // Calculate useful info about each cell in array.
   for (unsigned int i = 0; i < htArray_.size1(); i++) {
     for (unsigned int j = 0; j < htArray_.size2(); j++) {
-      htArray_(i,j).end(); // Calls HTcell::end()
+      htArray_(i,j).end(stubTable_, stubSubSecs_); // Calls HTcell::end()
     }
   }
 
@@ -34,6 +34,19 @@ void HTbase::end() {
   }
 }
 
+//=== Add stub to the table of stubs stored in this HT array, returning its index in the table.
+
+unsigned int HTbase::addStubToTable(const Stub* stub, const vector<bool>& inSubSecs) {
+  if (inSubSecs.size() > 8*sizeof(unsigned int)) throw cms::Exception("HTbase: Too many subsectors ")<<inSubSecs.size();
+  unsigned int subSecs = 0;
+  for (unsigned int i = 0; i < inSubSecs.size(); i++) {
+    if (inSubSecs[i]) subSecs |= (1u << i);
+  }
+  stubTable_.push_back(stub);
+  stubSubSecs_.push_back(subSecs);
+  return stubTable_.size() - 1;
+}
+
 //=== Number of filtered stubs in each cell summed over all cells in HT array.
 //=== If a stub appears in multiple cells, it will be counted multiple times.
 unsigned int HTbase::numStubsInc() const {
@@ -49,21 +49,25 @@ void HTcell::init(const Settings* settings, bool isRphiHT, float etaMinSector, f
 
 //=== Termination. Search for track in this HT cell etc.
 
-void HTcell::end(){
+void HTcell::end(const std::vector<const Stub*>& stubTable, const std::vector<unsigned int>& stubSubSecs){
   // Produce list of filtered stubs by applying all requested filters (e.g. on stub bend).
   // (If no filters are requested, then filtered & unfiltered stub collections will be identical).
 
   // N.B. Other filters,  such as the r-z filters, which the firmware runs after the HT because they are too slow within it,
   // are not defined here, but instead inside class TrkFilterAfterRphiHT.
 
-  vFilteredStubs_ = vStubs_;
+  std::vector<unsigned int> filteredStubs = vStubs_;
   // The bend filter is only relevant to r-phi Hough transform.
   if (isRphiHT_) {
-    if (useBendFilter_) vFilteredStubs_ = this->bendFilter(vFilteredStubs_);
+    if (useBendFilter_) filteredStubs = this->bendFilter(filteredStubs, stubTable);
   }
   // Prevent too many stubs being stored in a single HT cell if requested (to reflect hardware memory limits).
   // N.B. This MUST be the last filter applied.
-  if (maxStubsInCell_ <= 99) vFilteredStubs_ = this->maxStubCountFilter(vFilteredStubs_);
+  if (maxStubsInCell_ <= 99) filteredStubs = this->maxStubCountFilter(filteredStubs);
+
+  vFilteredStubs_.clear();
+  vFilteredStubs_.reserve(filteredStubs.size());
+  for (unsigned int iStub : filteredStubs) vFilteredStubs_.push_back(stubTable[iStub]);
 
   // Calculate the number of layers the filtered stubs in this cell are in.
   numFilteredLayersInCell_ = this->calcNumFilteredLayers();
@@ -74,7 +78,7 @@ void HTcell::end(){
     // Look for the "best" subsector.
     numFilteredLayersInCellBestSubSec_ = 0;
     for (unsigned int i = 0; i < numSubSecs_; i++) {
-      unsigned int numLaySubSec = this->calcNumFilteredLayers(i);
+      unsigned int numLaySubSec = this->calcNumFilteredLayers(i, filteredStubs, stubTable, stubSubSecs);
       numFilteredLayersInCellBestSubSec_ = std::max(numFilteredLayersInCellBestSubSec_, numLaySubSec);
     }
   } else {
@@ -86,11 +90,12 @@ void HTcell::end(){
 // Calculate how many tracker layers the filter stubs in this cell are in, when only the subset of those stubs
 // that are in the specified subsector are counted.
 
-unsigned int HTcell::calcNumFilteredLayers(unsigned int iSubSec) const {
+unsigned int HTcell::calcNumFilteredLayers(unsigned int iSubSec, const std::vector<unsigned int>& filteredStubs, 
+                                           const std::vector<const Stub*>& stubTable, const std::vector<unsigned int>& stubSubSecs) const {
   std::vector<const Stub*> stubsInSubSec;
-  for (const Stub* s : vFilteredStubs_) {
-    const std::vector<bool>& inSubSec = subSectors_.at(s); // Find out which subsectors this stub is in.
-    if (inSubSec[iSubSec]) stubsInSubSec.push_back(s);
+  for (unsigned int iStub : filteredStubs) {
+    // Find out which subsectors this stub is in.
+    if ((stubSubSecs[iStub] >> iSubSec) & 1) stubsInSubSec.push_back(stubTable[iStub]);
   }
   return Utility::countLayers( settings_, stubsInSubSec );
 }
@@ -99,26 +104,27 @@ unsigned int HTcell::calcNumFilteredLayers(unsigned int iSubSec) const {
 //=== Produce a filtered collection of stubs in this cell that all have consistent bend.
 //=== Only called for r-phi Hough transform.
 
-std::vector<const Stub*> HTcell::bendFilter( const std::vector<const Stub*>& stubs ) const
+std::vector<unsigned int> HTcell::bendFilter( const std::vector<unsigned int>& stubs, const std::vector<const Stub*>& stubTable ) const
 {
 	using namespace std;
 	
   // Create bend-filtered stub collection.
-  vector<const Stub*> filteredStubs;
-  for (const Stub* s : stubs) {
+  vector<unsigned int> filteredStubs;
+  for (unsigned int iStub : stubs) {
+    const Stub* s = stubTable[iStub];
 
     // Require stub bend to be consistent with q/Pt of this cell.
 
     if (daisyChainFirmware_) {
       // Daisy chain firmware doesn't have access to variables needed to calculate dphi of stub,
       // but instead knows integer range of q/Pt bins that stub bend is compatible with, so use these.
-      if (s->min_qOverPt_bin() <= ibin_qOverPt_ && ibin_qOverPt_ <= s->max_qOverPt_bin() )  filteredStubs.push_back(s);
+      if (s->min_qOverPt_bin() <= ibin_qOverPt_ && ibin_qOverPt_ <= s->max_qOverPt_bin() )  filteredStubs.push_back(iStub);
     } else {
       // Systolic array & 2-c-bin firmware do hace access to stub dphi, so can use it.
       // Predict track bend angle based on q/Pt of this HT cell and radius of stub.
       float predictedDphi = this->dphi( s->r() );
       // Require reconstructed and predicted values of this quantity to be consistent within estimated resolution. 
-      if (fabs(s->dphi() - predictedDphi) < s->dphiRes()) filteredStubs.push_back(s);
+      if (fabs(s->dphi() - predictedDphi) < s->dphiRes()) filteredStubs.push_back(iStub);
     }
   }
   return filteredStubs;
@@ -127,11 +133,11 @@ std::vector<const Stub*> HTcell::bendFilter( const std::vector<const Stub*>& stu
 //=== Filter stubs so as to prevent more than specified number of stubs being stored in one cell.
 //=== This reflects finite memory of hardware.
 
-std::vector<const Stub*> HTcell::maxStubCountFilter( const std::vector<const Stub*>& stubs ) const
+std::vector<unsigned int> HTcell::maxStubCountFilter( const std::vector<unsigned int>& stubs ) const
 {
 	using namespace std;
 	
-  vector<const Stub*> filteredStubs;
+  vector<unsigned int> filteredStubs;
   unsigned int numStubsToDelete = (stubs.size() > maxStubsInCell_)  ?  stubs.size() - maxStubsInCell_  :  0;
   // If there are too many stubs in a cell, the hardware throws away the first ones and keeps the last ones. 
   for (unsigned int i = numStubsToDelete; i < stubs.size(); i++) {
@@ -2,6 +2,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/HTrz.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track2D.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/StageTimers.h"
 
 #include <iostream>
 #include <unordered_set>
@@ -28,6 +29,8 @@ void HTpair::init(const Settings* settings, float etaMinSector, float etaMaxSect
   //--- Option for duplicate track removal on collection of L1track3D produced after running all track-finding steps.
   unsigned int dupTrkAlgRzSeg = settings->dupTrkAlgRzSeg();
   killDupTrks_.init(settings, dupTrkAlgRzSeg);
+
+  stageTimers_ = nullptr;
 }
 
 //=== Add stub to r-phi HT array.
@@ -64,7 +67,11 @@ vector<L1track3D> HTpair::make3Dtracks() {
   // Run requested track filters (e.g. r-z filters) to clean up the tracks by removing inconsistent stubs, and killing
   // some tracks altogether if this procedure leaves them with too few stubs.
   // The r-z filters may also add a good estimate of the r-z helix parameters to each track.
-  const vector<L1track2D>& vecTracksRphiFilt = rzFilters_.filterTracks(vecTracksRphi);
+  vector<L1track2D> vecTracksRphiFilt;
+  {
+    StageTimers::Scope timer(stageTimers_, StageTimers::RZfilters);
+    vecTracksRphiFilt = rzFilters_.filterTracks(vecTracksRphi);
+  }
 
   // Loop over track candidates found by r-phi HT.
 
@@ -90,7 +97,7 @@ vector<L1track3D> HTpair::make3Dtracks() {
 
 	// Create 3D track (N.B. Set stubs equal to those on r-z track, which are filtered with respect to those on the r-phi track by the r-z HT).
 	// The L1track3D class automatically finds the associated truth Tracking Particle (if any).
-	L1track3D trk3D(settings_, trkRz.getStubs(), 
+	L1track3D trk3D(settings_, trkRz.getStubList(), 
 			trkRphi.getCellLocation(), trkRphi.getHelix2D(),
 			trkRz.getCellLocation()  , trkRz.getHelix2D());
         // Add to list of stored 3D tracks.
@@ -124,7 +131,7 @@ vector<L1track3D> HTpair::make3Dtracks() {
 
       // Create 3D track (N.B. Set stubs equal to those on r-phi track, since no r-z HT was run to filter them).
       // The L1track3D class automatically finds the associated truth Tracking Particle (if any).
-      L1track3D trk3D(settings_, stubsOnTrkRphi, 
+      L1track3D trk3D(settings_, trkRphi.getStubList(), 
 		      trkRphi.getCellLocation(), trkRphi.getHelix2D(),
 		      cellRz                   , helixRz);
       // Add to list of stored 3D tracks.
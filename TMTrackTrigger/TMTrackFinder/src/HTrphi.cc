@@ -28,7 +28,7 @@ unsigned int HTrphi::numErrorsNormalisation_ = 0;
 
 //=== Initialise
  
-void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector) {
+void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSector, float phiCentreSector, bool bookArray) {
   HTbase::settings_    = settings;
   invPtToDphi_         = settings->invPtToDphi();
 
@@ -91,6 +91,9 @@ void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSect
   HTbase::killDupTrks_.init(settings, dupTrkAlgRphi);
 
   // Resize HT array to suit these specifications, and initialise each cell with configuration parameters.
+  HTbase::stubTable_.clear();
+  HTbase::stubSubSecs_.clear();
+  if (! bookArray) return;
   HTbase::htArray_.resize(nBinsQoverPtAxis_, nBinsPhiTrkAxis_, false);
 
   const bool isRphiHT = true;
@@ -115,6 +118,11 @@ void HTrphi::init(const Settings* settings, float etaMinSector, float etaMaxSect
 
 void HTrphi::store(const Stub* stub, const vector<bool>& inEtaSubSecs) {
 
+  if (inEtaSubSecs.size() != settings_->numSubSecsEta()) throw cms::Exception("HTrphi: Wrong number of subsectors!");
+
+  // The cells only store the index of the stub in the stub table.
+  const unsigned int iStub = this->addStubToTable(stub, inEtaSubSecs);
+
   // Loop over q/Pt related bins in HT array.
   for (unsigned int i = 0; i < nBinsQoverPtAxis_; i++) {
 
@@ -140,11 +148,11 @@ void HTrphi::store(const Stub* stub, const vector<bool>& inEtaSubSecs) {
 	  if (i%2 == 1) iStore = i - 1;
 	  if (j%2 == 1) jStore = j - 1;
 	  // If this stub was already stored in this merged 2x2 cell, then don't store it again.
-	  if (HTbase::htArray_(iStore, jStore).stubStoredInCell( stub )) canStoreStub = false;
+	  if (HTbase::htArray_(iStore, jStore).stubStoredInCell( iStub )) canStoreStub = false;
 	}
       }
 
-      if (canStoreStub) HTbase::htArray_(iStore, jStore).store( stub, inEtaSubSecs ); // Calls HTcell::store()
+      if (canStoreStub) HTbase::htArray_(iStore, jStore).store( iStub ); // Calls HTcell::store()
     }
 
     // Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
@@ -81,6 +81,8 @@ void HTrz::init(const Settings* settings, float etaMinSector, float etaMaxSector
   HTbase::killDupTrks_.init(settings, dupTrkAlgRz);
 
   // Resize HT array to suit these specifications, and initialise each cell with configuration parameters.
+  HTbase::stubTable_.clear();
+  HTbase::stubSubSecs_.clear();
   HTbase::htArray_.resize(nBinsZ0Axis_, nBinsZtrkAxis_, false);
 
   const bool isRphiHT = false;
@@ -102,6 +104,8 @@ void HTrz::init(const Settings* settings, float etaMinSector, float etaMaxSector
 
 void HTrz::store( const Stub* stub) {
 
+  // The cells only store the index of the stub in the stub table.
+  const unsigned int iStub = this->addStubToTable(stub);
 
   // Loop over z0 related bins in HT array.
   for (unsigned int i = 0; i < nBinsZ0Axis_; i++) {
@@ -113,7 +117,7 @@ void HTrz::store( const Stub* stub) {
 
     // Store stubs in these cells.
     for (unsigned int j = iZtrkBinMin; j <= iZtrkBinMax; j++) {  
-      HTbase::htArray_(i, j).store( stub ); // Calls HTcell::store()
+      HTbase::htArray_(i, j).store( iStub ); // Calls HTcell::store()
     }
 
     // Check that limitations of firmware would not prevent stub being stored correctly in this HT column.
@@ -0,0 +1,25 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/HistoSet.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <TH1.h>
+
+using namespace std;
+
+//=== Create directory in which to book histograms.
+
+HistoSet::Dir HistoSet::mkdir(const string& name) {
+  TFileDirectory* tDir = shard_  ?  nullptr  :  new TFileDirectory( fs_->mkdir(name) );
+  return Dir(this, tDir);
+}
+
+//=== Add the contents of the histograms of a shard to the corresponding ones of this set.
+
+void HistoSet::merge(const HistoSet& shard) {
+  if (! shard.shard_ || shard.hists_.size() != hists_.size()) throw cms::Exception("HistoSet: Can't merge histograms from an incompatible set: ")<<shard.hists_.size()<<" "<<hists_.size()<<endl;
+
+  for (unsigned int i = 0; i < hists_.size(); i++) {
+    if (string(hists_[i]->GetName()) != shard.hists_[i]->GetName()) throw cms::Exception("HistoSet: Histogram booked in different order in shard: ")<<hists_[i]->GetName()<<" "<<shard.hists_[i]->GetName()<<endl;
+    hists_[i]->Add( shard.hists_[i] );
+  }
+}
@@ -1,11 +1,14 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Histos.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/SectorMembership.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/HTrphi.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/HTrz.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TrkRZfilter.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TPassocIndex.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrk4and5.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
 
@@ -25,29 +28,101 @@
 
 using namespace std;
 
-//=== Book all histogram
+namespace {
+  // Names of the families of histograms, as used by cfg param HistosDisabled.
+  const char* familyNames[Histos::NumFamilies] = {"InputData", "EtaPhiSectors", "RphiHT", "RZfilters", "StudyBusyEvents", "TrackCands", "TrackFitting"};
+}
+
+//=== Store cfg parameters, and note which families of histograms are enabled.
+
+Histos::Histos(const Settings* settings, bool shard) : settings_(settings), histoSet_(shard), numPerfRecoTPforAlg_(0) {
+  for (unsigned int i = 0; i < NumFamilies; i++) {
+    enabled_[i] = true;
+    booked_[i]  = false;
+  }
+
+  for (const string& name : settings_->histosDisabled()) {
+    const char** family = std::find(familyNames, familyNames + NumFamilies, name);
+    if (family == familyNames + NumFamilies) throw cms::Exception("Histos: Unknown histogram family in cfg param HistosDisabled: ")<<name<<endl;
+    enabled_[family - familyNames] = false;
+  }
+}
+
+//=== Book all enabled histograms now, rather than when they are first filled.
 
 void Histos::book() {
-  TH1::SetDefaultSumw2(true);
-
-  // Book histograms about various topics.
-  this->bookInputData();
-  // Book histograms checking if (eta,phi) sector definition choices are good.
-  this->bookEtaPhiSectors();
-  // Book histograms checking filling of r-phi HT array.
-  this->bookRphiHT();
-  // Book histograms about r-z track filters (or other filters applied after r-phi HT array).
-  this->bookRZfilters();
-  // Book histograms studying track candidates found by Hough Transform.
-  this->bookTrackCands();
-  // Book histograms studying track fitting performance
-  this->bookTrackFitting();
+  // The r-z filter histograms are only wanted if one of the r-z filters is in use.
+  const bool useRZfilters = (settings_->useZTrkFilter() || settings_->useSeedFilter());
+  for (unsigned int i = 0; i < NumFamilies; i++) {
+    if (Family(i) == RZfilterHists && ! useRZfilters) continue;
+    this->use( Family(i) );
+  }
+}
+
+//=== If given family of histograms is enabled, book it if not yet done, and return true.
+
+bool Histos::use(Family family) {
+  if (! enabled_[family]) return false;
+
+  if (! booked_[family]) {
+    TH1::SetDefaultSumw2(true);
+
+    switch (family) {
+      // Book histograms using input stubs and tracking particles.
+      case InputDataHists     : this->bookInputData();       break;
+      // Book histograms checking if (eta,phi) sector definition choices are good.
+      case EtaPhiSectorHists  : this->bookEtaPhiSectors();   break;
+      // Book histograms checking filling of r-phi HT array.
+      case RphiHTHists        : this->bookRphiHT();          break;
+      // Book histograms about r-z track filters (or other filters applied after r-phi HT array).
+      case RZfilterHists      : this->bookRZfilters();       break;
+      // Book histograms for studying freak, extra large events.
+      case BusyEventHists     : this->bookStudyBusyEvents(); break;
+      // Book histograms studying track candidates found by Hough Transform.
+      case TrackCandHists     : this->bookTrackCands();      break;
+      // Book histograms studying track fitting performance
+      case TrackFitHists      : this->bookTrackFitting();    break;
+      default : throw cms::Exception("Histos: Unknown histogram family ")<<family<<endl;
+    }
+    booked_[family] = true;
+  }
+  return true;
+}
+
+//=== Create & book a private copy ("shard") of all the histograms, which another thread can fill at the same time as this one.
+
+Histos* Histos::bookShard() const {
+  Histos* shard = new Histos(settings_, true);
+  shard->book();
+  return shard;
+}
+
+//=== Add the contents of a shard to these histograms, together with the counters used by endJobAnalysis().
+
+void Histos::mergeShard(const Histos& shard) {
+  histoSet_.merge(shard.histoSet_);
+
+  numPerfRecoTPforAlg_ += shard.numPerfRecoTPforAlg_;
+
+#ifndef HISTOS_OPTIMIZE_
+  for (const auto& n : shard.numFitAlgEff_)         numFitAlgEff_        [n.first] += n.second;
+  for (const auto& n : shard.numFitPerfAlgEff_)     numFitPerfAlgEff_    [n.first] += n.second;
+  for (const auto& n : shard.numFitAlgEffPass_)     numFitAlgEffPass_    [n.first] += n.second;
+  for (const auto& n : shard.numFitPerfAlgEffPass_) numFitPerfAlgEffPass_[n.first] += n.second;
+#else
+  for (std::size_t i = 0; i < fitterNameToFitterIndexMap_.size(); i++) {
+    numFitAlgEff_        [i] += shard.numFitAlgEff_        [i];
+    numFitPerfAlgEff_    [i] += shard.numFitPerfAlgEff_    [i];
+    numFitAlgEffPass_    [i] += shard.numFitAlgEffPass_    [i];
+    numFitPerfAlgEffPass_[i] += shard.numFitPerfAlgEffPass_[i];
+  }
+#endif
 }
 
 //=== Book histograms using input stubs and tracking particles.
 
 void Histos::bookInputData() {
-  TFileDirectory inputDir = fs_->mkdir("InputData");
+  HistoSet::Dir inputDir = histoSet_.mkdir("InputData");
 
   // N.B. Histograms of the kinematics and production vertex of tracking particles
   // are booked in bookTrackCands(), since they are used to study the tracking efficiency.
@@ -111,7 +186,7 @@ void Histos::bookInputData() {
 //=== Book histograms checking if (eta,phi) sector definition choices are good.
 
 void Histos::bookEtaPhiSectors() {
-  TFileDirectory inputDir = fs_->mkdir("CheckSectors");
+  HistoSet::Dir inputDir = histoSet_.mkdir("CheckSectors");
 
   // Check if TP lose stubs because not all in same sector.
 
@@ -140,7 +215,7 @@ void Histos::bookEtaPhiSectors() {
 
 void Histos::bookRphiHT() {
 
-  TFileDirectory inputDir = fs_->mkdir("HTrphi");
+  HistoSet::Dir inputDir = histoSet_.mkdir("HTrphi");
 
   hisIncStubsPerHT_ = inputDir.make<TH1F>("IncStubsPerHT","; Number of filtered stubs per r#phi HT array (inc. duplicates)",100,0.,-1.);
   hisExcStubsPerHT_ = inputDir.make<TH1F>("ExcStubsPerHT","; Number of filtered stubs per r#phi HT array (exc. duplicates)",250,-0.5,249.5);
@@ -157,7 +232,7 @@ void Histos::bookRZfilters() {
   // Only book histograms if one of the r-z filters was in use.
   if (settings_->useZTrkFilter() || settings_->useSeedFilter()) {
 
-    TFileDirectory inputDir = fs_->mkdir("RZfilters");
+    HistoSet::Dir inputDir = histoSet_.mkdir("RZfilters");
 
     // Check number of track seeds that r-z filters must check.
 
@@ -183,12 +258,7 @@ void Histos::bookRZfilters() {
 
 void Histos::bookTrackCands() {
 
-  // Book histograms for studying freak, extra large events.
-  this->bookStudyBusyEvents();
-
-  // Now book histograms for studying tracking in general.
-
-  TFileDirectory inputDir = fs_->mkdir("TrackCands");
+  HistoSet::Dir inputDir = histoSet_.mkdir("TrackCands");
 
   // Count tracks in various ways (including/excluding duplicates, excluding fakes ...)
   profNumTrackCands_  = inputDir.make<TProfile>("NumTrackCands","; class; N. of tracks in tracker",7,0.5,7.5);
@@ -293,7 +363,7 @@ void Histos::bookTrackCands() {
 
 void Histos::bookStudyBusyEvents() {
 
-  TFileDirectory inputDir = fs_->mkdir("BusyEvents");
+  HistoSet::Dir inputDir = histoSet_.mkdir("BusyEvents");
 
   // Look at (eta, phi) sectors with too many input stubs or too many output (= assigned to tracks) stubs.
 
@@ -377,7 +447,7 @@ void Histos::bookTrackFitting()
 	for(auto &fitName : settings_->trackFitters() )
 	{
 		std::cout << "Booking histograms for " << fitName << std::endl;
-		TFileDirectory inputDir = fs_->mkdir( (fitName)  );
+		HistoSet::Dir inputDir = histoSet_.mkdir( (fitName)  );
 
 		hisSeedQinvPt_[fitName] = inputDir.make<TH1F>(("SeedQinvPt_"+(fitName)).c_str(), "; seed q/p_{T}" , 100, -0.5, 0.5 );
 		hisSeedPhi0_  [fitName] = inputDir.make<TH1F>(("SeedPhi0_"+(fitName)).c_str(), "; seed #phi_{0}", 70, -3.5, 3.5 );
@@ -530,7 +600,7 @@ void Histos::bookTrackFitting()
 		fitterNameToFitterIndexMap_[fitName] = fitterIndex;
 		
 		
-		TFileDirectory inputDir = fs_->mkdir( (fitName) );
+		HistoSet::Dir inputDir = histoSet_.mkdir( (fitName) );
 
 		hisSeedQinvPt_[fitterIndex] = inputDir.make<TH1F>(("SeedQinvPt_"+(fitName)).c_str(), "; seed q/p_{T}" , 100, -0.5, 0.5 );
 		hisSeedPhi0_  [fitterIndex] = inputDir.make<TH1F>(("SeedPhi0_"+(fitName)).c_str(), "; seed #phi_{0}", 70, -3.5, 3.5 );
@@ -673,6 +743,8 @@ void Histos::bookTrackFitting()
 //=== Fill histograms using input stubs and tracking particles.
 
 void Histos::fillInputData(const InputData& inputData) {
+  if (! this->use(InputDataHists)) return;
+
   const vector<const Stub*>& vStubs = inputData.getStubs();
   const vector<TP>&          vTPs   = inputData.getTPs();
 
@@ -820,8 +892,10 @@ void Histos::fillInputData(const InputData& inputData) {
 
 //=== Fill histograms checking if (eta,phi) sector definition choices are good.
 
-void Histos::fillEtaPhiSectors(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors)
+void Histos::fillEtaPhiSectors(const InputData& inputData, const SectorMembership& sectorMembership)
 {
+  if (! this->use(EtaPhiSectorHists)) return;
+
   const vector<const Stub*>& vStubs = inputData.getStubs();
   const vector<TP>&          vTPs   = inputData.getTPs();
 
@@ -841,12 +915,10 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const boost::numeric:
       for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
 	for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
 
-	  const Sector& sector = mSectors(iPhiSec, iEtaReg);
-
           // Count number of stubs in given tracking particle which are inside this (phi,eta) sector;
           // or inside it if only the eta cuts are applied; or inside it if only the phi cuts are applied.
 	  unsigned int nStubsInSec, nStubsInEtaSec, nStubsInPhiSec;
-          sector.numStubsInside( tp, nStubsInSec, nStubsInEtaSec, nStubsInPhiSec);
+          sectorMembership.numStubsInside( iPhiSec, iEtaReg, tp, nStubsInSec, nStubsInEtaSec, nStubsInPhiSec);
 
 	  // Note best results obtained in any sector.
           nStubsInBestSec    = max( nStubsInBestSec,    nStubsInSec);
@@ -867,32 +939,21 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const boost::numeric:
   for (const Stub* stub : vStubs) {
 
     // Number of (eta,phi), phi & eta sectors containing this stub.
-    unsigned int nSecs = 0; 
-    unsigned int nEtaSecs = 0; 
-    unsigned int nPhiSecs = 0; 
+    // (Since a stub is in an (eta,phi) sector if it is in both its eta region & phi sector, the first is the product of the other two).
+    unsigned int nEtaSecs = sectorMembership.numEtaRegions(stub);
+    unsigned int nPhiSecs = sectorMembership.numPhiSectors(stub);
+    unsigned int nSecs    = nEtaSecs * nPhiSecs;
 
-    // Loop over (eta, phi) sectors.
-    for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-      for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
-
-	const Sector& sector = mSectors(iPhiSec, iEtaReg);
-
-	// Check if sector contains stub stub, and if so count it.
-	// Take care to just use one eta (phi) typical region when counting phi (eta) sectors.
-	if ( sector.inside   ( stub ) )                 nSecs++;
-	if ( iPhiSec == 0 && sector.insideEta( stub ) ) nEtaSecs++;
-	if ( iEtaReg == 0 && sector.insidePhi( stub ) ) nPhiSecs++;
-
-	// Also note which tracker layers are present in each eta sector.
-	if (iPhiSec == 0 && sector.insideEta( stub)) {
-	  const TP* assocTP = stub->assocTP();
-	  if (assocTP != nullptr) {
-	    if (assocTP->useForAlgEff()) {
-	      unsigned int lay = stub->layerId();
-	      if (lay > 20) lay -= 10; // Don't bother distinguishing two endcaps.
-	      hisLayerIDvsEtaSec_->Fill(iEtaReg, lay);
-	      hisLayerIDreducedvsEtaSec_->Fill(iEtaReg, stub->layerIdReduced()); // Plot also simplified layerID for hardware, which tries to avoid more than 8 ID in any given eta region.
-	    }
+    // Also note which tracker layers are present in each eta sector.
+    for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
+      if (sectorMembership.insideEta(iEtaReg, stub)) {
+	const TP* assocTP = stub->assocTP();
+	if (assocTP != nullptr) {
+	  if (assocTP->useForAlgEff()) {
+	    unsigned int lay = stub->layerId();
+	    if (lay > 20) lay -= 10; // Don't bother distinguishing two endcaps.
+	    hisLayerIDvsEtaSec_->Fill(iEtaReg, lay);
+	    hisLayerIDreducedvsEtaSec_->Fill(iEtaReg, stub->layerIdReduced()); // Plot also simplified layerID for hardware, which tries to avoid more than 8 ID in any given eta region.
 	  }
 	}
       }
@@ -909,12 +970,7 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const boost::numeric:
   for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
     unsigned int nStubsInEtaSec = 0; // Also counts stubs in eta sector, summed over all phi.
     for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-      const Sector& sector = mSectors(iPhiSec, iEtaReg);
-
-      unsigned int nStubs = 0;
-      for (const Stub* stub : vStubs) {
-	if ( sector.inside( stub ) )  nStubs++;
-      }
+      unsigned int nStubs = sectorMembership.stubsInSector(iPhiSec, iEtaReg).size();
       hisNumStubsPerSec_->Fill(nStubs);
       nStubsInEtaSec += nStubs;
     }
@@ -927,6 +983,8 @@ void Histos::fillEtaPhiSectors(const InputData& inputData, const boost::numeric:
 void Histos::fillRphiHT(const boost::numeric::ublas::matrix<HTpair>& mHtPairs) {
 
 	using namespace boost::numeric::ublas;
+
+  if (! this->use(RphiHTHists)) return;
 	
   //--- Loop over (eta,phi) sectors, counting the number of stubs in the HT array of each.
  
@@ -986,8 +1044,8 @@ void Histos::fillRZfilters(const boost::numeric::ublas::matrix<HTpair>& mHtPairs
 
 	using namespace boost::numeric::ublas;
 	
-  // Only fill histograms if one of the r-z filters was in use.
-  if (settings_->useZTrkFilter() || settings_->useSeedFilter()) {
+  // Only fill histograms if one of the r-z filters was in use. (So they are only booked in this case).
+  if ((settings_->useZTrkFilter() || settings_->useSeedFilter()) && this->use(RZfilterHists)) {
 
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
       for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
@@ -1060,14 +1118,18 @@ void Histos::fillRZfilters(const boost::numeric::ublas::matrix<HTpair>& mHtPairs
 void Histos::fillTrackCands(
 	const InputData& inputData,
 	const boost::numeric::ublas::matrix<Sector>& mSectors,
-	const boost::numeric::ublas::matrix<HTpair>& mHtPairs)
+	const SectorMembership& sectorMembership,
+	const boost::numeric::ublas::matrix<HTpair>& mHtPairs,
+	const TPassocIndex& tpAssoc)
 {
 
   // Fill histograms for studying freak, extra large events.
-  this->fillStudyBusyEvents(inputData, mSectors, mHtPairs);
+  this->fillStudyBusyEvents(inputData, sectorMembership, mHtPairs);
 
   // Now fill histograms for studying tracking in general.
 
+  if (! this->use(TrackCandHists)) return;
+
   const std::vector<TP>&  vTPs = inputData.getTPs();
 
   //=== Count track candidates found in the tracker. 
@@ -1173,8 +1235,7 @@ void Histos::fillTrackCands(
             const vector<const Stub*> stubs = trk.getStubs();
             for (const Stub* s : stubs) {
 	      // Was this stub produced by correct truth particle?
-	      const set<const TP*> stubTPs = s->assocTPs();
-	      bool trueStub = (stubTPs.find(tp) != stubTPs.end());
+	      bool trueStub = s->assocTPs().contains(tp);
 
   	      // Distance of stub from true trajectory in z (barrel) or r (endcap)
 	      float deltaRorZ =  s->barrel()  ?  (s->z() - tp->trkZAtStub( s ))  :  (s->r() - tp->trkRAtStub( s ));
@@ -1270,30 +1331,36 @@ void Histos::fillTrackCands(
   unsigned int nTrksMatchingTPs = 0; // Total no. of tracks that all TPs were reconstructed as
   unsigned int nTrksMatchingTPsIgnoringRzDups = 0; // Ditto, but if TP reconstructed in multiple cells of r-z HT, just count them as 1. 
 
+  std::vector<bool> tpRecoedInEtaSec;
+  std::vector<const L1track3D*> trks;
+
   for (const TP& tp: vTPs) {
 
-    bool tpRecoed = false;
+    // Get reconstructed tracks corresponding to this TP. (Those in the same sector are adjacent).
+    const TPassocIndex::Range<TPassocIndex::Cand> cands = tpAssoc.assocTrackCands3D( tp );
+    bool tpRecoed = ! cands.empty(); // This TP was reconstructed at least once in tracker.
+
+    tpRecoedInEtaSec.assign(settings_->numEtaRegions(), false);
+    for (const TPassocIndex::Cand* cand = cands.begin(); cand != cands.end(); ) {
+      // Get reconstructed tracks in this sector corresponding to this TP.
+      const unsigned int iPhiSec = cand->iPhiSec;
+      const unsigned int iEtaReg = cand->iEtaReg;
+      trks.clear();
+      for ( ; cand != cands.end() && cand->iPhiSec == iPhiSec && cand->iEtaReg == iEtaReg; cand++) trks.push_back(cand->trk);
+      // Count them
+      unsigned int nTrk = trks.size(); 
+      // Same again, but if TP reconstructed in multiple cells of r-z HT, just count them as 1.
+      // (If no r-z HT used, then nCellsRphi will equal nTrk).
+      unsigned int nCellsRphi = mHtPairs(iPhiSec, iEtaReg).numRphiCells( trks );
+      tpRecoedInEtaSec[iEtaReg] = true; // This TP was reconstructed at least once in this eta sector.
+      nSecsMatchingTPs += 1;      // Increment sum by no. of sectors this TP was reconstructed in
+      nTrksMatchingTPs += nTrk; // Increment sum by no. of tracks this TP was reconstructed as
+      nTrksMatchingTPsIgnoringRzDups += nCellsRphi; // Ditto, but if TP reconstructed in multiple cells of r-z HT, just count them as 1.
+      profDupTracksVsTPeta_->Fill(tp.eta(), nTrk); // Study duplication of tracks within an individual HT array.
+    }
+    // Increment each time TP found in an eta sector.
     for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
-      bool tpRecoedInEtaSec = false;
-      for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-	const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
-	// Get reconstructed tracks in this sector corresponding to this TP.
-	const vector<const L1track3D*> trks = htPair.assocTrackCands3D( tp );
-	// Count them
-	unsigned int nTrk = trks.size(); 
-	// Same again, but if TP reconstructed in multiple cells of r-z HT, just count them as 1.
-	// (If no r-z HT used, then nCellsRphi will equal nTrk).
-        unsigned int nCellsRphi = htPair.numRphiCells( trks );
-        if (nTrk > 0) {
-	  tpRecoed = true;            // This TP was reconstructed at least once in tracker.
-	  tpRecoedInEtaSec = true;    // This TP was reconstructed at least once in this eta sector.
-          nSecsMatchingTPs += 1;      // Increment sum by no. of sectors this TP was reconstructed in
-  	  nTrksMatchingTPs += nTrk; // Increment sum by no. of tracks this TP was reconstructed as
-	  nTrksMatchingTPsIgnoringRzDups += nCellsRphi; // Ditto, but if TP reconstructed in multiple cells of r-z HT, just count them as 1.
-          profDupTracksVsTPeta_->Fill(tp.eta(), nTrk); // Study duplication of tracks within an individual HT array.
-        }
-      }
-      if (tpRecoedInEtaSec) nEtaSecsMatchingTPs++; // Increment each time TP found in an eta sector.
+      if (tpRecoedInEtaSec[iEtaReg]) nEtaSecsMatchingTPs++;
     }
 
     if (tpRecoed) {
@@ -1339,20 +1406,12 @@ void Histos::fillTrackCands(
       }
 
       // Check if this TP was reconstructed anywhere in the tracker..
-      bool tpRecoed = false;
+      const TPassocIndex::Range<TPassocIndex::Cand> cands = tpAssoc.assocTrackCands3D( tp );
+      bool tpRecoed = ! cands.empty();
       bool tpRecoedPerfect = false;
-      for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-	for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
-	  const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
-	  if (htPair.numAssocTrackCands3D( tp ) > 0) {
-	    tpRecoed = true;
-	    // Also note if TP was reconstructed perfectly (no incorrect hits on reco track).
-	    const vector<const L1track3D*> assTrkVec = htPair.assocTrackCands3D( tp );
-	    for (const L1track3D* assTrk : assTrkVec) {
-	      if (assTrk->getPurity() == 1.) tpRecoedPerfect = true; 
-	    }
-	  }
-	}
+      for (const TPassocIndex::Cand& cand : cands) {
+	// Also note if TP was reconstructed perfectly (no incorrect hits on reco track).
+	if (cand.trk->getPurity() == 1.) tpRecoedPerfect = true; 
       }
 
       // Count perfectly reconstructed TP (no incorrect hits on reconstructed track) used for alg. effi. measurement.
@@ -1386,23 +1445,18 @@ void Histos::fillTrackCands(
     if (tp.useForAlgEff()) { // Check TP is good for algorithmic efficiency measurement.
 
       // For each tracking particle, find the corresponding reconstructed track(s).
-      for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-	for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
-	  const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
-  	  const vector<const L1track3D*> trkVec = htPair.assocTrackCands3D( tp );
-	  for (const L1track3D* trk : trkVec) {
-	    hisQoverPtRes_->Fill(trk->qOverPt() - tp.qOverPt());
-	    hisPhi0Res_->Fill(reco::deltaPhi(trk->phi0(), tp.phi0()));
-	    hisEtaRes_->Fill(trk->eta() - tp.eta());
-	    hisZ0Res_->Fill(trk->z0() - tp.z0());
-          }
-	}
+      for (const TPassocIndex::Cand& cand : tpAssoc.assocTrackCands3D( tp )) {
+	const L1track3D* trk = cand.trk;
+	hisQoverPtRes_->Fill(trk->qOverPt() - tp.qOverPt());
+	hisPhi0Res_->Fill(reco::deltaPhi(trk->phi0(), tp.phi0()));
+	hisEtaRes_->Fill(trk->eta() - tp.eta());
+	hisZ0Res_->Fill(trk->z0() - tp.z0());
       }
     }
   }
 
   // Diagnose reason why not all viable tracking particles were reconstructed.
-  const map<const TP*, string> diagnosis = this->diagnoseTracking(inputData, mSectors, mHtPairs);
+  const map<const TP*, string> diagnosis = this->diagnoseTracking(inputData, mSectors, sectorMembership, tpAssoc);
   for (const auto& iter: diagnosis) {
     hisRecoFailureReason_->Fill(iter.second.c_str(), 1.); // Stores flag indicating failure reason.
   }
@@ -1415,7 +1469,7 @@ void Histos::fillTrackCands(
 // (If string = "mystery", reason for loss unknown. This may be a result of reconstruction of one 
 // track candidate preventing reconstruction of another. e.g. Due to duplicate track removal).
 
-map<const TP*, string> Histos::diagnoseTracking(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const boost::numeric::ublas::matrix<HTpair>& mHtPairs) const {
+map<const TP*, string> Histos::diagnoseTracking(const InputData& inputData, const boost::numeric::ublas::matrix<Sector>& mSectors, const SectorMembership& sectorMembership, const TPassocIndex& tpAssoc) const {
 
 	using namespace boost::numeric::ublas;
 	
@@ -1430,13 +1484,7 @@ map<const TP*, string> Histos::diagnoseTracking(const InputData& inputData, cons
     if ( tp.useForAlgEff()) { //--- Only consider TP that are reconstructable.
 
       //--- Check if this TP was reconstructed anywhere in the tracker..
-      bool tpRecoed = false;
-      for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-	for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
-	  const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
-	  if (htPair.numAssocTrackCands3D( tp ) > 0) tpRecoed = true;
-	}
-      }
+      bool tpRecoed = ! tpAssoc.assocTrackCands3D( tp ).empty();
 
       if ( tpRecoed) {
        
@@ -1475,9 +1523,9 @@ map<const TP*, string> Histos::diagnoseTracking(const InputData& inputData, cons
 	      std::vector<const Stub*> insidePhiSecStubsTmp;
 	      std::vector<const Stub*> insideEtaRegStubsTmp;
 	      for (const Stub* s: fePassStubs) {
-		if (sector.inside(s))    insideSecStubsTmp.push_back(s);
-		if (sector.insidePhi(s)) insidePhiSecStubsTmp.push_back(s);
-		if (sector.insideEta(s)) insideEtaRegStubsTmp.push_back(s);
+		if (sectorMembership.inside(iPhiSec, iEtaReg, s)) insideSecStubsTmp.push_back(s);
+		if (sectorMembership.insidePhi(iPhiSec, s))       insidePhiSecStubsTmp.push_back(s);
+		if (sectorMembership.insideEta(iEtaReg, s))       insideEtaRegStubsTmp.push_back(s);
 	      }
 	      // Check if TP could be reconstructed in this (phi,eta) sector.
 	      unsigned int nLayersTmp = Utility::countLayers(settings_, insideSecStubsTmp);
@@ -1629,9 +1677,10 @@ map<const TP*, string> Histos::diagnoseTracking(const InputData& inputData, cons
 
 void Histos::fillStudyBusyEvents(
 	const InputData& inputData,
-	const boost::numeric::ublas::matrix<Sector>& mSectors,
+	const SectorMembership& sectorMembership,
 	const boost::numeric::ublas::matrix<HTpair>& mHtPairs)
 {
+  if (! this->use(BusyEventHists)) return;
 
   const unsigned int numStubsCut = settings_->busySectorNumStubs();   // No. of stubs per HT array the hardware can output.
   const bool         eachCharge  = settings_->busySectorEachCharge(); // +ve & -ve tracks output on separate optical links?
@@ -1648,20 +1697,17 @@ void Histos::fillStudyBusyEvents(
 
   for (unsigned int iEtaReg = 0; iEtaReg < settings_->numEtaRegions(); iEtaReg++) {
     for (unsigned int iPhiSec = 0; iPhiSec < settings_->numPhiSectors(); iPhiSec++) {
-      const Sector& sector = mSectors(iPhiSec, iEtaReg);
+      const std::vector<const Stub*>& stubsInSector = sectorMembership.stubsInSector(iPhiSec, iEtaReg);
       const HTpair& htPair = mHtPairs(iPhiSec, iEtaReg);
       const std::vector<L1track3D>& tracks = htPair.trackCands3D();
 
       //--- Look for too many stubs input to sector.
 
-      unsigned int nStubsIn = 0;
-      for (const Stub* stub : vStubs) {
-	if ( sector.inside( stub ) )  {
-	  nStubsIn++;
-	  // Plot fraction of input stubs that would be killed by 36BX period.
-	  bool kill = (nStubsIn > numStubsCut);
-	  profFracStubsKilledVsEtaReg_->Fill(iEtaReg, kill); 
-	}
+      unsigned int nStubsIn = stubsInSector.size();
+      for (unsigned int i = 0; i < nStubsIn; i++) {
+	// Plot fraction of input stubs that would be killed by 36BX period.
+	bool kill = (i + 1 > numStubsCut);
+	profFracStubsKilledVsEtaReg_->Fill(iEtaReg, kill); 
       }
       bool tooBusyIn = (nStubsIn > numStubsCut);      
       if (tooBusyIn) nBusySecIn++;
@@ -1730,8 +1776,8 @@ void Histos::fillStudyBusyEvents(
 	  hisNumInputStubs_[tn]->Fill(nStubsIn);
 
 	  // Check if q/Pt estimated from stub bend differs in busy & quiet sectors.
-          for (const Stub* stub : vStubs) {
-    	    if ( sector.inside( stub ) ) hisQoverPtInputStubs_[tn]->Fill(abs(stub->qOverPt()));
+          for (const Stub* stub : stubsInSector) {
+    	    hisQoverPtInputStubs_[tn]->Fill(abs(stub->qOverPt()));
           }
 
 	  // Look at reconstructed tracks in this sector.
@@ -1750,7 +1796,7 @@ void Histos::fillStudyBusyEvents(
 	  float sumPt_TP_pileup  = 0.;
 	  for (const TP& tp : vTPs) {
 	    unsigned int nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi;
-	    sector.numStubsInside( tp, nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi);
+	    sectorMembership.numStubsInside( iPhiSec, iEtaReg, tp, nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi);
 	    bool tpInSector = (nStubsInsideEtaPhi >= settings_->genMinStubLayers()); // Define TP to be in this sector if it produces a good number of stubs in it.
 	    if (tpInSector) {
 	      if (tp.physicsCollision()) { // distinguish truth particles from physics collision vs from pileup.
@@ -1781,10 +1827,9 @@ void Histos::fillStudyBusyEvents(
 				hisNumInputStubs_[eventType]->Fill(nStubsIn);
 				
 				// Check if q/Pt estimated from stub bend differs in busy & quiet sectors.
-				for (const Stub* stub : vStubs)
+				for (const Stub* stub : stubsInSector)
 				{
-					if ( sector.inside( stub ) )
-						hisQoverPtInputStubs_[eventType]->Fill(abs(stub->qOverPt()));
+					hisQoverPtInputStubs_[eventType]->Fill(abs(stub->qOverPt()));
 				}
 				
 				// Look at reconstructed tracks in this sector.
@@ -1807,7 +1852,7 @@ void Histos::fillStudyBusyEvents(
 				for (const TP& tp : vTPs)
 				{
 					unsigned int nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi;
-					sector.numStubsInside( tp, nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi);
+					sectorMembership.numStubsInside( iPhiSec, iEtaReg, tp, nStubsInsideEtaPhi, nStubsInsideEta, nStubsInsidePhi);
 					
 					bool tpInSector = (nStubsInsideEtaPhi >= settings_->genMinStubLayers()); // Define TP to be in this sector if it produces a good number of stubs in it.
 					
@@ -1870,19 +1915,25 @@ void Histos::fillStudyBusyEvents(
 
   //--- Check loss in tracking efficiency caused by killing tracks in busy sectors.
 
+  // Note which truth particles were reconstructed, and which of them by tracks that weren't killed,
+  // with a single loop over the tracks, (indexed by TP::index()).
+  std::vector<bool> tpRecoedVec(vTPs.size(), false);
+  std::vector<bool> tpRecoedSurvivedVec(vTPs.size(), false);
+  for (const auto& trkm : trksInEntireTracker) {
+    const L1track3D* trk = trkm.first;
+    bool kill            = trkm.second;
+    const TP* tp = trk->getMatchedTP();
+    if (tp != nullptr) {
+      tpRecoedVec[tp->index()] = true;                          // Truth particle was reconstructed
+      if (! kill) tpRecoedSurvivedVec[tp->index()] = true;      // Ditto & reconstructed track wasn't killed by busy sector.
+    }
+  }
+
   for (const TP& tp: vTPs) {
     if (tp.useForAlgEff()) { // Check TP is good for algorithmic efficiency measurement.
 
-      bool tpRecoed = false;
-      bool tpRecoedSurvived = false;
-      for (const auto& trkm : trksInEntireTracker) {
-	const L1track3D* trk = trkm.first;
-	bool kill            = trkm.second;
-	if (trk->getMatchedTP() == &tp) {
-	  tpRecoed = true;                        // Truth particle was reconstructed
-	  if (! kill) tpRecoedSurvived = true;    // Ditto & reconstructed track wasn't killed by busy sector.
-	}
-      }
+      bool tpRecoed         = tpRecoedVec[tp.index()];
+      bool tpRecoedSurvived = tpRecoedSurvivedVec[tp.index()];
       bool tpKilled = tpRecoed && ( ! tpRecoedSurvived );
       profFracTPKilledVsEta_->Fill(fabs(tp.eta()), tpKilled);
       profFracTPKilledVsInvPt_->Fill(fabs(tp.qOverPt()), tpKilled);
@@ -1893,9 +1944,11 @@ void Histos::fillStudyBusyEvents(
 
 //=== Fill histograms for studying track fitting.
 
-void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std::pair<std::string,L1fittedTrack>>& mFittedTracks, float chi2dofCutPlots)
+void Histos::fillTrackFitting( const InputData& inputData, const FittedTrackStore& mFittedTracks, const TPassocIndex& tpAssoc, float chi2dofCutPlots)
 { 
 	using namespace std;
+
+	if (! this->use(TrackFitHists)) return;
 	
 #ifndef HISTOS_OPTIMIZE_
 	
@@ -1951,10 +2004,11 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 
 		// Only consider TP useful for algorithmic efficeincy.
 
-		for ( const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks ){
+		// Loop over the fitted tracks matched to this TP.
+		for ( uint32_t iFitTrk : tpAssoc.assocFittedTracks(tp) ){
 
-			std::string algoName(fittedTrackPair.first); // Get fitting algo name
-			const L1fittedTrack& fitTrk = fittedTrackPair.second; // Get fitted track
+			const FittedTrackStore::Track fitTrk = mFittedTracks[iFitTrk];
+			const std::string& algoName(fitTrk.fitterName()); // Get fitting algo name
 			//IRT
 			//      const TP*   assocTP =  fitTrk.getL1track3D().getMatchedTP(); // Get the TP the fitted track matches to, if any.
 			const TP*   assocTP =  fitTrk.getMatchedTP(); // Get the TP the fitted track matches to, if any.
@@ -1986,10 +2040,9 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 		}
 	}
 
-	for ( const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks ){
+	for ( const FittedTrackStore::Track fitTrk : mFittedTracks ){
 	
-		std::string const& j (fittedTrackPair.first);
-		const L1fittedTrack& fitTrk = fittedTrackPair.second;
+		std::string const& j (fitTrk.fitterName());
 
 		// Get original HT track candidate prior to fit for comparison.
 		const L1track3D& htTrk = fitTrk.getL1track3D();
@@ -2171,8 +2224,8 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 			hisTrueFittedChiSquaredVsFittedEta_[j]->Fill( fitTrk.chi2(), fitTrk.eta() );
 			hisTrueFittedChiSquaredDofVsFittedEta_[j]->Fill( fitTrk.chi2dof(), fitTrk.eta() );
 
-			hisFittedChiSquaredFunctionOfStubs_[j]->Fill( fitTrk.getStubs().size(), fitTrk.chi2() );
-			hisFittedChiSquaredDofFunctionOfStubs_[j]->Fill( fitTrk.getStubs().size(), fitTrk.chi2dof() );
+			hisFittedChiSquaredFunctionOfStubs_[j]->Fill( fitTrk.getNumStubs(), fitTrk.chi2() );
+			hisFittedChiSquaredDofFunctionOfStubs_[j]->Fill( fitTrk.getNumStubs(), fitTrk.chi2dof() );
 
 		}
 	}
@@ -2205,10 +2258,10 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 	bool tpRecoedPerfect = false;
 
 
-	for ( const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks ){
+	for ( uint32_t iFitTrk : tpAssoc.assocFittedTracks(tp) ){
 	
-		const std::string j (fittedTrackPair.first);
-		const L1fittedTrack& fitTrk = fittedTrackPair.second;
+		const FittedTrackStore::Track fitTrk = mFittedTracks[iFitTrk];
+		const std::string& j (fitTrk.fitterName());
 		
 		if (j == fitName) {
 
@@ -2304,10 +2357,11 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 		
 		// Only consider TP useful for algorithmic efficeincy.
 		
-		for (const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks)
+		// Loop over the fitted tracks matched to this TP.
+		for ( uint32_t iFitTrk : tpAssoc.assocFittedTracks(tp) )
 		{
-			std::string const& algoName = fittedTrackPair.first; // Get fitting algo name
-			const L1fittedTrack& fitTrk = fittedTrackPair.second; // Get fitted track
+			const FittedTrackStore::Track fitTrk = mFittedTracks[iFitTrk];
+			std::string const& algoName = fitTrk.fitterName(); // Get fitting algo name
 			
 			std::size_t const fitterIndex = fitterNameToFitterIndexMap_[algoName];
 			
@@ -2359,10 +2413,9 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 		}
 	}
 	
-	for ( const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks )
+	for ( const FittedTrackStore::Track fitTrk : mFittedTracks )
 	{
-		std::string const& fitName  = fittedTrackPair.first;
-		const L1fittedTrack& fitTrk = fittedTrackPair.second;
+		std::string const& fitName  = fitTrk.fitterName();
 		
 		std::size_t const fitterIndex = fitterNameToFitterIndexMap_[fitName];
 		
@@ -2577,8 +2630,8 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 			hisTrueFittedChiSquaredVsFittedEta_   [fitterIndex]->Fill( fitTrk.chi2()   , fitTrk.eta() );
 			hisTrueFittedChiSquaredDofVsFittedEta_[fitterIndex]->Fill( fitTrk.chi2dof(), fitTrk.eta() );
 			
-			hisFittedChiSquaredFunctionOfStubs_   [fitterIndex]->Fill( fitTrk.getStubs().size(), fitTrk.chi2()    );
-			hisFittedChiSquaredDofFunctionOfStubs_[fitterIndex]->Fill( fitTrk.getStubs().size(), fitTrk.chi2dof() );
+			hisFittedChiSquaredFunctionOfStubs_   [fitterIndex]->Fill( fitTrk.getNumStubs(), fitTrk.chi2()    );
+			hisFittedChiSquaredDofFunctionOfStubs_[fitterIndex]->Fill( fitTrk.getNumStubs(), fitTrk.chi2dof() );
 		}
 	}
 	
@@ -2614,10 +2667,10 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 				bool tpRecoed = false;
 				bool tpRecoedPerfect = false;
 
-				for ( const std::pair<std::string,L1fittedTrack>& fittedTrackPair : mFittedTracks )
+				for ( uint32_t iFitTrk : tpAssoc.assocFittedTracks(tp) )
 				{
-					const std::string j (fittedTrackPair.first);
-					const L1fittedTrack& fitTrk = fittedTrackPair.second;
+					const FittedTrackStore::Track fitTrk = mFittedTracks[iFitTrk];
+					const std::string& j (fitTrk.fitterName());
 					
 					if (j == fitName)
 					{
@@ -2676,7 +2729,7 @@ void Histos::fillTrackFitting( const InputData& inputData, const std::vector<std
 //=== Produce plots of tracking efficiency prior to track fit (run at end of job).
 
 void Histos::plotTrackEfficiency() {
-  TFileDirectory inputDir = fs_->mkdir("Effi");
+  HistoSet::Dir inputDir = histoSet_.mkdir("Effi");
 
   // Plot tracking efficiency
   graphEffVsInvPt_ = inputDir.make<TGraphAsymmErrors>(hisRecoTPinvptForEff_, hisTPinvptForEff_);
@@ -2711,7 +2764,7 @@ void Histos::plotTrackEfficiency() {
 //=== Produce plots of tracking efficiency after track fit (run at end of job).
 
 void Histos::plotTrackEffAfterFit(string fitName) {
-  TFileDirectory inputDir = fs_->mkdir(("Effi_"+(fitName)).c_str());
+  HistoSet::Dir inputDir = histoSet_.mkdir(("Effi_"+(fitName)).c_str());
 	
 #ifndef HISTOS_OPTIMIZE_
 	
@@ -2784,46 +2837,60 @@ void Histos::plotTrackEffAfterFit(string fitName) {
 
 void Histos::endJobAnalysis() {
 
-  // Produce plots of tracking efficiency using track candidates found prior to track fit.
-  this->plotTrackEfficiency();
+  // N.B. Only the histogram families that were booked (i.e. enabled & filled) are analysed.
+  // The tracking efficiencies after the track fit are measured relative to the track candidate histograms.
 
-  // Produce more plots of tracking efficiency using track candidates after track fit.
-  for (auto &fitName : settings_->trackFitters()) {
-    this->plotTrackEffAfterFit(fitName);
+  const bool trackCandsBooked = booked_[TrackCandHists];
+  const bool trackFitBooked   = booked_[TrackFitHists] && trackCandsBooked;
+
+  if (trackCandsBooked) {
+    // Produce plots of tracking efficiency using track candidates found prior to track fit.
+    this->plotTrackEfficiency();
   }
 
+  if (trackFitBooked) {
+    // Produce more plots of tracking efficiency using track candidates after track fit.
+    for (auto &fitName : settings_->trackFitters()) {
+      this->plotTrackEffAfterFit(fitName);
+    }
+  }
+
+  unsigned int numTPforAlg = trackCandsBooked  ?  hisTPinvptForAlgEff_->GetEntries()  :  0;
+
   //--- Print summary of track-finding performance (prior to helix fit).
 
-  float numTrackCands = profNumTrackCands_->GetBinContent(1); // No. of track cands
-  float numTrackCandsErr = profNumTrackCands_->GetBinError(1); // No. of track cands uncertainty
-  float numTPTrackCandsIncDups = profNumTrackCands_->GetBinContent(2); // Ditto, counting only those matched to TP
-  float numTPTrackCandsExcDups = profNumTrackCands_->GetBinContent(6); // Ditto, but excluding duplicates
-  float numFakeTracks = numTrackCands - numTPTrackCandsIncDups;
-  float numExtraDupTracks = numTPTrackCandsIncDups - numTPTrackCandsExcDups;
-  float fracFake = numFakeTracks/(numTrackCands + 1.0e-6);
-  float fracDup = numExtraDupTracks/(numTrackCands + 1.0e-6);
-
-  float numStubsOnTracks = profStubsOnTracks_->GetBinContent(1);
-  float meanStubsPerTrack = numStubsOnTracks/(numTrackCands + 1.0e-6); //protection against demoninator equals zero.
-  unsigned int numRecoTPforAlg = hisRecoTPinvptForAlgEff_->GetEntries();
-  unsigned int numTPforAlg     = hisTPinvptForAlgEff_->GetEntries();
-  float algEff = float(numRecoTPforAlg)/(numTPforAlg + 1.0e-6); //protection against demoninator equals zero.
-  float algEffErr = sqrt(algEff*(1-algEff)/(numTPforAlg + 1.0e-6)); // uncertainty
-  float algPerfEff = float(numPerfRecoTPforAlg_)/(numTPforAlg + 1.0e-6); //protection against demoninator equals zero.
-  float algPerfEffErr = sqrt(algPerfEff*(1-algPerfEff)/(numTPforAlg + 1.0e-6)); // uncertainty
-  cout<<"========================================================================="<<endl;
-  cout<<"               TRACK-FINDING SUMMARY (before track fit)                  "<<endl;
-  cout<<"Number of track candidates found per event = "<<numTrackCands<<" +- "<<numTrackCandsErr<<endl;
-  cout<<"                     with mean stubs/track = "<<meanStubsPerTrack<<endl; 
-  cout<<"Fraction of track cands that are fake = "<<fracFake<<endl;
-  cout<<"Fraction of track cands that are genuine, but extra duplicates = "<<fracDup<<endl;
-  cout<<"Algorithmic tracking efficiency = "<<numRecoTPforAlg<<"/"<<numTPforAlg<<" = "<<algEff<<" +- "<<algEffErr<<endl;
-  cout<<"Perfect algorithmic tracking efficiency = "<<numPerfRecoTPforAlg_<<"/"<<numTPforAlg<<" = "<<algPerfEff<<" +- "<<algPerfEffErr<<" (no incorrect hits)"<<endl;
-  cout<<"========================================================================="<<endl;
+  if (trackCandsBooked) {
+    float numTrackCands = profNumTrackCands_->GetBinContent(1); // No. of track cands
+    float numTrackCandsErr = profNumTrackCands_->GetBinError(1); // No. of track cands uncertainty
+    float numTPTrackCandsIncDups = profNumTrackCands_->GetBinContent(2); // Ditto, counting only those matched to TP
+    float numTPTrackCandsExcDups = profNumTrackCands_->GetBinContent(6); // Ditto, but excluding duplicates
+    float numFakeTracks = numTrackCands - numTPTrackCandsIncDups;
+    float numExtraDupTracks = numTPTrackCandsIncDups - numTPTrackCandsExcDups;
+    float fracFake = numFakeTracks/(numTrackCands + 1.0e-6);
+    float fracDup = numExtraDupTracks/(numTrackCands + 1.0e-6);
+
+    float numStubsOnTracks = profStubsOnTracks_->GetBinContent(1);
+    float meanStubsPerTrack = numStubsOnTracks/(numTrackCands + 1.0e-6); //protection against demoninator equals zero.
+    unsigned int numRecoTPforAlg = hisRecoTPinvptForAlgEff_->GetEntries();
+    float algEff = float(numRecoTPforAlg)/(numTPforAlg + 1.0e-6); //protection against demoninator equals zero.
+    float algEffErr = sqrt(algEff*(1-algEff)/(numTPforAlg + 1.0e-6)); // uncertainty
+    float algPerfEff = float(numPerfRecoTPforAlg_)/(numTPforAlg + 1.0e-6); //protection against demoninator equals zero.
+    float algPerfEffErr = sqrt(algPerfEff*(1-algPerfEff)/(numTPforAlg + 1.0e-6)); // uncertainty
+    cout<<"========================================================================="<<endl;
+    cout<<"               TRACK-FINDING SUMMARY (before track fit)                  "<<endl;
+    cout<<"Number of track candidates found per event = "<<numTrackCands<<" +- "<<numTrackCandsErr<<endl;
+    cout<<"                     with mean stubs/track = "<<meanStubsPerTrack<<endl; 
+    cout<<"Fraction of track cands that are fake = "<<fracFake<<endl;
+    cout<<"Fraction of track cands that are genuine, but extra duplicates = "<<fracDup<<endl;
+    cout<<"Algorithmic tracking efficiency = "<<numRecoTPforAlg<<"/"<<numTPforAlg<<" = "<<algEff<<" +- "<<algEffErr<<endl;
+    cout<<"Perfect algorithmic tracking efficiency = "<<numPerfRecoTPforAlg_<<"/"<<numTPforAlg<<" = "<<algPerfEff<<" +- "<<algPerfEffErr<<" (no incorrect hits)"<<endl;
+    cout<<"========================================================================="<<endl;
+  }
 
   //--- Print summary of track-finding performance after helix fit, for each track fitting algorithm used.
    
-  for (auto &fitName : settings_->trackFitters())
+  const std::vector<std::string> noFitters;
+  for (auto &fitName : (trackFitBooked  ?  settings_->trackFitters()  :  noFitters))
 	{
 	
 #ifndef HISTOS_OPTIMIZE_
@@ -2915,8 +2982,10 @@ void Histos::endJobAnalysis() {
 
 	// Check for presence of common MC bug.
 
-	float meanShared = hisFracStubsSharingClus0_->GetMean();
-	if (meanShared > 0.01) cout<<endl<<"WARNING: You are using buggy MC. A fraction "<<meanShared<<" of stubs share clusters in the module seed sensor, which front-end electronics forbids."<<endl;
+	if (booked_[InputDataHists]) {
+		float meanShared = hisFracStubsSharingClus0_->GetMean();
+		if (meanShared > 0.01) cout<<endl<<"WARNING: You are using buggy MC. A fraction "<<meanShared<<" of stubs share clusters in the module seed sensor, which front-end electronics forbids."<<endl;
+	}
 
 #else
 
@@ -3011,9 +3080,12 @@ void Histos::endJobAnalysis() {
 
 	// Check for presence of common MC bug.
 
-	float meanShared = hisFracStubsSharingClus0_->GetMean();
-	if (meanShared > 0.01)
-		cout << endl << "WARNING: You are using buggy MC. A fraction " << meanShared << " of stubs share clusters in the module seed sensor, which front-end electronics forbids." << endl;
+	if (booked_[InputDataHists])
+	{
+		float meanShared = hisFracStubsSharingClus0_->GetMean();
+		if (meanShared > 0.01)
+			cout << endl << "WARNING: You are using buggy MC. A fraction " << meanShared << " of stubs share clusters in the module seed sensor, which front-end electronics forbids." << endl;
+	}
 
 	#endif
 }
@@ -0,0 +1,195 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/HistosWorker.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Histos.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+using namespace std;
+using  boost::numeric::ublas::matrix;
+
+//=== Create storage for the results of one event.
+
+HistosEvent::HistosEvent(const Settings* settings) : fittedTracks(settings), settings_(settings) {}
+
+//=== Prepare for a new event, taking ownership of its input data, and creating fresh sectors & HT arrays.
+
+void HistosEvent::reset(InputData* newInputData) {
+  inputData.reset(newInputData);
+  // N.B. Sector & HTpair objects can't be reinitialized, so are recreated each event.
+  mSectors = matrix<Sector>(settings_->numPhiSectors(), settings_->numEtaRegions());
+  mHtPairs = matrix<HTpair>(settings_->numPhiSectors(), settings_->numEtaRegions());
+}
+
+//=== Start the separate histogramming thread, if requested.
+
+HistosWorker::HistosWorker(const Settings* settings, Histos* hists) :
+  settings_(settings), hists_(hists), async_(settings->asyncHistos()), maxQueueSize_(settings->asyncHistosQueueSize()),
+  nBusy_(0), stop_(false), errorReported_(false)
+{
+  if (async_) {
+    const unsigned int nThreads = settings->asyncHistosThreads();
+    if (maxQueueSize_ == 0) throw cms::Exception("HistosWorker: AsyncHistosQueueSize must be at least 1");
+    if (nThreads      == 0) throw cms::Exception("HistosWorker: AsyncHistosThreads must be at least 1");
+
+    // Book the histograms & histogram shards here, since ROOT can't book histograms in several threads at once.
+    hists_->book();
+    for (unsigned int i = 1; i < nThreads; i++) shards_.push_back( hists_->bookShard() );
+
+    threads_.push_back( thread(&HistosWorker::run, this, hists_) );
+    for (Histos* shard : shards_) threads_.push_back( thread(&HistosWorker::run, this, shard) );
+  }
+}
+
+//=== Stop the separate threads, if not already done by finish().
+
+HistosWorker::~HistosWorker() {
+  this->stopThreads();
+  for (Histos* shard : shards_) delete shard;
+}
+
+//=== Get an empty HistosEvent, reusing one that has already been histogrammed if possible.
+
+unique_ptr<HistosEvent> HistosWorker::newEvent() {
+  unique_ptr<HistosEvent> event;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (! done_.empty()) {
+      event = std::move(done_.back());
+      done_.pop_back();
+    }
+  }
+  if (event == nullptr) event.reset(new HistosEvent(settings_));
+  return event;
+}
+
+//=== Fill histograms with the results of an event (possibly later, in the separate thread).
+
+void HistosWorker::fill(unique_ptr<HistosEvent> event) {
+  if (async_) {
+    unique_lock<mutex> lock(mutex_);
+    // Wait for space in the queue.
+    cond_.wait(lock, [this]{return queue_.size() < maxQueueSize_ || this->errorPending();});
+    this->rethrow();
+    queue_.push_back( std::move(event) );
+    cond_.notify_all();
+
+  } else {
+    this->fillHists(hists_, *event);
+    event->inputData.reset();
+    done_.push_back( std::move(event) );
+  }
+}
+
+//=== Wait until all events passed to fill() have been histogrammed.
+
+void HistosWorker::wait() {
+  if (async_) {
+    unique_lock<mutex> lock(mutex_);
+    cond_.wait(lock, [this]{return (queue_.empty() && nBusy_ == 0) || this->errorPending();});
+    this->rethrow();
+  }
+}
+
+//=== Histogram all remaining events, stop the separate threads, and merge their histograms into the Histos ones.
+
+void HistosWorker::finish() {
+  this->stopThreads();
+  {
+    lock_guard<mutex> lock(mutex_);
+    this->rethrow();
+  }
+
+  // Merge the shards in a fixed order.
+  for (Histos* shard : shards_) {
+    hists_->mergeShard(*shard);
+    delete shard;
+  }
+  shards_.clear();
+}
+
+//=== Stop the separate threads, once they have histogrammed all remaining events.
+
+void HistosWorker::stopThreads() {
+  if (! threads_.empty()) {
+    {
+      lock_guard<mutex> lock(mutex_);
+      stop_ = true;
+      cond_.notify_all();
+    }
+    for (thread& t : threads_) t.join();
+    threads_.clear();
+  }
+}
+
+//=== Fill given histograms with the results of an event.
+
+void HistosWorker::fillHists(Histos* hists, HistosEvent& event) {
+
+  const InputData& inputData = *(event.inputData);
+
+  //=== Fill histograms with stubs and tracking particles from input data.
+  hists->fillInputData(inputData);
+
+  //=== Fill histograms that check if choice of (eta,phi) sectors is good.
+  hists->fillEtaPhiSectors(inputData, event.sectorMembership);
+
+  //=== Fill histograms that look at filling of r-phi HT arrays.
+  hists->fillRphiHT(event.mHtPairs);
+
+  //=== Fill histograms that look at r-z filters (or other filters run after r-phi HT).
+  hists->fillRZfilters(event.mHtPairs);
+
+  //=== Note which track candidates & fitted tracks are matched to each tracking particle.
+  if (hists->enabled(Histos::TrackCandHists) || hists->enabled(Histos::TrackFitHists)) {
+    event.tpAssoc.fill(inputData, event.mHtPairs, event.fittedTracks);
+  }
+
+  //=== Fill histograms studying track candidates found by r-phi Hough Transform.
+  hists->fillTrackCands(inputData, event.mSectors, event.sectorMembership, event.mHtPairs, event.tpAssoc);
+
+  //=== Fill histograms studying track fitting performance
+  hists->fillTrackFitting(inputData, event.fittedTracks, event.tpAssoc, settings_->chi2OverNdfCut() );
+}
+
+//=== Main loop of each separate thread, histogramming the queued events into the given histograms.
+
+void HistosWorker::run(Histos* hists) {
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]{return ! queue_.empty() || stop_;});
+    if (queue_.empty()) break; // Only stop once all events are histogrammed.
+
+    unique_ptr<HistosEvent> event = std::move(queue_.front());
+    queue_.pop_front();
+    nBusy_++;
+    cond_.notify_all();
+
+    // After an error, the remaining events are discarded. (error_ stays set after it has been rethrown).
+    const bool failed = (error_ != nullptr);
+
+    lock.unlock();
+    try {
+      if (! failed) this->fillHists(hists, *event);
+    } catch (...) {
+      lock.lock();
+      if (error_ == nullptr) error_ = current_exception();
+      lock.unlock();
+    }
+    // Release the input data now, rather than when the event is reused.
+    event->inputData.reset();
+    lock.lock();
+
+    done_.push_back( std::move(event) );
+    nBusy_--;
+    cond_.notify_all();
+  }
+}
+
+//=== Rethrow any exception that occurred in the separate thread, unless already done. (Call with mutex_ locked).
+
+void HistosWorker::rethrow() {
+  if (this->errorPending()) {
+    errorReported_ = true;
+    rethrow_exception(error_);
+  }
+}
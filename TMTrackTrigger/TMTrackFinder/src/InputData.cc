@@ -1,6 +1,7 @@
 #include "FWCore/Framework/interface/ESHandle.h"
 #include "FWCore/Framework/interface/Event.h"
 #include "FWCore/Framework/interface/EventSetup.h"
+#include "FWCore/Utilities/interface/Exception.h"
 
 #include "SimDataFormats/Track/interface/SimTrack.h"
 #include "SimDataFormats/EncodedEventId/interface/EncodedEventId.h"
@@ -15,12 +16,14 @@
 
 #include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleGeometryCache.h"
 
 #include <map>
 
 using namespace std;
  
-InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings) {
+InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Settings* settings, ModuleGeometryCache* moduleCache) {
 
   vTPs_.reserve(2500);
   vStubs_.reserve(35000);
@@ -74,7 +77,7 @@ InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Se
     for (DetSet::const_iterator p_ttstub = p_module->begin(); p_ttstub != p_module->end(); p_ttstub++) {
       TTStubRef ttStubRef = edmNew::makeRefTo(ttStubHandle, p_ttstub );
       // Store the Stub info, using class Stub to provide easy access to the most useful info.
-      Stub stub(ttStubRef, stubCount, settings, stackedGeometry);
+      Stub stub(ttStubRef, stubCount, settings, stackedGeometry, moduleCache);
       // Also fill truth associating stubs to tracking particles.
       //      stub.fillTruth(vTPs_, mcTruthTTStubHandle, mcTruthTTClusterHandle); 
       stub.fillTruth(translateTP, mcTruthTTStubHandle, mcTruthTTClusterHandle); 
@@ -88,14 +91,77 @@ InputData::InputData(const edm::Event& iEvent, const edm::EventSetup& iSetup, Se
   for (const Stub& s : vAllStubs_) {
     if (s.frontendPass()) vStubs_.push_back( &s );
   }
+  stubTable_.fill(vStubs_);
 
 
   // Note list of stubs produced by each tracking particle.
+  this->fillTruthOfTPs();
+}
+
+//=== Unpack stubs & tracking particles from a snapshot file, instead of from the EDM event.
+
+InputData::InputData(const EventSnapshotReader& reader, unsigned int iEvent, Settings* settings) {
+
+  // Stubs written with StubMatchStrict = True do not record TPs contributing to only one cluster.
+  if (reader.stubMatchStrict() && ! settings->stubMatchStrict()) throw cms::Exception("InputData: Snapshot file was written with StubMatchStrict = True, so can't be used with StubMatchStrict = False. File = ")<<reader.fileName()<<endl;
+
+  this->unpackSnapshot(reader.event(iEvent), settings);
+}
+
+//=== Unpack stubs & tracking particles from snapshot records held in memory (e.g. made by the StubGenerator).
+
+InputData::InputData(const SnapshotEvent& snapEvent, Settings* settings) {
+  this->unpackSnapshot(snapEvent, settings);
+}
+
+//=== Create the Stub & TP objects from the snapshot records of one event.
+
+void InputData::unpackSnapshot(const SnapshotEvent& snapEvent, Settings* settings) {
+
+  const unsigned int nTPs   = snapEvent.header->nTPs;
+  const unsigned int nStubs = snapEvent.header->nStubs;
 
-  // (By passing vAllStubs_ here instead of vStubs_, it means that any algorithmic efficiencies
+  vTPs_.reserve(nTPs);
+  vStubs_.reserve(nStubs);
+  vAllStubs_.reserve(nStubs);
+
+  for (unsigned int i = 0; i < nTPs; i++) {
+    vTPs_.push_back( TP(snapEvent.tps[i], i, settings) );
+  }
+
+  for (unsigned int i = 0; i < nStubs; i++) {
+    Stub stub(snapEvent.stubs[i], i, settings);
+    stub.fillTruth(snapEvent.stubs[i], snapEvent.links, vTPs_);
+    vAllStubs_.push_back( stub );
+  }
+
+  for (const Stub& s : vAllStubs_) {
+    if (s.frontendPass()) vStubs_.push_back( &s );
+  }
+  stubTable_.fill(vStubs_);
+
+  this->fillTruthOfTPs();
+}
+
+//=== Note list of stubs produced by each tracking particle.
+//=== The lists of all tracking particles are filled in a single pass over the stubs, 
+//=== appending each stub to the list of each tracking particle associated to it.
+
+void InputData::fillTruthOfTPs() {
+
+  // (By using vAllStubs_ here instead of vStubs_, it means that any algorithmic efficiencies
   // measured will be reduced if the tightened frontend electronics cuts, specified in section StubCuts
   // of Analyze_Defaults_cfi.py, are not 100% efficient).
+
+  vector< vector<const Stub*> > tpStubs(vTPs_.size());
+
+  for (const Stub& s : vAllStubs_) {
+    for (const TP* tp : s.assocTPs()) {
+      tpStubs[tp->index()].push_back(&s);
+    }
+  }
+
   for (unsigned int j = 0; j < vTPs_.size(); j++) {
-    vTPs_[j].fillTruth(vAllStubs_);
+    vTPs_[j].fillTruth(tpStubs[j]);
   }
 }
@@ -8,8 +8,11 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/L1fittedTrack.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/L1track3D.h"
  
+#include "FWCore/Utilities/interface/Exception.h"
+ 
 #include <algorithm>
 #include <functional>
+#include <cmath>
  
 template <typename T>
 std::vector<T> operator-(const std::vector<T>& a, const std::vector<T>& b){
@@ -31,9 +34,10 @@ L1ChiSquared::L1ChiSquared(const Settings* settings, const uint nPar) : TrackFit
   minStubLayers_ = getSettings()->minStubLayers();
   minPtToReduceLayers_ = getSettings()->minPtToReduceLayers();
   nPar_ = nPar;
+  if (nPar_ > maxPar_) throw cms::Exception("L1ChiSquared: number of helix params exceeds maximum supported.")<<" nPar = "<<nPar_<<std::endl;
 }
  
-void L1ChiSquared::calculateChiSq( std::vector<double> resids ){
+void L1ChiSquared::calculateChiSq( const std::vector<double>& resids ){
   chiSq_ = 0.0;
   uint j=0;
   for ( uint i=0; i<stubs_.size(); i++ ){
@@ -42,29 +46,88 @@ void L1ChiSquared::calculateChiSq( std::vector<double> resids ){
   }
 }
 
-void L1ChiSquared::calculateDeltaChiSq( std::vector<double> delX, std::vector<double> covX ){
+void L1ChiSquared::calculateDeltaChiSq( const std::vector<double>& delX, const std::vector<double>& covX ){
   for ( uint i=0; i<covX.size(); i++ ){
     chiSq_ += (-delX[i])*covX[i];
   }
 }
 
+bool L1ChiSquared::solveCholesky( unsigned int n, const double M[maxPar_][maxPar_], const double b[maxPar_], double x[maxPar_] ){
+  // Decompose M = L*L^T.
+  double L[maxPar_][maxPar_];
+  for ( uint i=0; i<n; i++ ){
+    for ( uint j=0; j<=i; j++ ){
+      double sum = M[i][j];
+      for ( uint k=0; k<j; k++ ) sum -= L[i][k]*L[j][k];
+      if ( i == j ){
+        if ( !(sum > 0.) ) return false;
+        L[i][i] = std::sqrt(sum);
+      } else {
+        L[i][j] = sum/L[j][j];
+      }
+    }
+  }
+  // Forward substitution L*y = b, then back substitution L^T*x = y.
+  double y[maxPar_];
+  for ( uint i=0; i<n; i++ ){
+    double sum = b[i];
+    for ( uint k=0; k<i; k++ ) sum -= L[i][k]*y[k];
+    y[i] = sum/L[i][i];
+  }
+  for ( int i=n-1; i>=0; i-- ){
+    double sum = y[i];
+    for ( uint k=i+1; k<n; k++ ) sum -= L[k][i]*x[k];
+    x[i] = sum/L[i][i];
+  }
+  return true;
+}
+
+void L1ChiSquared::fitStep( const std::vector<double>& x, const std::vector<double>& resids, std::vector<double>& deltaX, std::vector<double>& covX ){
+
+  D(x, d_); // Calculate derivatives
+
+  // Accumulate M = (D^T*Vinv)*(D^T*Vinv)^T and covX = D^T*Vinv*resids, using the diagonal Vinv.
+  //TODO M matches tracklet code, but not literature (which has D^T*Vinv*D).
+  double M[maxPar_][maxPar_] = {};
+  double b[maxPar_] = {};
+  const unsigned int nMeas = vinv_.size();
+  for ( uint j=0; j<nMeas; j++ ){
+    double a[maxPar_];
+    for ( uint k=0; k<nPar_; k++ ) a[k] = d_[j*nPar_ + k]*vinv_[j];
+    for ( uint k=0; k<nPar_; k++ ){
+      b[k] += a[k]*resids[j];
+      for ( uint l=0; l<=k; l++ ) M[k][l] += a[k]*a[l];
+    }
+  }
+  for ( uint k=0; k<nPar_; k++ ){
+    for ( uint l=0; l<k; l++ ) M[l][k] = M[k][l];
+  }
+
+  covX.assign(b, b + nPar_);
+  deltaX.resize(nPar_);
+  if ( !solveCholesky(nPar_, M, b, &deltaX[0]) ){
+    // M not positive definite (e.g. too few stubs left), so fall back to the general matrix inverse.
+    Matrix<double> mInv(nPar_, nPar_, 0.0);
+    for ( uint k=0; k<nPar_; k++ ){
+      for ( uint l=0; l<nPar_; l++ ) mInv(k, l) = M[k][l];
+    }
+    deltaX = mInv.inverse() * covX;
+  }
+}
+
 L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec, unsigned int iEtaReg){
   
   stubs_ = l1track3D.getStubs();
   
   std::vector<double> x = seed(l1track3D);
-  
-  Matrix<double> d = D(x);
-  Matrix<double> dtVinv = d.transpose() * Vinv();
-//  Matrix<double> M = dtVinv * d;
-  Matrix<double> M = dtVinv * (dtVinv.transpose()); //TODO this match tracklet code, but not literature:w
+  vinv_ = Vinv(); // Only depends on the stubs, so only recalculated when a stub is killed.
 
   std::vector<double> resids = residuals(x);
 //  std::cout << "resids.size(): " << resids.size() << std::endl;
 
-  std::vector<double> deltaX = M.inverse() * dtVinv * resids;
+  std::vector<double> deltaX, covX;
+  fitStep(x, resids, deltaX, covX);
   x = x - deltaX;
-  std::vector<double> covX = d.transpose() * Vinv() * resids;  
 
   calculateChiSq(resids);
   calculateDeltaChiSq (deltaX, covX);
@@ -74,16 +137,13 @@ L1fittedTrack L1ChiSquared::fit(const L1track3D& l1track3D, unsigned int iPhiSec
     if (i>1) {
       if ( killTrackFitWorstHit_  &&  (largestresid_ > killingResidualCut_ || (largestresid_ > generalResidualCut_ && Utility::countLayers( getSettings(), stubs_ ) > minStubLayers_)) ) {
         stubs_.erase(stubs_.begin()+ilargestresid_);
+        vinv_.erase(vinv_.begin()+2*ilargestresid_, vinv_.begin()+2*ilargestresid_+2);
         if (getSettings()->debug() == 6) std::cout << __FILE__ " : Killed stub " << ilargestresid_ << "." << std::endl;
       }
 
-      d = D(x); // Calculate derivatives
-      dtVinv = d.transpose() * Vinv();
-      M = dtVinv * (dtVinv.transpose()); 
       resids = residuals(x); // Calculate new residuals
-      std::vector<double> deltaX = M.inverse() * dtVinv * resids;
+      fitStep(x, resids, deltaX, covX);
       x = x - deltaX;
-      std::vector<double> covX = d.transpose() * Vinv() * resids;  
       resids = residuals(x); // update resids.
 
       calculateChiSq(resids);
@@ -282,8 +282,7 @@ static void printStub( std::ostream &os, const Stub * stub ){
     os  << "[r,phi,z] = ";
     os << "[" << stub->r() << ", " << stub->phi() << ", " << stub->z() << "] ";
     os << " assoc TP indices = [ "; 
-    std::set<const TP*> tps = stub->assocTPs();
-    for( auto tp : tps ) os << tp->index() << " "; 
+    for( auto tp : stub->assocTPs() ) os << tp->index() << " "; 
     os << "] ";
     os << endl;
 
@@ -298,9 +297,8 @@ static void printStubs( std::ostream &os, std::vector<const Stub *> &stubs ){
    static void printStubAssociatedTPs( std::ostream &os, std::vector<const Stub *> &stubs ){
 
    for( unsigned i=0; i<stubs.size(); i++ ){
-   std::set<const TP*> tps = stubs[i]->assocTPs();
    os << "stub TP indices = [ ";
-   for( auto tp : tps ) os << tp->index() << " "; 
+   for( auto tp : stubs[i]->assocTPs() ) os << tp->index() << " "; 
    os << "] ";
    }
    os << endl;
@@ -632,8 +630,7 @@ std::vector<const kalmanState *> L1KalmanComb::doKF( unsigned nItr, const std::v
 		else{
 		    if( getSettings()->kalmanDebugLevel() >= 2 ){
 			if( tpa && tpa->useForAlgEff() ){
-			    set<const TP*> tps = pre_next_stub->assocTPs();
-			    if( state->good( tpa ) && tps.find( tpa ) != tps.end() ){
+			    if( state->good( tpa ) && pre_next_stub->assocTPs().contains( tpa ) ){
 				cout << "A good stub is thrown away." << " e2 = " << e2 << " TPindex = " << tpa->index() << " [eta,phi] = [" << iCurrentPhiSec_ << " , " << iCurrentEtaReg_ << "]" << endl;
 				printStub(cout,pre_next_stub);
 				validationGate( pre_next_stub, nItr, *state, e2, true );
@@ -65,7 +65,6 @@ L1fittedTrack LinearRegression::fit( const L1track3D& l1track3D, unsigned int iP
   for ( int i = 1; i < numFittingIterations_ + 1; i++ ) {
     if ( not killLargestResidual() )
       break;
-    updateLayerMap();
     if ( not checkValidity() )
       break;
     calcHelix();
@@ -91,30 +90,58 @@ void LinearRegression::initFit( const L1track3D& l1track3D, unsigned int iPhiSec
   if ( l1track3D.pt() > minPtToReduceLayers_ )
     minStubLayers_ --;
   stubs_ = l1track3D.getStubs();
-  updateLayerMap();
+  initLayerCounts();
   helixRPhi_ = l1track3D.getHelixRphi();
   helixRPhi_.first *= invPtToDphi_;
   helixRZ_ = std::make_pair( 0., zCentre_ / chosenRofZ_ );
 
 }
 
-void LinearRegression::updateLayerMap() {
+void LinearRegression::initLayerCounts() {
 
   NumStubs_ = stubs_.size();
-  nLayers_ = Utility::countLayers( settings_, stubs_ );
-  nPSLayers_ = Utility::countLayers( settings_, stubs_, false, true );
-  layerMap_.clear();
-  psLayerMap_.clear();
+  stubLayer_.resize( NumStubs_ );
+  stubCountLayer_.resize( NumStubs_ );
+  std::fill( nStubsInLayer_, nStubsInLayer_ + nLayerIdReduced_, 0 );
+  std::fill( nPSStubsInLayer_, nPSStubsInLayer_ + nLayerIdReduced_, 0 );
+  std::fill( nStubsInCountLayer_, nStubsInCountLayer_ + Utility::maxLayerForCounting, 0 );
+  std::fill( nPSStubsInCountLayer_, nPSStubsInCountLayer_ + Utility::maxLayerForCounting, 0 );
+  nLayers_ = 0;
+  nPSLayers_ = 0;
   for( unsigned int is = 0; is < NumStubs_; is++ ) {
     const Stub* s( stubs_[ is ] );
-    layerID_ = s->layerIdReduced();
-    layerMap_[ layerID_ ].push_back( is );
-    if ( s->psModule() )
-      psLayerMap_[ layerID_ ].push_back( is );
+    stubLayer_[ is ] = s->layerIdReduced();
+    stubCountLayer_[ is ] = Utility::layerForCounting( settings_, s );
+    nStubsInLayer_[ stubLayer_[ is ] ] ++;
+    if ( nStubsInCountLayer_[ stubCountLayer_[ is ] ] ++ == 0 )
+      nLayers_ ++;
+    if ( s->psModule() ) {
+      nPSStubsInLayer_[ stubLayer_[ is ] ] ++;
+      if ( nPSStubsInCountLayer_[ stubCountLayer_[ is ] ] ++ == 0 )
+        nPSLayers_ ++;
+    }
   }
 
 }
 
+void LinearRegression::removeStub( unsigned int is ) {
+
+  const Stub* s( stubs_[ is ] );
+  nStubsInLayer_[ stubLayer_[ is ] ] --;
+  if ( -- nStubsInCountLayer_[ stubCountLayer_[ is ] ] == 0 )
+    nLayers_ --;
+  if ( s->psModule() ) {
+    nPSStubsInLayer_[ stubLayer_[ is ] ] --;
+    if ( -- nPSStubsInCountLayer_[ stubCountLayer_[ is ] ] == 0 )
+      nPSLayers_ --;
+  }
+  stubs_.erase( stubs_.begin() + is );
+  stubLayer_.erase( stubLayer_.begin() + is );
+  stubCountLayer_.erase( stubCountLayer_.begin() + is );
+  NumStubs_ --;
+
+}
+
 bool LinearRegression::checkValidity() {
 
   valid_ = true;
@@ -129,39 +156,43 @@ bool LinearRegression::checkValidity() {
 void LinearRegression::calcHelix( bool useHelix ) {
 
   resetSums();
-  for ( auto l : layerMap_ )  if ( useHelix or psLayerMap_[ l.first ].size() > 0 ) {
-    phiMinMax_ = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
-    rMinMax_ = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
-    zMinMax_ = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
-    for ( auto is : l.second ) {
-      const Stub* s( stubs_[ is ] );
+  for ( unsigned int l = 0; l < nLayerIdReduced_; l++ ) {
+    phiMinMax_[ l ] = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
+    rMinMax_[ l ] = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
+    zMinMax_[ l ] = std::make_pair( std::numeric_limits< float >::infinity(), - std::numeric_limits< float >::infinity() );
+  }
+  for ( unsigned int is = 0; is < NumStubs_; is++ ) {
+    const Stub* s( stubs_[ is ] );
+    r_ = s->r();
+    z_ = s->r() * helixRZ_.second + helixRZ_.first;
+    if ( not s-> barrel() ) {
+      r_ = ( s->z() - helixRZ_.first ) / helixRZ_.second;
+      z_ = s->z();
+    }
+    phi_ = s->phi();
+    if ( lineariseStubPosition_ )
+      phi_ = reco::deltaPhi( s->phi(), reco::deltaPhi( r_ * helixRPhi_.first, std::asin( r_ * helixRPhi_.first ) ) );
+    if ( not useHelix ) {
       r_ = s->r();
-      z_ = s->r() * helixRZ_.second + helixRZ_.first;
-      if ( not s-> barrel() ) {
-        r_ = ( s->z() - helixRZ_.first ) / helixRZ_.second;
-        z_ = s->z();
-      }
       phi_ = s->phi();
-      if ( lineariseStubPosition_ )
-        phi_ = reco::deltaPhi( s->phi(), reco::deltaPhi( r_ * helixRPhi_.first, std::asin( r_ * helixRPhi_.first ) ) );
-      if ( not useHelix ) {
-        r_ = s->r();
-        phi_ = s->phi();
-        z_ = s->z();
-        if ( not s->psModule() )
-          continue;
-      }
-      phi_ = reco::deltaPhi( phi_, phiCentre_ );
-      z_ -= zCentre_;
-      rMinMax_ = std::make_pair( std::min( rMinMax_.first, r_ ), std::max( rMinMax_.second, r_ ) );
-      phiMinMax_ = std::make_pair( std::min( phiMinMax_.first, phi_ ), std::max( phiMinMax_.second, phi_ ) );
-      zMinMax_ = std::make_pair( std::min( zMinMax_.first, z_ ), std::max( zMinMax_.second, z_ ) );
+      z_ = s->z();
+      if ( not s->psModule() )
+        continue;
     }
-    r_ = ( rMinMax_.first + rMinMax_.second ) / 2.;
+    phi_ = reco::deltaPhi( phi_, phiCentre_ );
+    z_ -= zCentre_;
+    const unsigned int l = stubLayer_[ is ];
+    rMinMax_[ l ] = std::make_pair( std::min( rMinMax_[ l ].first, r_ ), std::max( rMinMax_[ l ].second, r_ ) );
+    phiMinMax_[ l ] = std::make_pair( std::min( phiMinMax_[ l ].first, phi_ ), std::max( phiMinMax_[ l ].second, phi_ ) );
+    zMinMax_[ l ] = std::make_pair( std::min( zMinMax_[ l ].first, z_ ), std::max( zMinMax_[ l ].second, z_ ) );
+  }
+  // Sum over layers in order of increasing layer ID.
+  for ( unsigned int l = 0; l < nLayerIdReduced_; l++ ) if ( nStubsInLayer_[ l ] > 0 and ( useHelix or nPSStubsInLayer_[ l ] > 0 ) ) {
+    r_ = ( rMinMax_[ l ].first + rMinMax_[ l ].second ) / 2.;
     rTPhi_ = r_ - chosenRofPhi_;
     rTZ_ = r_ - chosenRofZ_;
-    phi_ = ( phiMinMax_.first + phiMinMax_.second ) / 2.;
-    z_ = ( zMinMax_.first + zMinMax_.second ) / 2.;
+    phi_ = ( phiMinMax_[ l ].first + phiMinMax_[ l ].second ) / 2.;
+    z_ = ( zMinMax_[ l ].first + zMinMax_[ l ].second ) / 2.;
     updateSums();
   }
   calcLinearParameter();
@@ -202,17 +233,20 @@ bool LinearRegression::killLargestResidual() {
  
   largestresid_ = -1.0;
   ilargestresid_  = -1;
-  for ( auto l : layerMap_ ) if ( l.second.size() > 1 or NumStubs_ == nLayers_ ) for ( const unsigned int s : l.second ) {
+  // In case of equal residuals, prefer the stub in the lowest layer, then the first stub in that layer.
+  unsigned int layerLargestResid = 0;
+  for( unsigned int s = 0; s < NumStubs_; s++ ) if ( nStubsInLayer_[ stubLayer_[ s ] ] > 1 or NumStubs_ == nLayers_ ) {
     resid_ = std::max( residRPhi_[ s ], residRZ_[ s ] );
     if ( combineResiduals_ )
       resid_ = std::fabs( residRPhi_[ s ] ) / 2. + std::fabs( residRZ_[ s ] ) / 2.; 
-    if ( resid_ > largestresid_ ) {
+    if ( resid_ > largestresid_ or ( resid_ == largestresid_ and ilargestresid_ >= 0 and stubLayer_[ s ] < layerLargestResid ) ) {
       largestresid_ = resid_;
       ilargestresid_ = s;
+      layerLargestResid = stubLayer_[ s ];
     }
   }
-  if ( largestresid_ > killingResidualCut_ or NumStubs_ > nLayers_ ) {
-    stubs_.erase( stubs_.begin() + ilargestresid_ );
+  if ( ilargestresid_ >= 0 and ( largestresid_ > killingResidualCut_ or NumStubs_ > nLayers_ ) ) {
+    removeStub( ilargestresid_ );
     return true;
   }
   return false;
@@ -0,0 +1,79 @@
+#include "Geometry/TrackerGeometryBuilder/interface/StackedTrackerGeometry.h"
+
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleGeometryCache.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+//=== Get info about given module, taking it from the tracker geometry if it is not yet in the cache.
+
+const ModuleInfo& ModuleGeometryCache::module(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
+  const uint32_t idDet = stDetId();
+  if (lastModule_ == nullptr || idDet != lastIdDet_) {
+    auto iter = modules_.find(idDet);
+    if (iter == modules_.end()) iter = modules_.insert( make_pair(idDet, makeModuleInfo(stackedGeometry, stDetId)) ).first;
+    // N.B. Pointers to elements of an unordered_map stay valid when other elements are inserted.
+    lastIdDet_  = idDet;
+    lastModule_ = &(iter->second);
+  }
+  return *lastModule_;
+}
+
+//=== Get info about given module from the tracker geometry.
+
+ModuleInfo ModuleGeometryCache::makeModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
+
+  ModuleInfo mod;
+
+  // Get unique identifier of this module.
+  mod.idDet = stDetId();
+
+  // Get min & max (r,phi,z) coordinates of the centre of the two sensors containing this stub.
+  const GeomDetUnit* det0 = stackedGeometry->idToDetUnit( stDetId, 0 );
+  const GeomDetUnit* det1 = stackedGeometry->idToDetUnit( stDetId, 1 );
+  float R0 = det0->position().perp();
+  float R1 = det1->position().perp();
+  float PHI0 = det0->position().phi();
+  float PHI1 = det1->position().phi();
+  float Z0 = det0->position().z();
+  float Z1 = det1->position().z();
+  mod.minR   = std::min(R0,R1);
+  mod.maxR   = std::max(R0,R1);
+  mod.minPhi = std::min(PHI0,PHI1);
+  mod.maxPhi = std::max(PHI0,PHI1);
+  mod.minZ   = std::min(Z0,Z1);
+  mod.maxZ   = std::max(Z0,Z1);
+
+  // Note if module is PS or 2S, and whether in barrel or endcap.
+  mod.psModule = stackedGeometry->isPSModule(stDetId);
+  mod.barrel   = stDetId.isBarrel();
+
+  // Encode layer ID.
+  if (mod.barrel) {
+    mod.layerId = stDetId.iLayer(); // barrel layer 1-6 encoded as 1-6
+  } else {
+    mod.layerId = 10*stDetId.iSide() + stDetId.iDisk(); // endcap layer 1-5 encoded as 11-15 (endcap A) or 21-25 (endcapB)
+  }
+
+  // Note module ring in endcap
+  mod.endcapRing = mod.barrel  ?  0  :  stDetId.iRing();
+
+  // Get sensor strip or pixel pitch using innermost sensor of pair.
+  const PixelGeomDetUnit* unit = reinterpret_cast<const PixelGeomDetUnit*>(stackedGeometry->idToDetUnit(stDetId, 0));
+  const GeomDet* det = reinterpret_cast<const GeomDet*>(stackedGeometry->idToDet(stDetId, 0));
+  const PixelTopology& topo = unit->specificTopology();
+  const Bounds& bounds = det->surface().bounds();
+
+  std::pair<float, float> pitch = topo.pitch();
+  mod.stripPitch  = pitch.first; // Strip pitch (or pixel pitch along shortest axis)
+  mod.stripLength = pitch.second;  //  Strip length (or pixel pitch along longest axis)
+  mod.nStrips     = topo.nrows(); // No. of strips in sensor
+  mod.sensorWidth = bounds.width(); // Width of sensitive region of sensor (= stripPitch * nStrips).
+
+  mod.sigmaPerp = mod.stripPitch/sqrt(12.); // resolution perpendicular to strip (or to longest pixel axis)
+  mod.sigmaPar  = mod.stripLength/sqrt(12.); // resolution parallel to strip (or to longest pixel axis)
+
+  return mod;
+}
@@ -1,5 +1,6 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/StubTable.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 
@@ -71,20 +72,31 @@ bool Sector::insideEta( const Stub* stub ) const {
   // Lower edge of this eta region defined by line from (r,z) = (0,-beamWindowZ) to (chosenRofZ_, zOuterMin_).
   // Upper edge of this eta region defined by line from (r,z) = (0, beamWindowZ) to (chosenRofZ_, zOuterMax_).
 
-  bool inside = this->insideEtaRange(stub, zOuterMin_, zOuterMax_);
+  bool inside = this->insideEtaRange(stub->r(), stub->z(), stub->rErr(), stub->zErr(), zOuterMin_, zOuterMax_);
   return inside;
 }
 
+bool Sector::insideEta( const StubTable& stubs, unsigned int i ) const {
+  return this->insideEtaRange(stubs.r(i), stubs.z(i), stubs.rErr(i), stubs.zErr(i), zOuterMin_, zOuterMax_);
+}
 
 //=== Check if stub is within subsectors in eta that sector may be divided into.
 
 vector<bool> Sector::insideEtaSubSecs( const Stub* stub) const {
+  return this->insideEtaSubSecs(stub->r(), stub->z(), stub->rErr(), stub->zErr());
+}
+
+vector<bool> Sector::insideEtaSubSecs( const StubTable& stubs, unsigned int i ) const {
+  return this->insideEtaSubSecs(stubs.r(i), stubs.z(i), stubs.rErr(i), stubs.zErr(i));
+}
+
+vector<bool> Sector::insideEtaSubSecs( float r, float z, float rErr, float zErr ) const {
 
   vector<bool> insideVec;
 
   // Loop over subsectors.
   for (unsigned int i = 0; i < numSubSecsEta_; i++) {
-    bool inside = this->insideEtaRange(stub, zOuterMinSub_[i], zOuterMaxSub_[i]);
+    bool inside = this->insideEtaRange(r, z, rErr, zErr, zOuterMinSub_[i], zOuterMaxSub_[i]);
     insideVec.push_back(inside);
   }
 
@@ -93,7 +105,7 @@ vector<bool> Sector::insideEtaSubSecs( const Stub* stub) const {
 
 //=== Check if stub is within eta sector or subsector that is delimated by specified zTrk range.
 
-bool Sector::insideEtaRange( const Stub* stub, float zRangeMin, float zRangeMax) const {
+bool Sector::insideEtaRange( float r, float z, float rErr, float zErr, float zRangeMin, float zRangeMax) const {
   // Lower edge of this eta region defined by line from (r,z) = (0,-beamWindowZ) to (chosenRofZ_, zRangeMin).
   // Upper edge of this eta region defined by line from (r,z) = (0, beamWindowZ) to (chosenRofZ_, zRangeMax).
 
@@ -105,22 +117,22 @@ bool Sector::insideEtaRange( const Stub* stub, float zRangeMin, float zRangeMax)
     //--- Don't modify algorithm to allow for uncertainty in stub (r,z) coordinates caused by 2S module strip length?
 
     // Calculate z coordinate of lower edge of this eta region, evaluated at radius of stub.
-    zMin = ( zRangeMin * stub->r() - beamWindowZ_ * fabs(stub->r() - chosenRofZ_) ) / chosenRofZ_;
+    zMin = ( zRangeMin * r - beamWindowZ_ * fabs(r - chosenRofZ_) ) / chosenRofZ_;
     // Calculate z coordinate of upper edge of this eta region, evaluated at radius of stub.
-    zMax = ( zRangeMax * stub->r() + beamWindowZ_ * fabs(stub->r() - chosenRofZ_) ) / chosenRofZ_;
+    zMax = ( zRangeMax * r + beamWindowZ_ * fabs(r - chosenRofZ_) ) / chosenRofZ_;
 
     // zMin = ( zRangeMin * stub->r() - beamWindowZ_ * fabs(stub->r() - rOuterMin_) ) / rOuterMin_;
     // zMax = ( zRangeMax * stub->r() + beamWindowZ_ * fabs(stub->r() - rOuterMax_) ) / rOuterMax_;
 
-    inside = (stub->z() > zMin && stub->z() < zMax);
+    inside = (z > zMin && z < zMax);
 
   } else {
     //--- Do modify algorithm to allow for uncertainty in stub (r,z) coordinates caused by 2S module strip length?
 
-    float stubMinR = stub->r() - stub->rErr(); 
-    float stubMaxR = stub->r() + stub->rErr(); 
-    float stubMinZ = stub->z() - stub->zErr(); 
-    float stubMaxZ = stub->z() + stub->zErr(); 
+    float stubMinR = r - rErr; 
+    float stubMaxR = r + rErr; 
+    float stubMinZ = z - zErr; 
+    float stubMaxZ = z + zErr; 
 
     // Calculate z coordinate of lower edge of this eta region, evaluated at radius of stub.
     float rStubA = (zRangeMin + beamWindowZ_) >= 0 ? stubMinR : stubMaxR; // stub r coordinate uncertain (especially in endcap), so use one which gives most -ve zMin.
@@ -139,6 +151,14 @@ bool Sector::insideEtaRange( const Stub* stub, float zRangeMin, float zRangeMax)
 //=== Check if stub is inside this phi region.
 
 bool Sector::insidePhi( const Stub* stub ) const {
+  return this->insidePhi(stub->phi(), stub->r(), stub->rErr(), stub->dphi(), stub->dphiRes());
+}
+
+bool Sector::insidePhi( const StubTable& stubs, unsigned int i ) const {
+  return this->insidePhi(stubs.phi(i), stubs.r(i), stubs.rErr(i), stubs.dphi(i), stubs.dphiRes(i));
+}
+
+bool Sector::insidePhi( float phi, float r, float rErr, float dphi, float dphiRes ) const {
 
   // N.B. The logic here for preventing a stub being assigned to > 2 sectors seems overly agressive.
   // But attempts at improving it have failed ...
@@ -147,20 +167,22 @@ bool Sector::insidePhi( const Stub* stub ) const {
   bool okPhiTrk = true;
 
   if (useStubPhi_) {
-    float delPhi = reco::deltaPhi(stub->phi(), phiCentre_); // Phi difference between stub & sector in range -PI to +PI.
-    float tolerancePhi = stub->phiDiff(chosenRofPhi_, minPt_); // How much stub phi might differ from track phi because of track curvature.
+    float delPhi = reco::deltaPhi(phi, phiCentre_); // Phi difference between stub & sector in range -PI to +PI.
+    float tolerancePhi = Stub::phiDiff(r, chosenRofPhi_, minPt_, settings_->invPtToDphi()); // How much stub phi might differ from track phi because of track curvature.
     float outsidePhi = fabs(delPhi) - sectorHalfWidth_ - tolerancePhi; // If > 0, then stub is not compatible with being inside this sector. 
     if (outsidePhi > 0) okPhi = false;
   }
 
   if (useStubPhiTrk_) {
-    // Estimate either phi0 of track from stub info, or phi of the track at radius chosenRofPhi_.
-    float phiTrk = stub->trkPhiAtR( chosenRofPhi_ ).first; // N.B. This equals stub->beta() if chosenRofPhi_ = 0.
+    // Estimate either phi0 of track from stub info, or phi of the track at radius chosenRofPhi_,
+    // and its uncertainty due to 2S module strip length.
+    pair<float, float> phiTrkAndErr = Stub::trkPhiAtR(phi, r, rErr, dphi, chosenRofPhi_);
+    float phiTrk = phiTrkAndErr.first; // N.B. This equals stub->beta() if chosenRofPhi_ = 0.
     float delPhiTrk = reco::deltaPhi(phiTrk, phiCentre_); // Phi difference between stub & sector in range -PI to +PI.
     float tolerancePhiTrk = assumedPhiTrkRes_ * (2*sectorHalfWidth_); // Set tolerance equal to nominal resolution assumed in phiTrk
     if (calcPhiTrkRes_) {
       // Calculate uncertainty in phiTrk due to poor resolution in stub bend
-      float phiTrkRes = stub->trkPhiAtRres( chosenRofPhi_ );
+      float phiTrkRes = Stub::trkPhiAtRres(r, dphiRes, chosenRofPhi_);
       // Reduce tolerance if this is smaller than the nominal assumed resolution.
       tolerancePhiTrk = min(tolerancePhiTrk, phiTrkRes);
     }
@@ -168,7 +190,7 @@ bool Sector::insidePhi( const Stub* stub ) const {
 
     // Modify algorithm to allow for uncertainty due to 2S module strip length, if requested.
     if (handleStripsPhiSec_) {
-      float chosenStubPhiErr = stub->trkPhiAtR( chosenRofPhi_ ).second; // The "Err" here is uncertainty due to 2S strip length.
+      float chosenStubPhiErr = phiTrkAndErr.second; // The "Err" here is uncertainty due to 2S strip length.
       outsidePhiTrk -= chosenStubPhiErr;
     }
 
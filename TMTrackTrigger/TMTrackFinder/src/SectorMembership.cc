@@ -0,0 +1,91 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/SectorMembership.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Sector.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/StubTable.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+
+#include "FWCore/Utilities/interface/Exception.h"
+
+using namespace std;
+
+//=== Note which of the given (initialized) sectors each stub in the event is inside, replacing any previous contents.
+
+void SectorMembership::fill(const boost::numeric::ublas::matrix<Sector>& mSectors, const InputData& inputData) {
+
+  numPhiSectors_ = mSectors.size1();
+  numEtaRegions_ = mSectors.size2();
+  if (numPhiSectors_ > 64 || numEtaRegions_ > 64) throw cms::Exception("SectorMembership: Can't handle more than 64 phi sectors or eta regions: ")<<numPhiSectors_<<" "<<numEtaRegions_<<endl;
+
+  // Note the eta regions & phi sectors each stub is inside.
+  // The stubs output by the front-end electronics, which are most of them, are read from the contiguous arrays
+  // of the StubTable. The few remaining stubs (which failed the front-end cuts) are read from the Stub objects.
+
+  const vector<Stub>& vAllStubs = inputData.getAllStubs();
+  etaMask_.assign(vAllStubs.size(), 0);
+  phiMask_.assign(vAllStubs.size(), 0);
+
+  const StubTable& stubTable = inputData.getStubTable();
+  for (unsigned int i = 0; i < stubTable.size(); i++) {
+    this->setMasks(mSectors, stubTable.stub(i)->index(), stubTable, i);
+  }
+
+  for (const Stub& stub : vAllStubs) {
+    if (! stub.frontendPass()) this->setMasks(mSectors, stub.index(), &stub);
+  }
+
+  // Make the list of stubs inside each sector. (Reusing the memory of the previous event's lists).
+
+  sectorStubs_.resize(numPhiSectors_*numEtaRegions_);
+  for (vector<const Stub*>& stubs : sectorStubs_) stubs.clear();
+
+  for (const Stub* stub : inputData.getStubs()) {
+    const uint64_t etaMask = etaMask_[stub->index()];
+    const uint64_t phiMask = phiMask_[stub->index()];
+    if (etaMask == 0) continue;
+    for (unsigned int iPhiSec = 0; iPhiSec < numPhiSectors_; iPhiSec++) {
+      if ((phiMask >> iPhiSec) & 1) {
+        for (unsigned int iEtaReg = 0; iEtaReg < numEtaRegions_; iEtaReg++) {
+          if ((etaMask >> iEtaReg) & 1) sectorStubs_[iPhiSec*numEtaRegions_ + iEtaReg].push_back(stub);
+        }
+      }
+    }
+  }
+}
+
+//=== Note the eta regions & phi sectors that a stub is inside. The stub is given by the trailing arguments, which can
+//=== be anything accepted by Sector::insideEta() & Sector::insidePhi() (i.e. a Stub pointer, or a StubTable & entry).
+//=== N.B. Sector::insideEta() only depends on the eta region, and Sector::insidePhi() only on the phi sector,
+//=== so the sectors with iPhiSec = 0 & iEtaReg = 0 respectively can be used to represent them.
+
+template <typename... StubArgs>
+void SectorMembership::setMasks(const boost::numeric::ublas::matrix<Sector>& mSectors, unsigned int stubIndex, const StubArgs&... stubArgs) {
+  uint64_t etaMask = 0;
+  for (unsigned int iEtaReg = 0; iEtaReg < numEtaRegions_; iEtaReg++) {
+    if (mSectors(0, iEtaReg).insideEta(stubArgs...)) etaMask |= (uint64_t(1) << iEtaReg);
+  }
+  uint64_t phiMask = 0;
+  for (unsigned int iPhiSec = 0; iPhiSec < numPhiSectors_; iPhiSec++) {
+    if (mSectors(iPhiSec, 0).insidePhi(stubArgs...)) phiMask |= (uint64_t(1) << iPhiSec);
+  }
+  etaMask_[stubIndex] = etaMask;
+  phiMask_[stubIndex] = phiMask;
+}
+
+//=== Count number of stubs in given tracking particle which are inside this (phi,eta) sector;
+//=== or inside it if only the eta cuts are applied; or inside it if only the phi cuts are applied.
+
+void SectorMembership::numStubsInside(unsigned int iPhiSec, unsigned int iEtaReg, const TP& tp,
+                                      unsigned int& nStubsInsideEtaPhi, unsigned int& nStubsInsideEta,
+                                      unsigned int& nStubsInsidePhi) const
+{
+  nStubsInsideEtaPhi = 0;
+  nStubsInsideEta    = 0;
+  nStubsInsidePhi    = 0;
+  for (const Stub* stub : tp.assocStubs()) {
+    bool insidePhi = this->insidePhi(iPhiSec, stub);
+    bool insideEta = this->insideEta(iEtaReg, stub);
+    if (insidePhi && insideEta) nStubsInsideEtaPhi++;
+    if (insideEta)              nStubsInsideEta++;
+    if (insidePhi)              nStubsInsidePhi++;
+  }
+}
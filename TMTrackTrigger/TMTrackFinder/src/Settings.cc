@@ -175,6 +175,33 @@ Settings::Settings(const edm::ParameterSet& iConfig) :
   // tmtt_tf_analysis_cfg.py .
   writeOutEdmFile_        ( iConfig.getUntrackedParameter<bool>               ( "WriteOutEdmFile", true) ),
 
+  // Name of output snapshot file of stubs & tracking particles, if any (see EventSnapshot.h).
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside
+  // tmtt_tf_analysis_cfg.py .
+  snapshotFile_           ( iConfig.getUntrackedParameter<string>             ( "SnapshotFile", "") ),
+
+  // Name of output file of firmware test vectors, if any (see DemoTestVectorWriter.h).
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside
+  // tmtt_tf_analysis_cfg.py .
+  testVectorFile_         ( iConfig.getUntrackedParameter<string>             ( "TestVectorFile", "") ),
+
+  // Histogram time spent in each processing stage & sector?
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside
+  // tmtt_tf_analysis_cfg.py .
+  stageTiming_            ( iConfig.getUntrackedParameter<bool>               ( "StageTiming", false) ),
+
+  // Fill histograms in separate threads, max. number of events waiting to be histogrammed & number of threads.
+  // N.B. These parameters do not appear inside TMTrackProducer_Defaults_cfi.py . They are created inside
+  // tmtt_tf_analysis_cfg.py .
+  asyncHistos_            ( iConfig.getUntrackedParameter<bool>               ( "AsyncHistos", false) ),
+  asyncHistosQueueSize_   ( iConfig.getUntrackedParameter<unsigned int>       ( "AsyncHistosQueueSize", 2) ),
+  asyncHistosThreads_     ( iConfig.getUntrackedParameter<unsigned int>       ( "AsyncHistosThreads", 1) ),
+
+  // Families of histograms that should not be filled (or booked).
+  // N.B. This parameter does not appear inside TMTrackProducer_Defaults_cfi.py . It is created inside
+  // tmtt_tf_analysis_cfg.py .
+  histosDisabled_         ( iConfig.getUntrackedParameter<vector<string> >    ( "HistosDisabled", vector<string>()) ),
+
   // Bfield in Tesla. (Unknown at job initiation. Set to true value for each event
   bField_                 (0.)
 
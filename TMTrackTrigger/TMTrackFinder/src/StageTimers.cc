@@ -0,0 +1,113 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/StageTimers.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+
+#include <TH1F.h>
+#include <TProfile.h>
+
+#include <numeric>
+
+using namespace std;
+
+const char* StageTimers::stageNames_[StageTimers::NumStages] = {"InputDecoding", "Routing", "HTfill", "HTend", "RZfilters", "Fit", "DupRemoval", "Histogramming", "DemoOutput"};
+
+//=== Store cfg parameters.
+
+StageTimers::StageTimers(const Settings* settings) :
+  settings_(settings),
+  currentScope_(nullptr),
+  eventTime_(NumStages, 0.),
+  htTimeAtLastSector_(0.),
+  fitTimeAtLastSector_(0.)
+{
+  for (const string& fitterName : settings_->trackFitters()) eventFitTime_[fitterName] = 0.;
+}
+
+//=== Book histograms.
+
+void StageTimers::book() {
+  TFileDirectory inputDir = fs_->mkdir("Timing");
+
+  const unsigned int nSectors = settings_->numPhiSectors()*settings_->numEtaRegions();
+
+  // Time per event.
+  hisEventTime_  = inputDir.make<TH1F>("EventTime","; Time per event (ms); Events",500,0.,5000.);
+  profStageTime_ = inputDir.make<TProfile>("StageTime","; Stage; Time per event (ms)",NumStages,-0.5,NumStages-0.5);
+  for (unsigned int i = 0; i < NumStages; i++) {
+    profStageTime_->GetXaxis()->SetBinLabel(i+1, stageNames_[i]);
+    string name = string("StageTime_") + stageNames_[i];
+    hisStageTime_.push_back( inputDir.make<TH1F>(name.c_str(),"; Time per event (ms); Events",500,0.,1000.) );
+  }
+  for (const string& fitterName : settings_->trackFitters()) {
+    string name = "FitTime_" + fitterName;
+    hisFitterTime_[fitterName] = inputDir.make<TH1F>(name.c_str(),"; Time per event (ms); Events",500,0.,1000.);
+  }
+
+  // Time per sector.
+  hisSectorHTtime_             = inputDir.make<TH1F>("SectorHTtime","; Routing + HT + r-z filter time per sector (#mus); Sectors",1000,0.,20000.);
+  hisSectorFitTime_            = inputDir.make<TH1F>("SectorFitTime","; Fit + dup. removal time per sector (#mus); Sectors",1000,0.,20000.);
+  profSectorHTtimeVsSector_    = inputDir.make<TProfile>("SectorHTtimeVsSector","; Sector number = iPhiSec*numEtaRegions + iEtaReg; Routing + HT + r-z filter time (#mus)",nSectors,-0.5,nSectors-0.5);
+  profSectorFitTimeVsSector_   = inputDir.make<TProfile>("SectorFitTimeVsSector","; Sector number = iPhiSec*numEtaRegions + iEtaReg; Fit + dup. removal time (#mus)",nSectors,-0.5,nSectors-0.5);
+  profSectorHTtimeVsNumStubs_  = inputDir.make<TProfile>("SectorHTtimeVsNumStubs","; No. of stubs in sector; Routing + HT + r-z filter time (#mus)",50,-0.5,499.5);
+  profSectorFitTimeVsNumCands_ = inputDir.make<TProfile>("SectorFitTimeVsNumCands","; No. of track candidates in sector; Fit + dup. removal time (#mus)",50,-0.5,49.5);
+}
+
+//=== Reset the time counters at the start of each event.
+
+void StageTimers::startEvent() {
+  std::fill(eventTime_.begin(), eventTime_.end(), 0.);
+  for (auto& t : eventFitTime_) t.second = 0.;
+  htTimeAtLastSector_  = 0.;
+  fitTimeAtLastSector_ = 0.;
+}
+
+//=== Note that the per-sector processing is about to start, so time already spent in this event isn't
+//=== attributed to the first sector.
+
+void StageTimers::startSectors() {
+  htTimeAtLastSector_  = eventTime_[Routing] + eventTime_[HTfill] + eventTime_[HTend] + eventTime_[RZfilters];
+  fitTimeAtLastSector_ = eventTime_[Fit] + eventTime_[DupRemoval];
+}
+
+//=== Add time (in seconds) to the given stage, and optionally to the given fitter.
+
+void StageTimers::addTime(Stage stage, double sec, const string* fitterName) {
+  eventTime_[stage] += sec;
+  if (fitterName != nullptr) eventFitTime_[*fitterName] += sec;
+}
+
+//=== Histogram the time spent on routing, HT & r-z filters in a sector.
+
+void StageTimers::fillSectorHT(unsigned int iPhiSec, unsigned int iEtaReg, unsigned int nStubs) {
+  const double htTime = eventTime_[Routing] + eventTime_[HTfill] + eventTime_[HTend] + eventTime_[RZfilters];
+  const double usec = 1.e6*(htTime - htTimeAtLastSector_);
+  htTimeAtLastSector_ = htTime;
+
+  const unsigned int iSec = iPhiSec*settings_->numEtaRegions() + iEtaReg;
+  hisSectorHTtime_->Fill(usec);
+  profSectorHTtimeVsSector_->Fill(iSec, usec);
+  profSectorHTtimeVsNumStubs_->Fill(nStubs, usec);
+}
+
+//=== Histogram the time spent on track fitting & duplicate removal in a sector.
+
+void StageTimers::fillSectorFit(unsigned int iPhiSec, unsigned int iEtaReg, unsigned int nTrkCands) {
+  const double fitTime = eventTime_[Fit] + eventTime_[DupRemoval];
+  const double usec = 1.e6*(fitTime - fitTimeAtLastSector_);
+  fitTimeAtLastSector_ = fitTime;
+
+  const unsigned int iSec = iPhiSec*settings_->numEtaRegions() + iEtaReg;
+  hisSectorFitTime_->Fill(usec);
+  profSectorFitTimeVsSector_->Fill(iSec, usec);
+  profSectorFitTimeVsNumCands_->Fill(nTrkCands, usec);
+}
+
+//=== Histogram the time taken by each stage in this event.
+
+void StageTimers::endEvent() {
+  for (unsigned int i = 0; i < NumStages; i++) {
+    hisStageTime_[i]->Fill(1.e3*eventTime_[i]);
+    profStageTime_->Fill(i, 1.e3*eventTime_[i]);
+  }
+  for (const auto& t : eventFitTime_) hisFitterTime_[t.first]->Fill(1.e3*t.second);
+  hisEventTime_->Fill(1.e3*accumulate(eventTime_.begin(), eventTime_.end(), 0.));
+}
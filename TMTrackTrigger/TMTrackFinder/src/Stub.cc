@@ -6,6 +6,8 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/DataCorrection.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/ModuleGeometryCache.h"
 
 #include <iostream>
 
@@ -14,7 +16,7 @@ using namespace std;
 //=== Store useful info about this stub.
 
 Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* settings, 
-           const StackedTrackerGeometry*  stackedGeometry) : 
+           const StackedTrackerGeometry*  stackedGeometry, ModuleGeometryCache* moduleCache) : 
 //   TTStubRef(ttStubRef), 
   settings_(settings), 
   index_in_vStubs_(index_in_vStubs), 
@@ -38,7 +40,67 @@ Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* se
   StackedTrackerDetId stDetId = ttStubRef->getDetId();
 
   // Set info about the module this stub is in
-  this->setModuleInfo(stackedGeometry, stDetId);
+  this->setModuleInfo( moduleCache->module(stackedGeometry, stDetId) );
+
+  // Get the coordinates of the two clusters that make up this stub, measured in units of strip pitch, and measured
+  // in the local frame of the sensor. They have a granularity  of 0.5*pitch.
+  for (unsigned int iClus = 0; iClus <= 1; iClus++) { // Loop over two clusters in stub.  
+    localU_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().x();
+    localV_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().y();
+  }
+
+  // Get stub bend (i.e. displacement between two hits in stub in units of strip pitch).
+  float bend = ttStubRef->getTriggerBend();
+  if (stDetId.isEndcap() && pos.z() > 0) bend *= -1;
+
+  // Set the stub info derived from this raw bend, which is available inside front-end chip.
+  this->setDerivedInfo(bend);
+}
+
+//=== Store useful info about this stub, taken from a record in a snapshot file.
+
+Stub::Stub(const SnapshotStub& snapStub, unsigned int index_in_vStubs, const Settings* settings) : 
+  settings_(settings), 
+  index_in_vStubs_(index_in_vStubs), 
+  phi_(snapStub.phi),
+  r_(snapStub.r),
+  z_(snapStub.z),
+  idDet_(snapStub.idDet),
+  moduleMinR_(snapStub.moduleMinR),
+  moduleMaxR_(snapStub.moduleMaxR),
+  moduleMinPhi_(snapStub.moduleMinPhi),
+  moduleMaxPhi_(snapStub.moduleMaxPhi),
+  moduleMinZ_(snapStub.moduleMinZ),
+  moduleMaxZ_(snapStub.moduleMaxZ),
+  psModule_(snapStub.psModule),
+  layerId_(snapStub.layerId),
+  endcapRing_(snapStub.endcapRing),
+  barrel_(snapStub.barrel),
+  stripPitch_(snapStub.stripPitch),
+  stripLength_(snapStub.stripLength),
+  nStrips_(snapStub.nStrips),
+  sensorWidth_(snapStub.sensorWidth),
+  assocTP_(nullptr),
+  digitalStub_(settings),
+  digitizedForGPinput_(false), // notes that stub has not yet been digitized for GP input.
+  digitizedForHTinput_(false)  // notes that stub has not yet been digitized for HT input.
+{
+  for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+    localU_cluster_[iClus]   = snapStub.localU_cluster[iClus];
+    localV_cluster_[iClus]   = snapStub.localV_cluster[iClus];
+    assocTPofCluster_[iClus] = nullptr;
+  }
+
+  sigmaPerp_ = stripPitch_/sqrt(12.); // resolution perpendicular to strip (or to longest pixel axis)
+  sigmaPar_  = stripLength_/sqrt(12.); // resolution parallel to strip (or to longest pixel axis)
+
+  this->setDerivedInfo(snapStub.bendInFrontend);
+}
+
+//=== Set stub quantities derived from the module info and from the bend in the front-end chip.
+//=== These depend on the configuration parameters, so are recalculated even when reading a snapshot file.
+
+void Stub::setDerivedInfo(float bendInFrontend) {
 
   // Uncertainty in stub coordinates due to strip length in case of 2S modules.
   rErr_ = 0.;
@@ -50,31 +112,22 @@ Stub::Stub(TTStubRef ttStubRef, unsigned int index_in_vStubs, const Settings* se
     rErr_ = 0.5*stripLength_; 
   }
 
-  // Get the coordinates of the two clusters that make up this stub, measured in units of strip pitch, and measured
-  // in the local frame of the sensor. They have a granularity  of 0.5*pitch.
-  for (unsigned int iClus = 0; iClus <= 1; iClus++) { // Loop over two clusters in stub.  
-    localU_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().x();
-    localV_cluster_[iClus] = ttStubP->getClusterRef(iClus)->findAverageLocalCoordinates().y();
-  }
-
   // Get location of stub in module in units of strip number (or pixel number along finest granularity axis).
   // Range from 0 to (nStrips - 1) inclusive.
   // N.B. Since iphi is integer, this degrades the granularity by a factor 2. This seems silly, but track fit wants it.
   iphi_ = localU_cluster_[0]; // granularity 1*strip (unclear why we want to degrade it ...)
 
-  // Get stub bend (i.e. displacement between two hits in stub in units of strip pitch).
-  float bend = ttStubRef->getTriggerBend();
-  if (stDetId.isEndcap() && pos.z() > 0) bend *= -1;
-  // Note this raw bend, which will be available inside front-end chip.
+  // Note the raw bend, which will be available inside front-end chip.
+  float bend = bendInFrontend;
   bendInFrontend_ = bend;
 
   // Degrade stub bend resolution if required.
   float degradedBend;         // degraded bend
   bool rejectStub;            // indicates if bend is outside window assumed in DataCorrection.h
   unsigned int numMergedBend; // Number of bend values merged into the single degraded one.
-  this->degradeResolution(bend, stDetId,
+  this->degradeResolution(bend,
 			  degradedBend, rejectStub, numMergedBend);
-  if (settings->bendResReduced()) {
+  if (settings_->bendResReduced()) {
     bend = degradedBend;
     numMergedBend_ = numMergedBend;
   } else {
@@ -255,16 +308,16 @@ void Stub::reset_digitize() {
 //=== Also return boolean indicating if stub bend was outside assumed window, so stub should be rejected
 //=== and return an integer indicating how many values of bend are merged into this single one.
 
-void Stub::degradeResolution(float  bend, const  StackedTrackerDetId& stDetId,
+void Stub::degradeResolution(float  bend,
 	float& degradedBend, bool& reject, unsigned int& num) const
 {
   if (barrel_)
   {
-    unsigned int layer = stDetId.iLayer();
+    unsigned int layer = layerId_; // barrel layer 1-6
     DataCorrection::ConvertBarrelBend( bend, layer,
 				       degradedBend, reject, num);
   } else {
-    unsigned int ring = stDetId.iRing();
+    unsigned int ring = endcapRing_;
     DataCorrection::ConvertEndcapBend( bend, ring,
 				       degradedBend, reject, num);
   }
@@ -388,14 +441,40 @@ void Stub::fillTruth(const map<edm::Ptr< TrackingParticle >, const TP* >& transl
   */
 }
 
+//=== Note which tracking particle(s), if any, produced this stub, using the truth links stored in a snapshot file.
+//=== The TP indices in the snapshot refer to the TPs of the same event, which must be passed as 3rd argument.
+
+void Stub::fillTruth(const SnapshotStub& snapStub, const uint32_t* snapLinks, const vector<TP>& vTPs) {
+
+  assocTP_ = (snapStub.assocTP != snapshotNoTP)  ?  &(vTPs.at(snapStub.assocTP))  :  nullptr;
+
+  // Fill assocTPs_ info. If the snapshot was written with StubMatchStrict = False, then all TPs contributing to either 
+  // cluster are stored, from which the strict definition can also be obtained. (The opposite is checked by InputData).
+
+  if (settings_->stubMatchStrict()) {
+    if (assocTP_ != nullptr) assocTPs_.insert(assocTP_);
+  } else {
+    for (unsigned int i = snapStub.firstLink; i < snapStub.firstLink + snapStub.numLinks; i++) {
+      assocTPs_.insert( &(vTPs.at(snapLinks[i])) );
+    }
+  }
+
+  //--- Also note which tracking particles produced the two clusters that make up the stub
+
+  for (unsigned int iClus = 0; iClus <= 1; iClus++) {
+    int32_t iTP = snapStub.assocTPofCluster[iClus];
+    assocTPofCluster_[iClus] = (iTP != snapshotNoTP)  ?  &(vTPs.at(iTP))  :  nullptr;
+  }
+}
+
 //=== Estimated phi angle at which track crosses a given radius rad, based on stub bend info. Also estimate uncertainty on this angle due to endcap 2S module strip length.
 //=== N.B. This is identical to Stub::beta() if rad=0.
 
-pair <float, float> Stub::trkPhiAtR(float rad) const { 
-  float rStubMax = r_ + rErr_; // Uncertainty in radial stub coordinate due to strip length.
-  float rStubMin = r_ - rErr_;
-  float trkPhi1 = (phi_ + dphi()*(1. - rad/rStubMin));
-  float trkPhi2 = (phi_ + dphi()*(1. - rad/rStubMax));
+pair <float, float> Stub::trkPhiAtR(float phi, float r, float rErr, float dphi, float rad) { 
+  float rStubMax = r + rErr; // Uncertainty in radial stub coordinate due to strip length.
+  float rStubMin = r - rErr;
+  float trkPhi1 = (phi + dphi*(1. - rad/rStubMin));
+  float trkPhi2 = (phi + dphi*(1. - rad/rStubMax));
   float trkPhi    = 0.5*    (trkPhi1 + trkPhi2);
   float errTrkPhi = 0.5*fabs(trkPhi1 - trkPhi2); 
   return pair<float, float>(trkPhi, errTrkPhi);
@@ -440,55 +519,22 @@ unsigned int Stub::layerIdReduced() const {
 
 //=== Set info about the module that this stub is in.
 
-void Stub::setModuleInfo(const StackedTrackerGeometry* stackedGeometry, const StackedTrackerDetId& stDetId) {
-
-  // Get unique identifier of this module.
-  idDet_ = stDetId();
-
-  // Get min & max (r,phi,z) coordinates of the centre of the two sensors containing this stub.
-  const GeomDetUnit* det0 = stackedGeometry->idToDetUnit( stDetId, 0 );
-  const GeomDetUnit* det1 = stackedGeometry->idToDetUnit( stDetId, 1 );
-  float R0 = det0->position().perp();
-  float R1 = det1->position().perp();
-  float PHI0 = det0->position().phi();
-  float PHI1 = det1->position().phi();
-  float Z0 = det0->position().z();
-  float Z1 = det1->position().z();
-  moduleMinR_   = std::min(R0,R1);
-  moduleMaxR_   = std::max(R0,R1);
-  moduleMinPhi_ = std::min(PHI0,PHI1);
-  moduleMaxPhi_ = std::max(PHI0,PHI1);
-  moduleMinZ_   = std::min(Z0,Z1);
-  moduleMaxZ_   = std::max(Z0,Z1);
-
-  // Note if module is PS or 2S, and whether in barrel or endcap.
-  psModule_   = stackedGeometry->isPSModule(stDetId);
-  barrel_     = stDetId.isBarrel();
-
-  //  cout<<"DEBUG STUB "<<barrel_<<" "<<psModule_<<"  sep(r,z)=( "<<moduleMaxR_ - moduleMinR_<<" , "<<moduleMaxZ_ - moduleMinZ_<<" )    stub(r,z)=( "<<0.5*(moduleMaxR_ + moduleMinR_) - r_<<" , "<<0.5*(moduleMaxZ_ + moduleMinZ_) - z_<<" )"<<endl;
-
-  // Encode layer ID.
-  if (barrel_) {
-    layerId_ = stDetId.iLayer(); // barrel layer 1-6 encoded as 1-6
-  } else {
-    layerId_ = 10*stDetId.iSide() + stDetId.iDisk(); // endcap layer 1-5 encoded as 11-15 (endcap A) or 21-25 (endcapB)
-  }
-
-  // Note module ring in endcap
-  endcapRing_ = barrel_  ?  0  :  stDetId.iRing();
-
-  // Get sensor strip or pixel pitch using innermost sensor of pair.
-  const PixelGeomDetUnit* unit = reinterpret_cast<const PixelGeomDetUnit*>(stackedGeometry->idToDetUnit(stDetId, 0));
-  const GeomDet* det = reinterpret_cast<const GeomDet*>(stackedGeometry->idToDet(stDetId, 0));
-  const PixelTopology& topo = unit->specificTopology();
-  const Bounds& bounds = det->surface().bounds();
-
-  std::pair<float, float> pitch = topo.pitch();
-  stripPitch_ = pitch.first; // Strip pitch (or pixel pitch along shortest axis)
-  stripLength_ = pitch.second;  //  Strip length (or pixel pitch along longest axis)
-  nStrips_ = topo.nrows(); // No. of strips in sensor
-  sensorWidth_ = bounds.width(); // Width of sensitive region of sensor (= stripPitch * nStrips).
-
-  sigmaPerp_ = stripPitch_/sqrt(12.); // resolution perpendicular to strip (or to longest pixel axis)
-  sigmaPar_  = stripLength_/sqrt(12.); // resolution parallel to strip (or to longest pixel axis)
+void Stub::setModuleInfo(const ModuleInfo& mod) {
+  idDet_        = mod.idDet;
+  moduleMinR_   = mod.minR;
+  moduleMaxR_   = mod.maxR;
+  moduleMinPhi_ = mod.minPhi;
+  moduleMaxPhi_ = mod.maxPhi;
+  moduleMinZ_   = mod.minZ;
+  moduleMaxZ_   = mod.maxZ;
+  psModule_     = mod.psModule;
+  barrel_       = mod.barrel;
+  layerId_      = mod.layerId;
+  endcapRing_   = mod.endcapRing;
+  stripPitch_   = mod.stripPitch;
+  stripLength_  = mod.stripLength;
+  nStrips_      = mod.nStrips;
+  sensorWidth_  = mod.sensorWidth;
+  sigmaPerp_    = mod.sigmaPerp;
+  sigmaPar_     = mod.sigmaPar;
 }
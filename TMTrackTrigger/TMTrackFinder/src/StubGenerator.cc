@@ -0,0 +1,383 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/StubGenerator.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
+
+#include "DataFormats/Math/interface/deltaPhi.h"
+#include "FWCore/Utilities/interface/Exception.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+  // Simplified tracker geometry. Barrel layers 1-3 & endcap rings 1-9 contain PS modules; the rest 2S modules.
+  const unsigned int numBarrelLayers = 6;
+  const unsigned int numEndcapDisks  = 5;
+  const unsigned int numPSrings      = 9;
+  const unsigned int numRings        = 15;
+  const unsigned int numPSlayers     = 3;
+
+  const float barrelRadius    [numBarrelLayers] = {22.5, 35.4, 50.5, 68.4, 88.3, 108.0};
+  const float barrelSeparation[numBarrelLayers] = {0.26, 0.16, 0.16, 0.18, 0.18, 0.18};
+  const float barrelHalfLength                  = 117.0;
+
+  const float diskZ[numEndcapDisks] = {131.2, 155.0, 185.3, 221.6, 265.0};
+  const float diskInnerRadius       = 23.0;
+  const float diskSeparationPS      = 0.20;
+  const float diskSeparation2S      = 0.40;
+
+  const float twoPi = 2.*M_PI;
+
+  // Particle mass (GeV) from PDG ID.
+  float pdgMass(int pdgId) {
+    switch (abs(pdgId)) {
+    case   11: return 0.000511;
+    case   13: return 0.10566;
+    case  211: return 0.13957;
+    case  321: return 0.49368;
+    case 2212: return 0.93827;
+    default:   return 0.13957;
+    }
+  }
+}
+
+//=== Read generator options.
+
+StubGenerator::StubGenerator(const edm::ParameterSet& cfg, const Settings* settings) :
+  settings_(settings),
+  rng_                 ( cfg.getParameter<unsigned int>("Seed") ),
+  numSignalTracks_     ( cfg.getParameter<unsigned int>("NumSignalTracks") ),
+  signalPdgId_         ( cfg.getParameter<int>         ("SignalPdgId") ),
+  signalMinPt_         ( cfg.getParameter<double>      ("SignalMinPt") ),
+  signalMaxPt_         ( cfg.getParameter<double>      ("SignalMaxPt") ),
+  signalD0Sigma_       ( cfg.getParameter<double>      ("SignalD0Sigma") ),
+  pileUp_              ( cfg.getParameter<double>      ("PileUp") ),
+  tracksPerInteraction_( cfg.getParameter<double>      ("TracksPerInteraction") ),
+  pileUpMinPt_         ( cfg.getParameter<double>      ("PileUpMinPt") ),
+  pileUpPtSlope_       ( cfg.getParameter<double>      ("PileUpPtSlope") ),
+  pileUpD0Sigma_       ( cfg.getParameter<double>      ("PileUpD0Sigma") ),
+  maxAbsEta_           ( cfg.getParameter<double>      ("MaxAbsEta") ),
+  beamSpotSigmaZ_      ( cfg.getParameter<double>      ("BeamSpotSigmaZ") ),
+  bendResolution_      ( cfg.getParameter<double>      ("BendResolution") ),
+  maxBend_             ( cfg.getParameter<double>      ("MaxBend") ),
+  stubEfficiency_      ( cfg.getParameter<double>      ("StubEfficiency") )
+{
+  if (signalMinPt_ <= 0. || signalMaxPt_ < signalMinPt_ || pileUpMinPt_ <= 0.) throw cms::Exception("StubGenerator: Invalid Pt range in cfg")<<endl;
+
+  modulePS_.ps          = true;
+  modulePS_.pitch       = cfg.getParameter<double>      ("StripPitchPS");
+  modulePS_.stripLength = cfg.getParameter<double>      ("StripLengthPS");
+  modulePS_.nStrips     = cfg.getParameter<unsigned int>("NumStripsPS");
+  modulePS_.nRows       = cfg.getParameter<unsigned int>("NumRowsPS");
+
+  module2S_.ps          = false;
+  module2S_.pitch       = cfg.getParameter<double>      ("StripPitch2S");
+  module2S_.stripLength = cfg.getParameter<double>      ("StripLength2S");
+  module2S_.nStrips     = cfg.getParameter<unsigned int>("NumStrips2S");
+  module2S_.nRows       = cfg.getParameter<unsigned int>("NumRows2S");
+}
+
+//=== Generate the TPs, stubs & stub-to-TP links of a new event.
+
+void StubGenerator::generate(vector<SnapshotTP>& vTPs, vector<SnapshotStub>& vStubs, vector<uint32_t>& vLinks) {
+
+  vTPs.clear();
+  vStubs.clear();
+  vLinks.clear();
+
+  normal_distribution<float>   gausZ(0., beamSpotSigmaZ_);
+  poisson_distribution<int>    poisPU(pileUp_);
+  poisson_distribution<int>    poisTracks(tracksPerInteraction_);
+
+  // Signal tracks come from the physics collision, followed by the pileup interactions.
+  vector<Particle> particles;
+  const float z0Signal = gausZ(rng_);
+  for (unsigned int i = 0; i < numSignalTracks_; i++) particles.push_back( this->generateParticle(true, z0Signal) );
+
+  const int nPU = (pileUp_ > 0.) ? poisPU(rng_) : 0;
+  for (int iPU = 0; iPU < nPU; iPU++) {
+    const float z0 = gausZ(rng_);
+    const int nTracks = (tracksPerInteraction_ > 0.) ? poisTracks(rng_) : 0;
+    for (int i = 0; i < nTracks; i++) particles.push_back( this->generateParticle(false, z0) );
+  }
+
+  for (const Particle& p : particles) {
+
+    // Only particles passing the same loose cuts as InputData are stored as TPs.
+    int32_t iTP = snapshotNoTP;
+    if (this->tpUse(p)) {
+      iTP = vTPs.size();
+      const float theta = 2.*atan(exp(-p.eta));
+      SnapshotTP rec;
+      memset(&rec, 0, sizeof(rec));
+      rec.pdgId            = p.pdgId;
+      rec.charge           = p.charge;
+      rec.mass             = p.mass;
+      rec.pt               = p.pt;
+      rec.eta              = p.eta;
+      rec.theta            = theta;
+      rec.phi0             = p.phi0;
+      rec.vx               =  p.d0*sin(p.phi0);
+      rec.vy               = -p.d0*cos(p.phi0);
+      rec.vz               = p.z0;
+      rec.inTimeBx         = 1;
+      rec.physicsCollision = p.physicsCollision;
+      rec.useForEff        = this->tpUseForEff(p);
+      vTPs.push_back(rec);
+    }
+
+    this->makeStubs(p, iTP, vStubs, vLinks);
+  }
+}
+
+//=== Generate a particle from the signal or pileup spectrum.
+
+StubGenerator::Particle StubGenerator::generateParticle(bool physicsCollision, float z0) {
+
+  uniform_real_distribution<float> flat(0., 1.);
+  normal_distribution<float>       gaus(0., 1.);
+
+  Particle p;
+  p.physicsCollision = physicsCollision;
+  p.charge           = (flat(rng_) < 0.5) ? -1 : 1;
+  p.eta              = maxAbsEta_*(2.*flat(rng_) - 1.);
+  p.phi0             = reco::deltaPhi(twoPi*flat(rng_), 0.);
+  p.z0               = z0;
+
+  int absPdgId;
+  if (physicsCollision) {
+    // Flat in 1/Pt, so as to populate the q/Pt axis of the HT array uniformly.
+    const float invPt = 1./signalMaxPt_ + (1./signalMinPt_ - 1./signalMaxPt_)*flat(rng_);
+    p.pt     = 1./invPt;
+    p.d0     = signalD0Sigma_*gaus(rng_);
+    absPdgId = abs(signalPdgId_);
+  } else {
+    // Exponentially falling spectrum.
+    p.pt     = pileUpMinPt_ - pileUpPtSlope_*log(1. - flat(rng_));
+    p.d0     = pileUpD0Sigma_*gaus(rng_);
+    absPdgId = 211;
+  }
+
+  // Negatively charged leptons have positive PDG ID.
+  const bool lepton = (absPdgId == 11 || absPdgId == 13);
+  p.pdgId = (lepton ? -p.charge : p.charge)*absPdgId;
+  p.mass  = pdgMass(absPdgId);
+
+  return p;
+}
+
+//=== Produce the stubs from the given particle in each barrel layer & endcap disk it crosses.
+
+void StubGenerator::makeStubs(const Particle& p, int32_t iTP, vector<SnapshotStub>& vStubs, vector<uint32_t>& vLinks) {
+
+  uniform_real_distribution<float> flat(0., 1.);
+
+  const unsigned int nLayers = numBarrelLayers + numEndcapDisks;
+  for (unsigned int i = 0; i < nLayers; i++) {
+
+    SnapshotStub stub;
+    memset(&stub, 0, sizeof(stub));
+
+    bool ok = (i < numBarrelLayers)  ?  this->barrelStub(p, i + 1, stub)  :  this->endcapStub(p, i + 1 - numBarrelLayers, stub);
+
+    if (ok && stubEfficiency_ < 1.) ok = (flat(rng_) < stubEfficiency_);
+
+    if (ok) {
+      stub.assocTP             = iTP;
+      stub.assocTPofCluster[0] = iTP;
+      stub.assocTPofCluster[1] = iTP;
+      stub.firstLink           = vLinks.size();
+      if (iTP != snapshotNoTP) vLinks.push_back(iTP);
+      stub.numLinks            = vLinks.size() - stub.firstLink;
+      vStubs.push_back(stub);
+    }
+  }
+}
+
+//=== Fill stub in given barrel layer (1-6), returning false if the particle misses it.
+
+bool StubGenerator::barrelStub(const Particle& p, unsigned int iLayer, SnapshotStub& stub) {
+
+  const ModuleType& mod = (iLayer <= numPSlayers) ? modulePS_ : module2S_;
+  const float r   = barrelRadius[iLayer - 1];
+  const float sep = barrelSeparation[iLayer - 1];
+
+  const float phi = this->phiAtR(p, r);
+  if (phi > 900.) return false;
+
+  // Path length in r-phi to reach this radius, used to find z.
+  const float halfInvR = settings_->invPtToDphi()*p.charge/p.pt; // 1/(2*radius of curvature)
+  const float s = (fabs(halfInvR*r) > 1.e-6)  ?  asin(halfInvR*r)/halfInvR  :  r;
+  const float z = p.z0 + s*sinh(p.eta);
+  if (fabs(z) >= barrelHalfLength) return false;
+
+  const float bend = this->smearedBend(p, r, sep, mod.pitch);
+  if (fabs(bend) > maxBend_) return false;
+
+  // Locate module & strip hit.
+  const float        moduleLength = mod.nRows*mod.stripLength;
+  const float        moduleWidth  = mod.nStrips*mod.pitch;
+  const unsigned int nPhiMods     = ceil(twoPi*r/moduleWidth);
+  const float        phiModWidth  = twoPi/nPhiMods;
+  const unsigned int iPhiMod      = min(nPhiMods - 1, (unsigned int)((phi + M_PI)/phiModWidth));
+  const unsigned int iZmod        = (z + barrelHalfLength)/moduleLength;
+  const float        moduleMinPhi = -M_PI + iPhiMod*phiModWidth;
+  const float        moduleMinZ   = -barrelHalfLength + iZmod*moduleLength;
+
+  // Coordinates quantized to half a strip in phi, and to the strip centre in z.
+  const float        localU = min(float(mod.nStrips) - 0.5f, float(floor(2.*(phi - moduleMinPhi)*r/mod.pitch)/2.));
+  const unsigned int localV = min(mod.nRows - 1, (unsigned int)((z - moduleMinZ)/mod.stripLength));
+
+  stub.phi             = reco::deltaPhi(moduleMinPhi + (localU + 0.25)*mod.pitch/r, 0.);
+  stub.r               = r;
+  stub.z               = moduleMinZ + (localV + 0.5)*mod.stripLength;
+  stub.bendInFrontend  = bend;
+  stub.localU_cluster[0] = localU;
+  stub.localU_cluster[1] = localU;
+  stub.localV_cluster[0] = localV;
+  stub.localV_cluster[1] = localV;
+  stub.idDet           = iLayer*1000000 + iZmod*1000 + iPhiMod;
+  stub.moduleMinR      = r;
+  stub.moduleMaxR      = r + sep;
+  stub.moduleMinPhi    = moduleMinPhi;
+  stub.moduleMaxPhi    = reco::deltaPhi(moduleMinPhi + phiModWidth, 0.);
+  stub.moduleMinZ      = moduleMinZ;
+  stub.moduleMaxZ      = moduleMinZ + moduleLength;
+  stub.stripPitch      = mod.pitch;
+  stub.stripLength     = mod.stripLength;
+  stub.sensorWidth     = moduleWidth;
+  stub.nStrips         = mod.nStrips;
+  stub.layerId         = iLayer;
+  stub.endcapRing      = 0;
+  stub.psModule        = mod.ps;
+  stub.barrel          = true;
+
+  return true;
+}
+
+//=== Fill stub in given endcap disk (1-5) on the side of the tracker the particle goes to, returning false if it misses it.
+
+bool StubGenerator::endcapStub(const Particle& p, unsigned int iDisk, SnapshotStub& stub) {
+
+  const float zDisk = (p.eta > 0) ? diskZ[iDisk - 1] : -diskZ[iDisk - 1];
+  const float sinhEta = sinh(p.eta);
+  if (fabs(sinhEta) < 1.e-6) return false;
+
+  // Path length in r-phi to reach this disk, and hence radius at which it is crossed.
+  const float halfInvR = settings_->invPtToDphi()*p.charge/p.pt; // 1/(2*radius of curvature)
+  const float s = (zDisk - p.z0)/sinhEta;
+  if (s <= 0.) return false;
+  if (fabs(halfInvR*s) > M_PI/2.) return false; // Particle curls up before reaching disk.
+  const float r = (fabs(halfInvR) > 1.e-9)  ?  sin(halfInvR*s)/halfInvR  :  s;
+  if (r < diskInnerRadius || r >= settings_->trackerOuterRadius()) return false;
+
+  // Locate ring. PS rings are followed by 2S rings, each containing modules of constant radial length.
+  const float psLength = numPSrings*modulePS_.nRows*modulePS_.stripLength;
+  unsigned int ring;
+  float ringMinR;
+  if (r < diskInnerRadius + psLength) {
+    ring     = 1 + (unsigned int)((r - diskInnerRadius)/(modulePS_.nRows*modulePS_.stripLength));
+    ringMinR = diskInnerRadius + (ring - 1)*modulePS_.nRows*modulePS_.stripLength;
+  } else {
+    ring     = numPSrings + 1 + (unsigned int)((r - diskInnerRadius - psLength)/(module2S_.nRows*module2S_.stripLength));
+    ringMinR = diskInnerRadius + psLength + (ring - numPSrings - 1)*module2S_.nRows*module2S_.stripLength;
+  }
+  if (ring > numRings) return false;
+
+  const ModuleType& mod = (ring <= numPSrings) ? modulePS_ : module2S_;
+  const float sep = mod.ps ? diskSeparationPS : diskSeparation2S;
+
+  const float phi = this->phiAtR(p, r);
+  if (phi > 900.) return false;
+
+  // Difference in radius of points where particle crosses the two sensors.
+  const float deltaR = sep*r/fabs(zDisk);
+  const float bend = this->smearedBend(p, r, deltaR, mod.pitch);
+  if (fabs(bend) > maxBend_) return false;
+
+  // Locate module & strip hit.
+  const float        moduleLength = mod.nRows*mod.stripLength;
+  const float        moduleWidth  = mod.nStrips*mod.pitch;
+  const float        rRing        = ringMinR + 0.5*moduleLength;
+  const unsigned int nPhiMods     = ceil(twoPi*rRing/moduleWidth);
+  const float        phiModWidth  = twoPi/nPhiMods;
+  const unsigned int iPhiMod      = min(nPhiMods - 1, (unsigned int)((phi + M_PI)/phiModWidth));
+  const float        moduleMinPhi = -M_PI + iPhiMod*phiModWidth;
+
+  // Coordinates quantized to half a strip in phi, and to the strip centre in r.
+  const float        localU = min(float(mod.nStrips) - 0.5f, float(floor(2.*(phi - moduleMinPhi)*rRing/mod.pitch)/2.));
+  const unsigned int localV = min(mod.nRows - 1, (unsigned int)((r - ringMinR)/mod.stripLength));
+
+  const unsigned int iSide   = (zDisk > 0) ? 2 : 1;
+  const unsigned int layerId = 10*iSide + iDisk;
+
+  stub.phi             = reco::deltaPhi(moduleMinPhi + (localU + 0.25)*mod.pitch/rRing, 0.);
+  stub.r               = ringMinR + (localV + 0.5)*mod.stripLength;
+  stub.z               = zDisk;
+  stub.bendInFrontend  = bend;
+  stub.localU_cluster[0] = localU;
+  stub.localU_cluster[1] = localU;
+  stub.localV_cluster[0] = localV;
+  stub.localV_cluster[1] = localV;
+  stub.idDet           = layerId*1000000 + ring*1000 + iPhiMod;
+  stub.moduleMinR      = ringMinR;
+  stub.moduleMaxR      = ringMinR + moduleLength;
+  stub.moduleMinPhi    = moduleMinPhi;
+  stub.moduleMaxPhi    = reco::deltaPhi(moduleMinPhi + phiModWidth, 0.);
+  stub.moduleMinZ      = (zDisk > 0) ? zDisk : zDisk - sep;
+  stub.moduleMaxZ      = (zDisk > 0) ? zDisk + sep : zDisk;
+  stub.stripPitch      = mod.pitch;
+  stub.stripLength     = mod.stripLength;
+  stub.sensorWidth     = moduleWidth;
+  stub.nStrips         = mod.nStrips;
+  stub.layerId         = layerId;
+  stub.endcapRing      = ring;
+  stub.psModule        = mod.ps;
+  stub.barrel          = false;
+
+  return true;
+}
+
+//=== Phi of particle trajectory at given radius (or 999 if it never reaches this radius).
+
+float StubGenerator::phiAtR(const Particle& p, float r) const {
+  const float sinAlpha = r*settings_->invPtToDphi()*p.charge/p.pt;
+  if (fabs(sinAlpha) >= 1.) return 999.;
+  // Same convention as TP::trkPhiAtR(), with a first order correction for the impact parameter.
+  return reco::deltaPhi(p.phi0 - asin(sinAlpha) - p.d0/r, 0.);
+}
+
+//=== Smeared stub bend, in the convention of Stub::bendInFrontend() (sign already corrected in endcap),
+//=== rounded to half strips.
+
+float StubGenerator::smearedBend(const Particle& p, float r, float deltaR, float pitch) {
+  normal_distribution<float> gaus(0., 1.);
+  // Inverse of Stub::qOverPt() = bend * pitch/(deltaR * r * invPtToDphi).
+  float bend = (p.charge/p.pt)*r*settings_->invPtToDphi()*deltaR/pitch;
+  if (bendResolution_ > 0.) bend += bendResolution_*gaus(rng_);
+  return floor(2.*bend + 0.5)/2.;
+}
+
+//=== Check if TP would be kept by InputData (same cuts as TP::fillUse()).
+
+bool StubGenerator::tpUse(const Particle& p) const {
+  return (p.pt          > min(2.0, settings_->genMinPt())     &&
+	  fabs(p.eta)   < max(3.5, settings_->genMaxAbsEta()) &&
+	  fabs(p.d0)    < max(10.0, settings_->genMaxVertR()) &&
+	  fabs(p.z0)    < max(35.0, settings_->genMaxVertZ()));
+}
+
+//=== Check if TP can be used for efficiency measurement (same cuts as TP::fillUseForEff()).
+
+bool StubGenerator::tpUseForEff(const Particle& p) const {
+  const vector<int> pdgIds = settings_->genPdgIds();
+  return (this->tpUse(p)                                     &&
+	  p.physicsCollision                                 &&
+	  p.pt          > settings_->genMinPt()              &&
+	  fabs(p.eta)   < settings_->genMaxAbsEta()          &&
+	  fabs(p.d0)    < settings_->genMaxVertR()           &&
+	  fabs(p.z0)    < settings_->genMaxVertZ()           &&
+	  find(pdgIds.begin(), pdgIds.end(), p.pdgId) != pdgIds.end());
+}
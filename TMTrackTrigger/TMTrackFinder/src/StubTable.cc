@@ -0,0 +1,42 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/StubTable.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
+
+using namespace std;
+
+//=== Fill the table from the given stubs, replacing any previous contents.
+
+void StubTable::fill(const vector<const Stub*>& stubs) {
+
+  const unsigned int n = stubs.size();
+
+  stub_           .resize(n);
+  phi_            .resize(n);
+  r_              .resize(n);
+  z_              .resize(n);
+  rErr_           .resize(n);
+  zErr_           .resize(n);
+  dphi_           .resize(n);
+  dphiRes_        .resize(n);
+  layerId_        .resize(n);
+  layerIdReduced_ .resize(n);
+  flags_          .resize(n);
+  min_qOverPt_bin_.resize(n);
+  max_qOverPt_bin_.resize(n);
+
+  for (unsigned int i = 0; i < n; i++) {
+    const Stub* s = stubs[i];
+    stub_[i]            = s;
+    phi_[i]             = s->phi();
+    r_[i]               = s->r();
+    z_[i]               = s->z();
+    rErr_[i]            = s->rErr();
+    zErr_[i]            = s->zErr();
+    dphi_[i]            = s->dphi();
+    dphiRes_[i]         = s->dphiRes();
+    layerId_[i]         = s->layerId();
+    layerIdReduced_[i]  = s->layerIdReduced();
+    flags_[i]           = (s->psModule() ? PS : 0) | (s->barrel() ? Barrel : 0);
+    min_qOverPt_bin_[i] = s->min_qOverPt_bin();
+    max_qOverPt_bin_[i] = s->max_qOverPt_bin();
+  }
+}
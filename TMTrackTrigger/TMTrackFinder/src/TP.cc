@@ -3,6 +3,7 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/Stub.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/EventSnapshot.h"
 
 using namespace std;
 
@@ -36,15 +37,37 @@ TP::TP(TrackingParticlePtr tpPtr, unsigned int index_in_vTPs, const Settings* se
   this->fillUseForEff(); // Fill useForEff_ flag, indicating if TP is good for tracking efficiency measurement.
 }
 
+//=== Store useful info about this tracking particle, taken from a record in a snapshot file.
+
+TP::TP(const SnapshotTP& snapTP, unsigned int index_in_vTPs, const Settings* settings) : 
+  TrackingParticlePtr(),
+  index_in_vTPs_(index_in_vTPs),
+  settings_(settings),                                                                                        
+
+  pdgId_(snapTP.pdgId),
+  inTimeBx_(snapTP.inTimeBx),
+  physicsCollision_(snapTP.physicsCollision),
+  charge_(snapTP.charge),
+  mass_(snapTP.mass),
+  pt_(snapTP.pt),
+  eta_(snapTP.eta),
+  theta_(snapTP.theta),
+  tanLambda_(1./tan(theta_)),
+  phi0_(snapTP.phi0),
+  vx_(snapTP.vx),
+  vy_(snapTP.vy),
+  vz_(snapTP.vz),
+  d0_(vx_*sin(phi0_) - vy_*cos(phi0_)), // Copied from CMSSW class TrackBase::d0().
+  z0_(vz_ - (vx_*cos(phi0_) + vy_*sin(phi0_))*tanLambda_), // Copied from CMSSW class TrackBase::dz().
+  use_(true), // Only TPs passing this cut are written to snapshot files.
+  useForEff_(snapTP.useForEff)
+{}
+
 //=== Fill truth info with association from tracking particle to stubs.
 
-void TP::fillTruth(const vector<Stub>& vStubs) {
+void TP::fillTruth(const vector<const Stub*>& assocStubs) {
 
-  for (const Stub& s : vStubs) {
-    for (const TP* tp_i : s.assocTPs()) {
-      if (tp_i -> index() == this->index()) assocStubs_.push_back(&s);
-    }
-  }
+  assocStubs_ = assocStubs;
 
   this->fillUseForAlgEff(); // Fill useForAlgEff_ flag.
 
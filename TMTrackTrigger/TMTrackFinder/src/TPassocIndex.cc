@@ -0,0 +1,78 @@
+#include "TMTrackTrigger/TMTrackFinder/interface/TPassocIndex.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/InputData.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/HTpair.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/FittedTrackStore.h"
+#include "TMTrackTrigger/TMTrackFinder/interface/TP.h"
+
+using namespace std;
+
+//=== Index the track candidates in the HT arrays & the fitted tracks of an event, replacing any previous contents.
+
+void TPassocIndex::fill(const InputData& inputData, const boost::numeric::ublas::matrix<HTpair>& mHtPairs, const FittedTrackStore& fittedTracks) {
+
+  const unsigned int numTPs = inputData.getTPs().size();
+
+  //--- Track candidates found by the HT.
+
+  unsortedCands_.clear();
+  tpOfEntry_.clear();
+  for (unsigned int iPhiSec = 0; iPhiSec < mHtPairs.size1(); iPhiSec++) {
+    for (unsigned int iEtaReg = 0; iEtaReg < mHtPairs.size2(); iEtaReg++) {
+      for (const L1track3D& trk : mHtPairs(iPhiSec, iEtaReg).trackCands3D()) {
+	const TP* tp = trk.getMatchedTP();
+	if (tp != nullptr) {
+	  Cand cand = {&trk, uint16_t(iPhiSec), uint16_t(iEtaReg)};
+	  unsortedCands_.push_back(cand);
+	  tpOfEntry_.push_back(tp->index());
+	}
+      }
+    }
+  }
+  sortByTP(numTPs, unsortedCands_, tpOfEntry_, candOffsets_, cands_);
+
+  //--- Fitted tracks.
+
+  unsortedFits_.clear();
+  tpOfEntry_.clear();
+  for (const FittedTrackStore::Track fitTrk : fittedTracks) {
+    const TP* tp = fitTrk.getMatchedTP();
+    if (tp != nullptr) {
+      unsortedFits_.push_back(fitTrk.index());
+      tpOfEntry_.push_back(tp->index());
+    }
+  }
+  sortByTP(numTPs, unsortedFits_, tpOfEntry_, fitOffsets_, fits_);
+}
+
+//=== Get the HT track candidates matched to the given TP.
+
+TPassocIndex::Range<TPassocIndex::Cand> TPassocIndex::assocTrackCands3D(const TP& tp) const {
+  const Cand* cands = cands_.data();
+  return Range<Cand>(cands + candOffsets_[tp.index()], cands + candOffsets_[tp.index() + 1]);
+}
+
+//=== Get the indices in the FittedTrackStore of the fitted tracks matched to the given TP.
+
+TPassocIndex::Range<uint32_t> TPassocIndex::assocFittedTracks(const TP& tp) const {
+  const uint32_t* fits = fits_.data();
+  return Range<uint32_t>(fits + fitOffsets_[tp.index()], fits + fitOffsets_[tp.index() + 1]);
+}
+
+//=== Sort entries by TP index, keeping their order within each TP (counting sort).
+
+template <typename T>
+void TPassocIndex::sortByTP(unsigned int numTPs, const vector<T>& entries, const vector<int32_t>& tpOfEntry,
+                            vector<uint32_t>& offsets, vector<T>& sorted)
+{
+  // Count entries of each TP, and hence find where the entries of each TP start.
+  offsets.assign(numTPs + 1, 0);
+  for (int32_t iTP : tpOfEntry) offsets[iTP + 1]++;
+  for (unsigned int iTP = 0; iTP < numTPs; iTP++) offsets[iTP + 1] += offsets[iTP];
+
+  // Copy each entry to the next free position of its TP.
+  sorted.resize(entries.size());
+  vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+  for (unsigned int i = 0; i < entries.size(); i++) {
+    sorted[ next[tpOfEntry[i]]++ ] = entries[i];
+  }
+}
@@ -31,6 +31,15 @@ TrackFitGeneric::TrackFitGeneric( const Settings* settings, const std::string &f
 L1fittedTrack TrackFitGeneric::fit(const L1track3D& l1track3D,  unsigned int iPhiSec, unsigned int iEtaReg) {
   return L1fittedTrack (settings_, l1track3D, l1track3D.getStubs(), 0, 0, 0, 0, 0, 999999., 0, iPhiSec, iEtaReg);
 }
+
+//=== Fit all track candidates in a sector, returning one fitted track per candidate, in the same order.
+
+std::vector<L1fittedTrack> TrackFitGeneric::fitBatch(const std::vector<L1track3D>& l1track3Ds, unsigned int iPhiSec, unsigned int iEtaReg) {
+  std::vector<L1fittedTrack> fittedTracks;
+  fittedTracks.reserve(l1track3Ds.size());
+  for (const L1track3D& trk : l1track3Ds) fittedTracks.push_back( this->fit(trk, iPhiSec, iEtaReg) );
+  return fittedTracks;
+}
  
 /*std::auto_ptr<TrackFitGeneric> TrackFitGeneric::create(std::string fitter, const Settings* settings){
     if(fitter.compare("ChiSquared4ParamsTrackletStyle") == 0){
@@ -7,6 +7,8 @@
 #include "TMTrackTrigger/TMTrackFinder/interface/TrackFitLinearAlgo.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Settings.h"
 #include "TMTrackTrigger/TMTrackFinder/interface/Utility.h"
+
+#include <algorithm>
  
 //=== Set configuration parameters.
  
@@ -50,6 +52,7 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
   z0_ = l1track3D.z0();
   t_ = l1track3D.tanLambda();
   d0_ = 0.0;
+  d0fit_ = 0.0;
   stubs_ = l1track3D.getStubs(); 
  
   // Cheat by using MC truth to initialize helix parameters. Useful to check if convergence is the problem.
@@ -75,7 +78,8 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
   largestresid=-1.0;
   ilargestresid=-1;
 
-  calculateDerivatives( false ); // Default = false
+  fillStubGroups();
+  calculateDerivatives();
   linearTrackFit( false ); // Default = false
   residuals( largestresid,ilargestresid );
 
@@ -90,6 +94,7 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
           stubs_.erase(stubs_.begin()+ilargestresid);    
           if (largestresid > killingResidualCut_ || Utility::countLayers( settings_, stubs_ ) >= minStubLayers_) {
             if (print) std::cout << "Killed stub " << ilargestresid << "." << std::endl;
+            fillStubGroups();
           } else {
             // Don't delete worst stub, as it would kill the track.
             stubs_ = stubs_backup;
@@ -104,7 +109,7 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
       
       //      if (print && (i==numFittingIterations_+1)) std::cout << "Last fit." << std::endl;
       
-      calculateDerivatives( false ); // Default = false
+      calculateDerivatives();
       linearTrackFit( false ); // Default = false
       residuals(largestresid,ilargestresid);
     }
@@ -121,8 +126,8 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
   */
 
   //  if (print) std::cout << "5 fit." << std::endl;
+  // N.B. This reuses the derivatives & residuals of the last 4 parameter fit.
   if (nPar_ == 5){
-    calculateDerivatives( true );
     linearTrackFit( true );
   }
  
@@ -142,176 +147,150 @@ L1fittedTrack TrackFitLinearAlgo::fit(const L1track3D& l1track3D, unsigned int i
   else return L1fittedTrack (settings_, l1track3D, stubs_, l1track3D.qOverPt(), 0., l1track3D.phi0(), l1track3D.z0(), l1track3D.tanLambda(), 999999., 4, iPhiSec, iEtaReg, false);
 }
 
-void TrackFitLinearAlgo::invert( float M[5][10],unsigned int n ){
+//=== Solve M*x = b for symmetric, positive definite n x n matrix M, by Cholesky decomposition M = L*L^T.
+
+void TrackFitLinearAlgo::solveSymmetric( const float M[5][5], const double b[5], double x[5], unsigned int n ){
  
   assert(n<=5);
- 
-  unsigned int i,j,k;
-  double ratio,a;
- 
-  for(i = 0; i < n; i++){
-    for(j = n; j < 2*n; j++){
-      if(i==(j-n))
-        M[i][j] = 1.0;
+
+  double L[5][5];
+  for(unsigned int i = 0; i < n; i++){
+    for(unsigned int j = 0; j <= i; j++){
+      double sum = M[i][j];
+      for(unsigned int k = 0; k < j; k++) sum -= L[i][k]*L[j][k];
+      if (i == j)
+        L[i][i] = sqrt(sum);
       else
-        M[i][j] = 0.0;
+        L[i][j] = sum/L[j][j];
     }
   }
- 
-  for(i = 0; i < n; i++){
-    for(j = 0; j < n; j++){
-      if(i!=j){
-        ratio = M[j][i]/M[i][i];
-        for(k = 0; k < 2*n; k++){
-          M[j][k] -= ratio * M[i][k];
-        }
-     }
-    }
+
+  // Forward substitution L*y = b, then back substitution L^T*x = y.
+  double y[5];
+  for(unsigned int i = 0; i < n; i++){
+    double sum = b[i];
+    for(unsigned int k = 0; k < i; k++) sum -= L[i][k]*y[k];
+    y[i] = sum/L[i][i];
   }
- 
-  for(i = 0; i < n; i++){
-    a = M[i][i];
-    for(j = 0; j < 2*n; j++){
-      M[i][j] /= a;
-    }
+  for(int i = n-1; i >= 0; i--){
+    double sum = y[i];
+    for(unsigned int k = i+1; k < n; k++) sum -= L[k][i]*x[k];
+    x[i] = sum/L[i][i];
   }
 }
- 
- 
-void TrackFitLinearAlgo::calculateDerivatives( bool withd0 ){
- 
-  unsigned int n=stubs_.size();
- 
-  //    assert(n<=20);
- 
-  int j=0;
- 
-  for(unsigned int i=0;i<n;i++) {
-   
-    double ri=stubs_[i]->r();
-    double zi=stubs_[i]->z();
-   
-    const double sigmax=stubs_[i]->sigmaX();
-    const double sigmaz=stubs_[i]->sigmaZ();
-
-    if ( stubs_[i]->barrel() ){
-      //here we handle a barrel hit
- 
-      //first we have the phi position
-      D_[0][j]=-0.5*ri*ri/sqrt(1-0.25*ri*ri*rinv_*rinv_)/sigmax;
-      D_[1][j]=ri/sigmax;
-      D_[2][j]=0.0;
-      D_[3][j]=0.0;
-      D_[4][j]=1.0/sigmax;
-      j++;
-      //second the z position
-      D_[0][j]=0.0;
-      D_[1][j]=0.0;
-      D_[2][j]=(2/rinv_)*asin(0.5*ri*rinv_)/sigmaz;
-      D_[3][j]=1.0/sigmaz;
-      D_[4][j]=0.0;
-      j++;
-    }
-    else {
-      //here we handle a disk hit
-      //first we have the r position
- 
-      double r_track=2.0*sin(0.5*rinv_*(zi-z0_)/t_)/rinv_;
-      double phi_track=phi0_-0.5*rinv_*(zi-z0_)/t_;
- 
-      int iphi=stubs_[i]->iphi();
-      double phii=stubs_[i]->phi();
-       
-      //        std::cout << "iphi: " << iphi << std::endl;
- 
+
+//=== Split stubs_ into barrel & disk groups.
+
+void TrackFitLinearAlgo::fillStubGroups(){
+
+  barrelStubs_.n = 0;
+  diskStubs_.n = 0;
+
+  for(unsigned int i=0;i<stubs_.size();i++) {
+    const Stub* stub = stubs_[i];
+    StubGroup& group = stub->barrel() ? barrelStubs_ : diskStubs_;
+    const unsigned int k = group.n++;
+    group.index[k] = i;
+    group.r[k] = stub->r();
+    group.z[k] = stub->z();
+    group.phi[k] = stub->phi();
+    group.sigmaX[k] = stub->sigmaX();
+    group.sigmaZ[k] = stub->sigmaZ();
+    group.deltai[k] = 0.0;
+    group.theta0[k] = 0.0;
+    if ( ! stub->barrel() ) {
+      int iphi=stub->iphi();
       // N.B. These represent HALF the width and number of strips of sensor.
-      double width = stubs_[i]->width()/2.0;
-      double nstrip = stubs_[i]->nstrip()/2.0;
- 
+      double width = stub->width()/2.0;
+      double nstrip = stub->nstrip()/2.0;
       double Deltai=width*(iphi-nstrip)/nstrip;  //A bit of a hack...
- 
-      //     std::cout << "Deltai: " << Deltai << std::endl;
-      //     std::cout << "ri/zi: " << ri << "/" << stubs_[i]->z() << std::endl;
- 
-      if (stubs_[i]->z()>0.0) Deltai=-Deltai;
-      double theta0=asin(Deltai/ri);
- 
-      //      std::cout << "theta0: " << theta0 << std::endl;
- 
-      double rmultiplier=-sin(theta0-(phi_track-phii));
-      double phimultiplier=r_track*cos(theta0-(phi_track-phii));
- 
- 
-      double drdrinv=-2.0*sin(0.5*rinv_*(zi-z0_)/t_)/(rinv_*rinv_)
-                     +(zi-z0_)*cos(0.5*rinv_*(zi-z0_)/t_)/(rinv_*t_);
-      double drdphi0=0;
-      double drdt=-(zi-z0_)*cos(0.5*rinv_*(zi-z0_)/t_)/(t_*t_);
-      double drdz0=-cos(0.5*rinv_*(zi-z0_)/t_)/t_;
- 
-      double dphidrinv=-0.5*(zi-z0_)/t_;
-      double dphidphi0=1.0;
-      double dphidt=0.5*rinv_*(zi-z0_)/(t_*t_);
-      double dphidz0=0.5*rinv_/t_;
-       
-      D_[0][j]=drdrinv/sigmaz;
-      D_[1][j]=drdphi0/sigmaz;
-      D_[2][j]=drdt/sigmaz;
-      D_[3][j]=drdz0/sigmaz;
-      D_[4][j]=0.0;
-      j++;
-      //second the rphi position
-      D_[0][j]=(phimultiplier*dphidrinv+rmultiplier*drdrinv)/sigmax;
-      D_[1][j]=(phimultiplier*dphidphi0+rmultiplier*drdphi0)/sigmax;
-      D_[2][j]=(phimultiplier*dphidt+rmultiplier*drdt)/sigmax;
-      D_[3][j]=(phimultiplier*dphidz0+rmultiplier*drdz0)/sigmax;
-      D_[4][j]=1.0/sigmax;
-      //old calculation
-      //D_[0][j]=-0.5*(zi-z0_)/(t_*(sigmax/ri));
-      //D_[1][j]=1.0/(sigmax/ri);
-      //D_[2][j]=-0.5*rinv_*(zi-z0_)/(t_*t_*(sigmax/ri));
-      //D_[3][j]=0.5*rinv_/((sigmax/ri)*t_);
-      j++;
+      if (stub->z()>0.0) Deltai=-Deltai;
+      group.deltai[k] = Deltai;
+      group.theta0[k] = asin(Deltai/group.r[k]);
     }
- 
-    //cout << "Exact rinv derivative: "<<i<<" "<<D_[0][j-2]<<" "<<D_[0][j-1]<<endl;
-    //cout << "Exact phi0 derivative: "<<i<<" "<<D_[1][j-2]<<" "<<D_[1][j-1]<<endl;
-    //cout << "Exact t derivative   : "<<i<<" "<<D_[2][j-2]<<" "<<D_[2][j-1]<<endl;
-    //cout << "Exact z0 derivative  : "<<i<<" "<<D_[3][j-2]<<" "<<D_[3][j-1]<<endl;
-       
-       
   }
-   
-  //cout << "D:"<<endl;
-  //for(unsigned int j=0;j<2*n;j++){
-  //  cout <<D_[0][j]<<" "<<D_[1][j]<<" "<<D_[2][j]<<" "<<D_[3][j]<<endl;
-  //}
+}
  
-     
+//=== Calculate derivatives, and M for the 4 parameter fit.
  
-    unsigned int npar=4;
-    if ( withd0 ) npar++;
- 
-    for(unsigned int i1=0;i1<npar;i1++){
-      for(unsigned int i2=0;i2<npar;i2++){
-        M_[i1][i2]=0.0;
-        for(unsigned int j=0;j<2*n;j++){
-          M_[i1][i2]+=D_[i1][j]*D_[i2][j];       
-        }
-      }
-    }
+void TrackFitLinearAlgo::calculateDerivatives(){
  
+  unsigned int n=stubs_.size();
  
-  invert(M_,npar);
+  //here we handle the barrel hits
+  const StubGroup& bar = barrelStubs_;
+  for(unsigned int k=0;k<bar.n;k++) {
+    const double ri=bar.r[k];
+    const double sigmax=bar.sigmaX[k];
+    const double sigmaz=bar.sigmaZ[k];
+    const unsigned int j=2*bar.index[k];
+ 
+    //first we have the phi position
+    D_[0][j]=-0.5*ri*ri/sqrt(1-0.25*ri*ri*rinv_*rinv_)/sigmax;
+    D_[1][j]=ri/sigmax;
+    D_[2][j]=0.0;
+    D_[3][j]=0.0;
+    D_[4][j]=1.0/sigmax;
+    //second the z position
+    D_[0][j+1]=0.0;
+    D_[1][j+1]=0.0;
+    D_[2][j+1]=(2/rinv_)*asin(0.5*ri*rinv_)/sigmaz;
+    D_[3][j+1]=1.0/sigmaz;
+    D_[4][j+1]=0.0;
+  }
+
+  //here we handle the disk hits
+  const StubGroup& disk = diskStubs_;
+  for(unsigned int k=0;k<disk.n;k++) {
+    const double zi=disk.z[k];
+    const double phii=disk.phi[k];
+    const double sigmax=disk.sigmaX[k];
+    const double sigmaz=disk.sigmaZ[k];
+    const double theta0=disk.theta0[k];
+    const unsigned int j=2*disk.index[k];
+ 
+    double r_track=2.0*sin(0.5*rinv_*(zi-z0_)/t_)/rinv_;
+    double phi_track=phi0_-0.5*rinv_*(zi-z0_)/t_;
+ 
+    double rmultiplier=-sin(theta0-(phi_track-phii));
+    double phimultiplier=r_track*cos(theta0-(phi_track-phii));
+ 
+    double drdrinv=-2.0*sin(0.5*rinv_*(zi-z0_)/t_)/(rinv_*rinv_)
+                   +(zi-z0_)*cos(0.5*rinv_*(zi-z0_)/t_)/(rinv_*t_);
+    double drdphi0=0;
+    double drdt=-(zi-z0_)*cos(0.5*rinv_*(zi-z0_)/t_)/(t_*t_);
+    double drdz0=-cos(0.5*rinv_*(zi-z0_)/t_)/t_;
+ 
+    double dphidrinv=-0.5*(zi-z0_)/t_;
+    double dphidphi0=1.0;
+    double dphidt=0.5*rinv_*(zi-z0_)/(t_*t_);
+    double dphidz0=0.5*rinv_/t_;
+       
+    //first we have the r position
+    D_[0][j]=drdrinv/sigmaz;
+    D_[1][j]=drdphi0/sigmaz;
+    D_[2][j]=drdt/sigmaz;
+    D_[3][j]=drdz0/sigmaz;
+    D_[4][j]=0.0;
+    //second the rphi position
+    D_[0][j+1]=(phimultiplier*dphidrinv+rmultiplier*drdrinv)/sigmax;
+    D_[1][j+1]=(phimultiplier*dphidphi0+rmultiplier*drdphi0)/sigmax;
+    D_[2][j+1]=(phimultiplier*dphidt+rmultiplier*drdt)/sigmax;
+    D_[3][j+1]=(phimultiplier*dphidz0+rmultiplier*drdz0)/sigmax;
+    D_[4][j+1]=1.0/sigmax;
+  }
  
-  for(unsigned int j=0;j<2*n;j++) {
-    for(unsigned int i1=0;i1<npar;i1++) {
-      MinvDt_[i1][j]=0.0;
-      for(unsigned int i2=0;i2<npar;i2++) {
-        MinvDt_[i1][j]+=M_[i1][i2+npar]*D_[i2][j];
+  // M is symmetric, so only calculate its lower triangle.
+  // The d0 row is only added if the 5 parameter fit is done.
+  for(unsigned int i1=0;i1<4;i1++){
+    for(unsigned int i2=0;i2<=i1;i2++){
+      M_[i1][i2]=0.0;
+      for(unsigned int j=0;j<2*n;j++){
+        M_[i1][i2]+=D_[i1][j]*D_[i2][j];       
       }
+      M_[i2][i1]=M_[i1][i2];
     }
   }
- 
 }
  
 void TrackFitLinearAlgo::residuals( float& largestresid,int& ilargestresid ) {
@@ -322,73 +301,53 @@ void TrackFitLinearAlgo::residuals( float& largestresid,int& ilargestresid ) {
  
   double delta[2*__MAX_STUBS_PER_TRK__];
  
-  double chisq=0.0;
+  //we are dealing with barrel stubs
+  const StubGroup& bar = barrelStubs_;
+  for(unsigned int k=0;k<bar.n;k++) {
+    const double ri=bar.r[k];
+    const double zi=bar.z[k];
+    const double phii=bar.phi[k];
+    const unsigned int j=2*bar.index[k];
  
-  unsigned int j=0;
-  
-  //  if (print) std::cout << "Residuals ("<<chisq_<<") ["<<invPtToInvR_/rinvfit4par_<<"]: ";
- 
-  largestresid=-1.0;
-  ilargestresid=-1;
- 
-  for(unsigned int i=0;i<n;i++) {
-    double ri=stubs_[i]->r();
-    double zi=stubs_[i]->z();
-    double phii=stubs_[i]->phi();
-    const double sigmax=stubs_[i]->sigmaX();
-    const double sigmaz=stubs_[i]->sigmaZ();
- 
-    if ( stubs_[i]->barrel() ) {
-      //we are dealing with a barrel stub
- 
-      double deltaphi=phi0fit4par_-asin(0.5*ri*rinvfit4par_)-phii;
-      if (deltaphi>M_PI) deltaphi-=2*M_PI;
-      if (deltaphi<-M_PI) deltaphi+=2*M_PI;
-      //      std::cout << "phi0/phii/ri/rinv/ : " << phi0_ << "/" << phii << "/" << ri << "/" << rinv_ << "." << std::endl;
-      //      std::cout << "deltaphi: " << deltaphi << std::endl;
-      //      assert(fabs(deltaphi)<0.2*M_PI);
- 
-      delta[j++]=ri*deltaphi/sigmax;
-      delta[j++]=(z0fit4par_+(2.0/rinvfit4par_)*tfit4par_*asin(0.5*ri*rinvfit4par_)-zi)/sigmaz;
-    }
-    else {
-      //we are dealing with a disk hit
- 
-      double r_track=2.0*sin(0.5*rinvfit4par_*(zi-z0fit4par_)/tfit4par_)/rinvfit4par_;
-      double phi_track=phi0fit4par_-0.5*rinvfit4par_*(zi-z0fit4par_)/tfit4par_;
-       
-      int iphi=stubs_[i]->iphi();
+    double deltaphi=phi0fit4par_-asin(0.5*ri*rinvfit4par_)-phii;
+    if (deltaphi>M_PI) deltaphi-=2*M_PI;
+    if (deltaphi<-M_PI) deltaphi+=2*M_PI;
  
-      // N.B. These represent HALF the width and number of strips of sensor.
-      double width = stubs_[i]->width()/2.0;
-      double nstrip = stubs_[i]->nstrip()/2.0;
- 
-      double Deltai=width*(iphi-nstrip)/nstrip;  //A bit of a hack...
+    delta[j]=ri*deltaphi/bar.sigmaX[k];
+    delta[j+1]=(z0fit4par_+(2.0/rinvfit4par_)*tfit4par_*asin(0.5*ri*rinvfit4par_)-zi)/bar.sigmaZ[k];
+  }
+
+  //we are dealing with disk hits
+  const StubGroup& disk = diskStubs_;
+  for(unsigned int k=0;k<disk.n;k++) {
+    const double ri=disk.r[k];
+    const double zi=disk.z[k];
+    const double phii=disk.phi[k];
+    const unsigned int j=2*disk.index[k];
  
-      if (stubs_[i]->z()>0.0) Deltai=-Deltai;
+    double r_track=2.0*sin(0.5*rinvfit4par_*(zi-z0fit4par_)/tfit4par_)/rinvfit4par_;
+    double phi_track=phi0fit4par_-0.5*rinvfit4par_*(zi-z0fit4par_)/tfit4par_;
  
-      double theta0=asin(Deltai/ri);
+    double Delta=disk.deltai[k]-r_track*sin(disk.theta0[k]-(phi_track-phii));
  
-      double Delta=Deltai-r_track*sin(theta0-(phi_track-phii));
+    delta[j]=(r_track-ri)/disk.sigmaZ[k];
+    delta[j+1]=Delta/disk.sigmaX[k];
+  }
  
-      delta[j++]=(r_track-ri)/sigmaz;
-      delta[j++]=Delta/sigmax;
-    }
+  largestresid=-1.0;
+  ilargestresid=-1;
  
-    if (fabs(delta[j-2])>largestresid) {
-      largestresid=fabs(delta[j-2]);
+  for(unsigned int i=0;i<n;i++) {
+    const unsigned int j=2*i;
+    if (fabs(delta[j])>largestresid) {
+      largestresid=fabs(delta[j]);
       ilargestresid=i;
     }
- 
-    if (fabs(delta[j-1])>largestresid) {
-      largestresid=fabs(delta[j-1]);
+    if (fabs(delta[j+1])>largestresid) {
+      largestresid=fabs(delta[j+1]);
       ilargestresid=i;
     }
-    
-    chisq+=delta[j-2]*delta[j-2]+delta[j-1]*delta[j-1];
-    if (print) std::cout << __LINE__ << " - Residuals(): delta["<<j-2<<"]/delta["<<j-1<<"]: "<< delta[j-2] << "/" << delta[j-1] << std::endl; 
-    if (print) std::cout << __LINE__ << " - Residuals(): chisq: " << chisq  << std::endl; 
- 
+    if (print) std::cout << __LINE__ << " - Residuals(): delta["<<j<<"]/delta["<<j+1<<"]: "<< delta[j] << "/" << delta[j+1] << std::endl; 
   }
  
 }
@@ -397,108 +356,84 @@ void TrackFitLinearAlgo::residuals( float& largestresid,int& ilargestresid ) {
 void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
  
   unsigned int n=stubs_.size();
+
+  unsigned int npar=4;
+  if ( withd0 ) npar++;
  
-  //Next calculate the residuals
- 
-  double delta[2*__MAX_STUBS_PER_TRK__];
- 
-  double chisq=0;
- 
-  unsigned int j=0;
- 
-  for(unsigned int i=0;i<n;i++) {
-    double ri=stubs_[i]->r();
-    double zi=stubs_[i]->z();
-    double phii=stubs_[i]->phi();
-    const double sigmax=stubs_[i]->sigmaX();
-    const double sigmaz=stubs_[i]->sigmaZ();
- 
-    if ( stubs_[i]->barrel() ) {
-      //we are dealing with a barrel stub
+  if ( ! withd0 ) {
+
+    //Next calculate the residuals
+
+    //we are dealing with barrel stubs
+    const StubGroup& bar = barrelStubs_;
+    for(unsigned int k=0;k<bar.n;k++) {
+      const double ri=bar.r[k];
+      const double zi=bar.z[k];
+      const double phii=bar.phi[k];
+      const unsigned int j=2*bar.index[k];
  
       double deltaphi=phi0_-asin(0.5*ri*rinv_)-phii;
       if (deltaphi>M_PI) deltaphi-=2*M_PI;
       if (deltaphi<-M_PI) deltaphi+=2*M_PI;
-      //      std::cout << "phi0/phii/ri/rinv/ : " << phi0_ << "/" << phii << "/" << ri << "/" << rinv_ << "." << std::endl;
-      //      std::cout << "deltaphi: " << deltaphi << std::endl;
-      //      assert(fabs(deltaphi)<0.2*M_PI);
  
-      delta[j++]=ri*deltaphi/sigmax;
-      delta[j++]=(z0_+(2.0/rinv_)*t_*asin(0.5*ri*rinv_)-zi)/sigmaz;
+      delta_[j]=ri*deltaphi/bar.sigmaX[k];
+      delta_[j+1]=(z0_+(2.0/rinv_)*t_*asin(0.5*ri*rinv_)-zi)/bar.sigmaZ[k];
     }
-    else {
-      //we are dealing with a disk hit
+
+    //we are dealing with disk hits
+    const StubGroup& disk = diskStubs_;
+    for(unsigned int k=0;k<disk.n;k++) {
+      const double ri=disk.r[k];
+      const double zi=disk.z[k];
+      const double phii=disk.phi[k];
+      const unsigned int j=2*disk.index[k];
  
       double r_track=2.0*sin(0.5*rinv_*(zi-z0_)/t_)/rinv_;
-      //cout <<"t_track 1: "<<r_track<<endl;
       double phi_track=phi0_-0.5*rinv_*(zi-z0_)/t_;
-       
-      int iphi=stubs_[i]->iphi();
- 
-      // N.B. These represent HALF the width and number of strips of sensor.
-      double width = stubs_[i]->width()/2.0;
-      double nstrip = stubs_[i]->nstrip()/2.0;
- 
-      double Deltai=width*(iphi-nstrip)/nstrip;  //A bit of a hack...
-      //      double Deltai=(stubs_[2].r()-stubs_[1].r()/(1+0.035+3/2*0.035*0.035);  //A bit of a hack...taken to silly levels NB. Not required anymore
-       
-      if (stubs_[i]->z()>0.0) Deltai=-Deltai;
- 
-      double theta0=asin(Deltai/ri);
  
-      double Delta=Deltai-r_track*sin(theta0-(phi_track-phii));
- 
-      delta[j++]=(r_track-ri)/sigmaz;
-      //double deltaphi=phi_track-phii;
-      //if (deltaphi>M_PI) deltaphi-=2*M_PI;
-      //if (deltaphi<-M_PI) deltaphi+=2*M_PI;
-      //assert(fabs(deltaphi)<0.2*M_PI)
-      //delta[j++]=deltaphi/(sigmax/ri);
-      delta[j++]=Delta/sigmax;
+      double Delta=disk.deltai[k]-r_track*sin(disk.theta0[k]-(phi_track-phii));
  
+      delta_[j]=(r_track-ri)/disk.sigmaZ[k];
+      delta_[j+1]=Delta/disk.sigmaX[k];
     }
- 
-    chisq+=(delta[j-2]*delta[j-2]+delta[j-1]*delta[j-1]);
-    if (print) std::cout << __LINE__ << " - linearTrackFit(): delta["<<j-2<<"]/delta["<<j-1<<"] "<< delta[j-2] << "/" << delta[j-1] << std::endl; 
-  }
- 
-  double drinv = 0.0;
-  double dphi0 = 0.0;
-  double dd0 = 0.0;
-  double dt = 0.0;
-  double dz0 = 0.0;
- 
-  double drinv_cov = 0.0;
-  double dphi0_cov = 0.0;
-  double dd0_cov = 0.0;
-  double dt_cov = 0.0;
-  double dz0_cov = 0.0;
- 
- 
- 
-  for(unsigned int j=0;j<2*n;j++) {
-    drinv-=MinvDt_[0][j]*delta[j];
-    dphi0-=MinvDt_[1][j]*delta[j];
-    dt-=MinvDt_[2][j]*delta[j];
-    dz0-=MinvDt_[3][j]*delta[j];
-    if ( withd0 ) dd0-=MinvDt_[4][j]*delta[j];
- 
-    drinv_cov+=D_[0][j]*delta[j];
-    dphi0_cov+=D_[1][j]*delta[j];
-    dt_cov+=D_[2][j]*delta[j];
-    dz0_cov+=D_[3][j]*delta[j];
-    if ( withd0 ) dd0_cov+=D_[4][j]*delta[j];
 
+    chisqDelta_=0.0;
+    for(unsigned int i=0;i<n;i++) {
+      const unsigned int j=2*i;
+      chisqDelta_+=(delta_[j]*delta_[j]+delta_[j+1]*delta_[j+1]);
+      if (print) std::cout << __LINE__ << " - linearTrackFit(): delta["<<j<<"]/delta["<<j+1<<"] "<< delta_[j] << "/" << delta_[j+1] << std::endl; 
+    }
+
+    for(unsigned int i1=0;i1<5;i1++) {
+      cov_[i1]=0.0;
+      for(unsigned int j=0;j<2*n;j++) {
+        cov_[i1]+=D_[i1][j]*delta_[j];
+      }
+    }
+
+  } else {
+
+    // Add the d0 row to M.
+    for(unsigned int i2=0;i2<5;i2++){
+      M_[4][i2]=0.0;
+      for(unsigned int j=0;j<2*n;j++){
+        M_[4][i2]+=D_[4][j]*D_[i2][j];       
+      }
+      M_[i2][4]=M_[4][i2];
+    }
   }
-   
-  //std::cout << __LINE__ << " - linearTrackFit(): chisq: "<< chisq << std::endl;
 
-  double deltaChisq=drinv*drinv_cov+dphi0*dphi0_cov+dt*dt_cov+dz0*dz0_cov;
-  if ( withd0 ) deltaChisq+=dd0*dd0_cov;
-  //std::cout << __LINE__ << "- deltaChisq: " << deltaChisq << std::endl; 
-  //std::cout << __LINE__ << " - linearTrackFit(): chisq+deltaChisq: " << chisq+deltaChisq << std::endl;
+  double dx[5];
+  solveSymmetric(M_, cov_, dx, npar);
 
-  //drinv=0.0; dphi0=0.0; dt=0.0; dz0=0.0;
+  double drinv = -dx[0];
+  double dphi0 = -dx[1];
+  double dt = -dx[2];
+  double dz0 = -dx[3];
+  double dd0 = withd0 ? -dx[4] : 0.0;
+ 
+  double deltaChisq=drinv*cov_[0]+dphi0*cov_[1]+dt*cov_[2]+dz0*cov_[3];
+  if ( withd0 ) deltaChisq+=dd0*cov_[4];
  
     if ( withd0 ) {
       rinvfit_=rinv_+drinv;
@@ -509,7 +444,7 @@ void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
      
       d0fit_=d0_+dd0;
  
-      chisq_=(chisq+deltaChisq);
+      chisq_=(chisqDelta_+deltaChisq);
  
     }
    
@@ -519,13 +454,420 @@ void TrackFitLinearAlgo::linearTrackFit( bool withd0 ) {
       tfit4par_=t_+dt;
       z0fit4par_=z0_+dz0;
      
-      chisq4par_=(chisq+deltaChisq);
+      chisq4par_=(chisqDelta_+deltaChisq);
     }
  
-  //cout << "Trackfit:"<<endl;
-  //cout << "rinv_ drinv: "<<rinv_<<" "<<drinv<<endl;
-  //cout << "phi0_ dphi0: "<<phi0_<<" "<<dphi0<<endl;
-  //cout << "t_ dt      : "<<t_<<" "<<dt<<endl;
-  //cout << "z0_ dz0    : "<<z0_<<" "<<dz0<<endl;
- 
+}
+
+//=== Fit all track candidates in a sector, giving the same results as fit().
+//=== Candidates with similar numbers of stubs are fitted together in batches of __FIT_BATCH_LANES__.
+
+std::vector<L1fittedTrack> TrackFitLinearAlgo::fitBatch(const std::vector<L1track3D>& l1track3Ds, unsigned int iPhiSec, unsigned int iEtaReg) {
+  using namespace std;
+
+  Batch& b = batch_;
+
+  // Fitted tracks, in the order they were fitted, and the position of each candidate's fitted track in it.
+  vector<L1fittedTrack> fitTrks;
+  fitTrks.reserve(l1track3Ds.size());
+  vector<unsigned int> iFitTrk(l1track3Ds.size());
+
+  // Order the candidates by number of stubs, so the lanes of each batch do similar amounts of work.
+  // Candidates with too many stubs are not fitted, so are left to fit().
+  vector<unsigned int> order;
+  order.reserve(l1track3Ds.size());
+  for (unsigned int iCand = 0; iCand < l1track3Ds.size(); iCand++) {
+    if (l1track3Ds[iCand].getNumStubs() > __MAX_STUBS_PER_TRK__) {
+      iFitTrk[iCand] = fitTrks.size();
+      fitTrks.push_back( this->fit(l1track3Ds[iCand], iPhiSec, iEtaReg) );
+    } else {
+      order.push_back(iCand);
+    }
+  }
+  stable_sort(order.begin(), order.end(), [&l1track3Ds](unsigned int i1, unsigned int i2) {return l1track3Ds[i1].getNumStubs() < l1track3Ds[i2].getNumStubs();});
+
+  for (unsigned int iFirst = 0; iFirst < order.size(); iFirst += __FIT_BATCH_LANES__) {
+
+    // Fill the batch. Unused lanes are filled with a copy of the first candidate, and their results ignored.
+    b.nLanes = min(order.size() - iFirst, (size_t) __FIT_BATCH_LANES__);
+    b.nStubsMax = 0;
+    for (unsigned int l = 0; l < __FIT_BATCH_LANES__; l++) {
+      const L1track3D& l1track3D = l1track3Ds[ order[iFirst + (l < b.nLanes ? l : 0)] ];
+      b.trk[l] = &l1track3D;
+      b.stubs[l] = l1track3D.getStubs();
+      b.rinv[l] = invPtToInvR_*l1track3D.qOverPt();
+      b.phi0[l] = l1track3D.phi0();
+      b.z0[l] = l1track3D.z0();
+      b.t[l] = l1track3D.tanLambda();
+      b.d0[l] = 0.0;
+      b.d0fit[l] = 0.0;
+      this->loadBatchLane(l);
+      b.nStubsMax = max(b.nStubsMax, (unsigned int) b.stubs[l].size());
+    }
+
+    this->calculateDerivativesBatch();
+    this->linearTrackFitBatch( false );
+    this->residualsBatch();
+
+    for (int i=2;i<numFittingIterations_+1;++i) {
+      // Kill the worst stub on each candidate, if it doesn't kill the track (see fit()).
+      if (killTrackFitWorstHit_) {
+        for (unsigned int l = 0; l < b.nLanes; l++) {
+          if ( b.largestresid[l] > min(killingResidualCut_, generalResidualCut_) ) {
+            vector<const Stub*>& stubs = b.stubs[l];
+            const vector<const Stub*> stubs_backup(stubs);
+            stubs.erase(stubs.begin()+b.ilargestresid[l]);
+            if (b.largestresid[l] > killingResidualCut_ || Utility::countLayers( settings_, stubs ) >= minStubLayers_) {
+              this->loadBatchLane(l);
+            } else {
+              stubs = stubs_backup;
+            }
+          }
+        }
+      }
+      for (unsigned int l = 0; l < __FIT_BATCH_LANES__; l++) {
+        b.rinv[l] = b.rinvfit4par[l];
+        b.phi0[l] = b.phi0fit4par[l];
+        b.z0[l] = b.z0fit4par[l];
+        b.d0[l] = b.d0fit[l];
+        b.t[l] = b.tfit4par[l];
+      }
+
+      this->calculateDerivativesBatch();
+      this->linearTrackFitBatch( false );
+      this->residualsBatch();
+    }
+
+    if (nPar_ == 5){
+      this->linearTrackFitBatch( true );
+    }
+
+    for (unsigned int l = 0; l < b.nLanes; l++) {
+      iFitTrk[ order[iFirst + l] ] = fitTrks.size();
+      fitTrks.push_back( this->fittedTrackBatch(l, iPhiSec, iEtaReg) );
+    }
+  }
+
+  // Return the fitted tracks in the same order as the candidates.
+  vector<L1fittedTrack> fittedTracks;
+  fittedTracks.reserve(l1track3Ds.size());
+  for (unsigned int iCand = 0; iCand < l1track3Ds.size(); iCand++) fittedTracks.push_back( fitTrks[ iFitTrk[iCand] ] );
+  return fittedTracks;
+}
+
+//=== Copy the stubs of the candidate in the given lane into the batch arrays.
+//=== The stub slots beyond the last stub are masked, with harmless values to avoid NaNs.
+
+void TrackFitLinearAlgo::loadBatchLane( unsigned int l ) {
+
+  Batch& b = batch_;
+  const std::vector<const Stub*>& stubs = b.stubs[l];
+
+  for (unsigned int i = 0; i < __MAX_STUBS_PER_TRK__; i++) {
+    if (i < stubs.size()) {
+      const Stub* stub = stubs[i];
+      b.valid[i][l]  = true;
+      b.barrel[i][l] = stub->barrel();
+      b.r[i][l]      = stub->r();
+      b.z[i][l]      = stub->z();
+      b.phi[i][l]    = stub->phi();
+      b.sigmaX[i][l] = stub->sigmaX();
+      b.sigmaZ[i][l] = stub->sigmaZ();
+      b.deltai[i][l] = 0.0;
+      b.theta0[i][l] = 0.0;
+      if ( ! stub->barrel() ) {
+        int iphi = stub->iphi();
+        // N.B. These represent HALF the width and number of strips of sensor.
+        double width = stub->width()/2.0;
+        double nstrip = stub->nstrip()/2.0;
+        double Deltai=width*(iphi-nstrip)/nstrip;  //A bit of a hack...
+        if (stub->z()>0.0) Deltai=-Deltai;
+        b.deltai[i][l] = Deltai;
+        b.theta0[i][l] = asin(Deltai/b.r[i][l]);
+      }
+    } else {
+      b.valid[i][l]  = false;
+      b.barrel[i][l] = true;
+      b.r[i][l]      = 50.0;
+      b.z[i][l]      = 0.0;
+      b.phi[i][l]    = 0.0;
+      b.sigmaX[i][l] = 1.0;
+      b.sigmaZ[i][l] = 1.0;
+      b.deltai[i][l] = 0.0;
+      b.theta0[i][l] = 0.0;
+    }
+  }
+}
+
+//=== Batch equivalent of calculateDerivatives().
+//=== Barrel & disk derivatives are both calculated, and the correct one selected, to allow vectorization.
+
+void TrackFitLinearAlgo::calculateDerivativesBatch() {
+
+  Batch& b = batch_;
+  const unsigned int L = __FIT_BATCH_LANES__;
+  const unsigned int n = b.nStubsMax;
+
+  for (unsigned int i = 0; i < n; i++) {
+    const unsigned int j = 2*i;
+    for (unsigned int l = 0; l < L; l++) {
+      const double ri = b.r[i][l];
+      const double zi = b.z[i][l];
+      const double phii = b.phi[i][l];
+      const double sigmax = b.sigmaX[i][l];
+      const double sigmaz = b.sigmaZ[i][l];
+      const float rinv = b.rinv[l];
+      const float phi0 = b.phi0[l];
+      const float z0 = b.z0[l];
+      const float t = b.t[l];
+
+      // Barrel hit: phi and z position.
+      const double bar00 = -0.5*ri*ri/sqrt(1-0.25*ri*ri*rinv*rinv)/sigmax;
+      const double bar10 = ri/sigmax;
+      const double bar40 = 1.0/sigmax;
+      const double bar21 = (2/rinv)*asin(0.5*ri*rinv)/sigmaz;
+      const double bar31 = 1.0/sigmaz;
+
+      // Disk hit: r and rphi position.
+      double r_track=2.0*sin(0.5*rinv*(zi-z0)/t)/rinv;
+      double phi_track=phi0-0.5*rinv*(zi-z0)/t;
+      double theta0=b.theta0[i][l];
+
+      double rmultiplier=-sin(theta0-(phi_track-phii));
+      double phimultiplier=r_track*cos(theta0-(phi_track-phii));
+
+      double drdrinv=-2.0*sin(0.5*rinv*(zi-z0)/t)/(rinv*rinv)
+                     +(zi-z0)*cos(0.5*rinv*(zi-z0)/t)/(rinv*t);
+      double drdphi0=0;
+      double drdt=-(zi-z0)*cos(0.5*rinv*(zi-z0)/t)/(t*t);
+      double drdz0=-cos(0.5*rinv*(zi-z0)/t)/t;
+
+      double dphidrinv=-0.5*(zi-z0)/t;
+      double dphidphi0=1.0;
+      double dphidt=0.5*rinv*(zi-z0)/(t*t);
+      double dphidz0=0.5*rinv/t;
+
+      const bool valid = b.valid[i][l];
+      const bool barrel = b.barrel[i][l];
+      b.D[0][j][l]   = valid ? (barrel ? bar00 : drdrinv/sigmaz) : 0.0;
+      b.D[1][j][l]   = valid ? (barrel ? bar10 : drdphi0/sigmaz) : 0.0;
+      b.D[2][j][l]   = valid ? (barrel ? 0.0   : drdt/sigmaz)    : 0.0;
+      b.D[3][j][l]   = valid ? (barrel ? 0.0   : drdz0/sigmaz)   : 0.0;
+      b.D[4][j][l]   = valid ? (barrel ? bar40 : 0.0)            : 0.0;
+      b.D[0][j+1][l] = valid ? (barrel ? 0.0   : (phimultiplier*dphidrinv+rmultiplier*drdrinv)/sigmax) : 0.0;
+      b.D[1][j+1][l] = valid ? (barrel ? 0.0   : (phimultiplier*dphidphi0+rmultiplier*drdphi0)/sigmax) : 0.0;
+      b.D[2][j+1][l] = valid ? (barrel ? bar21 : (phimultiplier*dphidt+rmultiplier*drdt)/sigmax)       : 0.0;
+      b.D[3][j+1][l] = valid ? (barrel ? bar31 : (phimultiplier*dphidz0+rmultiplier*drdz0)/sigmax)     : 0.0;
+      b.D[4][j+1][l] = valid ? (barrel ? 0.0   : 1.0/sigmax)     : 0.0;
+    }
+  }
+
+  // M is symmetric, so only calculate its lower triangle.
+  for (unsigned int i1=0;i1<4;i1++) {
+    for (unsigned int i2=0;i2<=i1;i2++) {
+      for (unsigned int l = 0; l < L; l++) b.M[i1][i2][l] = 0.0;
+      for (unsigned int j=0;j<2*n;j++) {
+        for (unsigned int l = 0; l < L; l++) b.M[i1][i2][l] += b.D[i1][j][l]*b.D[i2][j][l];
+      }
+      for (unsigned int l = 0; l < L; l++) b.M[i2][i1][l] = b.M[i1][i2][l];
+    }
+  }
+}
+
+//=== Batch equivalent of residuals(), finding the stub with the largest residual on each candidate.
+
+void TrackFitLinearAlgo::residualsBatch() {
+
+  Batch& b = batch_;
+  const unsigned int L = __FIT_BATCH_LANES__;
+
+  for (unsigned int l = 0; l < L; l++) {
+    b.largestresid[l] = -1.0;
+    b.ilargestresid[l] = -1;
+  }
+
+  for (unsigned int i = 0; i < b.nStubsMax; i++) {
+    for (unsigned int l = 0; l < L; l++) {
+      const double ri = b.r[i][l];
+      const double zi = b.z[i][l];
+      const double phii = b.phi[i][l];
+      const double sigmax = b.sigmaX[i][l];
+      const double sigmaz = b.sigmaZ[i][l];
+      const float rinv = b.rinvfit4par[l];
+      const float phi0 = b.phi0fit4par[l];
+      const float z0 = b.z0fit4par[l];
+      const float t = b.tfit4par[l];
+
+      // Barrel stub.
+      double deltaphi=phi0-asin(0.5*ri*rinv)-phii;
+      deltaphi = (deltaphi>M_PI) ? deltaphi-2*M_PI : deltaphi;
+      deltaphi = (deltaphi<-M_PI) ? deltaphi+2*M_PI : deltaphi;
+      const double bar0 = ri*deltaphi/sigmax;
+      const double bar1 = (z0+(2.0/rinv)*t*asin(0.5*ri*rinv)-zi)/sigmaz;
+
+      // Disk stub.
+      double r_track=2.0*sin(0.5*rinv*(zi-z0)/t)/rinv;
+      double phi_track=phi0-0.5*rinv*(zi-z0)/t;
+      double Delta=b.deltai[i][l]-r_track*sin(b.theta0[i][l]-(phi_track-phii));
+      const double disk0 = (r_track-ri)/sigmaz;
+      const double disk1 = Delta/sigmax;
+
+      const bool valid = b.valid[i][l];
+      const double delta0 = fabs(b.barrel[i][l] ? bar0 : disk0);
+      const double delta1 = fabs(b.barrel[i][l] ? bar1 : disk1);
+      if (valid && delta0 > b.largestresid[l]) {
+        b.largestresid[l] = delta0;
+        b.ilargestresid[l] = i;
+      }
+      if (valid && delta1 > b.largestresid[l]) {
+        b.largestresid[l] = delta1;
+        b.ilargestresid[l] = i;
+      }
+    }
+  }
+}
+
+//=== Batch equivalent of linearTrackFit() and solveSymmetric().
+
+void TrackFitLinearAlgo::linearTrackFitBatch( bool withd0 ) {
+
+  Batch& b = batch_;
+  const unsigned int L = __FIT_BATCH_LANES__;
+  const unsigned int n = b.nStubsMax;
+  const unsigned int npar = withd0 ? 5 : 4;
+
+  if ( ! withd0 ) {
+
+    for (unsigned int l = 0; l < L; l++) b.chisqDelta[l] = 0.0;
+
+    for (unsigned int i = 0; i < n; i++) {
+      const unsigned int j = 2*i;
+      for (unsigned int l = 0; l < L; l++) {
+        const double ri = b.r[i][l];
+        const double zi = b.z[i][l];
+        const double phii = b.phi[i][l];
+        const double sigmax = b.sigmaX[i][l];
+        const double sigmaz = b.sigmaZ[i][l];
+        const float rinv = b.rinv[l];
+        const float phi0 = b.phi0[l];
+        const float z0 = b.z0[l];
+        const float t = b.t[l];
+
+        // Barrel stub.
+        double deltaphi=phi0-asin(0.5*ri*rinv)-phii;
+        deltaphi = (deltaphi>M_PI) ? deltaphi-2*M_PI : deltaphi;
+        deltaphi = (deltaphi<-M_PI) ? deltaphi+2*M_PI : deltaphi;
+        const double bar0 = ri*deltaphi/sigmax;
+        const double bar1 = (z0+(2.0/rinv)*t*asin(0.5*ri*rinv)-zi)/sigmaz;
+
+        // Disk stub.
+        double r_track=2.0*sin(0.5*rinv*(zi-z0)/t)/rinv;
+        double phi_track=phi0-0.5*rinv*(zi-z0)/t;
+        double Delta=b.deltai[i][l]-r_track*sin(b.theta0[i][l]-(phi_track-phii));
+        const double disk0 = (r_track-ri)/sigmaz;
+        const double disk1 = Delta/sigmax;
+
+        const bool valid = b.valid[i][l];
+        b.delta[j][l]   = valid ? (b.barrel[i][l] ? bar0 : disk0) : 0.0;
+        b.delta[j+1][l] = valid ? (b.barrel[i][l] ? bar1 : disk1) : 0.0;
+        b.chisqDelta[l]+=(b.delta[j][l]*b.delta[j][l]+b.delta[j+1][l]*b.delta[j+1][l]);
+      }
+    }
+
+    for (unsigned int i1=0;i1<5;i1++) {
+      for (unsigned int l = 0; l < L; l++) b.cov[i1][l] = 0.0;
+      for (unsigned int j=0;j<2*n;j++) {
+        for (unsigned int l = 0; l < L; l++) b.cov[i1][l]+=b.D[i1][j][l]*b.delta[j][l];
+      }
+    }
+
+  } else {
+
+    // Add the d0 row to M.
+    for (unsigned int i2=0;i2<5;i2++) {
+      for (unsigned int l = 0; l < L; l++) b.M[4][i2][l] = 0.0;
+      for (unsigned int j=0;j<2*n;j++) {
+        for (unsigned int l = 0; l < L; l++) b.M[4][i2][l] += b.D[4][j][l]*b.D[i2][j][l];
+      }
+      for (unsigned int l = 0; l < L; l++) b.M[i2][4][l] = b.M[4][i2][l];
+    }
+  }
+
+  // Solve M*dx = cov by Cholesky decomposition, as in solveSymmetric().
+  double C[5][5][__FIT_BATCH_LANES__];
+  for (unsigned int i = 0; i < npar; i++) {
+    for (unsigned int j = 0; j <= i; j++) {
+      double sum[__FIT_BATCH_LANES__];
+      for (unsigned int l = 0; l < L; l++) sum[l] = b.M[i][j][l];
+      for (unsigned int k = 0; k < j; k++) {
+        for (unsigned int l = 0; l < L; l++) sum[l] -= C[i][k][l]*C[j][k][l];
+      }
+      if (i == j) {
+        for (unsigned int l = 0; l < L; l++) C[i][i][l] = sqrt(sum[l]);
+      } else {
+        for (unsigned int l = 0; l < L; l++) C[i][j][l] = sum[l]/C[j][j][l];
+      }
+    }
+  }
+
+  double y[5][__FIT_BATCH_LANES__];
+  for (unsigned int i = 0; i < npar; i++) {
+    for (unsigned int l = 0; l < L; l++) y[i][l] = b.cov[i][l];
+    for (unsigned int k = 0; k < i; k++) {
+      for (unsigned int l = 0; l < L; l++) y[i][l] -= C[i][k][l]*y[k][l];
+    }
+    for (unsigned int l = 0; l < L; l++) y[i][l] /= C[i][i][l];
+  }
+
+  double dx[5][__FIT_BATCH_LANES__];
+  for (int i = npar-1; i >= 0; i--) {
+    for (unsigned int l = 0; l < L; l++) dx[i][l] = y[i][l];
+    for (unsigned int k = i+1; k < npar; k++) {
+      for (unsigned int l = 0; l < L; l++) dx[i][l] -= C[k][i][l]*dx[k][l];
+    }
+    for (unsigned int l = 0; l < L; l++) dx[i][l] /= C[i][i][l];
+  }
+
+  for (unsigned int l = 0; l < L; l++) {
+    double drinv = -dx[0][l];
+    double dphi0 = -dx[1][l];
+    double dt = -dx[2][l];
+    double dz0 = -dx[3][l];
+    double dd0 = withd0 ? -dx[4][l] : 0.0;
+
+    double deltaChisq=drinv*b.cov[0][l]+dphi0*b.cov[1][l]+dt*b.cov[2][l]+dz0*b.cov[3][l];
+    if ( withd0 ) {
+      deltaChisq+=dd0*b.cov[4][l];
+      b.rinvfit[l]=b.rinv[l]+drinv;
+      b.phi0fit[l]=b.phi0[l]+dphi0;
+      b.tfit[l]=b.t[l]+dt;
+      b.z0fit[l]=b.z0[l]+dz0;
+      b.d0fit[l]=b.d0[l]+dd0;
+      b.chisq[l]=(b.chisqDelta[l]+deltaChisq);
+    } else {
+      b.rinvfit4par[l]=b.rinv[l]+drinv;
+      b.phi0fit4par[l]=b.phi0[l]+dphi0;
+      b.tfit4par[l]=b.t[l]+dt;
+      b.z0fit4par[l]=b.z0[l]+dz0;
+      b.chisq4par[l]=(b.chisqDelta[l]+deltaChisq);
+    }
+  }
+}
+
+//=== Create the fitted track from the results in the given lane of the batch, as in fit().
+
+L1fittedTrack TrackFitLinearAlgo::fittedTrackBatch( unsigned int l, unsigned int iPhiSec, unsigned int iEtaReg ) const {
+
+  const Batch& b = batch_;
+  const L1track3D& l1track3D = *(b.trk[l]);
+  const std::vector<const Stub*>& stubs = b.stubs[l];
+
+  unsigned int nLayers = Utility::countLayers( settings_, stubs ); // Count tracker layers with stubs
+  bool valid4par = nLayers >= minStubLayers_;
+  if (l1track3D.pt() > minPtToReduceLayers_) valid4par = nLayers >= minStubLayers_ - 1;
+  bool valid5par = valid4par;
+
+  if (nPar_ == 4 && valid4par ) return L1fittedTrack(settings_, l1track3D, stubs, (b.rinvfit4par[l])/(invPtToInvR_), 0., b.phi0fit4par[l], b.z0fit4par[l], b.tfit4par[l], b.chisq4par[l], 4, iPhiSec, iEtaReg, true);
+  else if (nPar_ == 5 && valid5par ) return L1fittedTrack(settings_, l1track3D, stubs, (b.rinvfit[l])/(invPtToInvR_), b.d0fit[l], b.phi0fit[l], b.z0fit[l], b.tfit[l], b.chisq[l], 5, iPhiSec, iEtaReg, true);
+  else return L1fittedTrack (settings_, l1track3D, stubs, l1track3D.qOverPt(), 0., l1track3D.phi0(), l1track3D.z0(), l1track3D.tanLambda(), 999999., 4, iPhiSec, iEtaReg, false);
 }
@@ -81,7 +81,9 @@ vector<L1track2D> TrkRZfilter::filterTracks(const vector<L1track2D>& tracks) {
     if ( this->trackCandCheck( numLayersAfterFilters, trkIN.qOverPt() ) ) {
 
       // Create copy of original track, except now using its filtered stubs, to be added to filteredTrack collection.
-      L1track2D trkOUT(settings_, filteredStubs, trkIN.getCellLocation(), trkIN.getHelix2D(), true);
+      // (The filters only ever remove stubs, so if none were removed, the original list of stubs can be shared).
+      const StubList stubsOUT = (filteredStubs.size() == stubs.size())  ?  trkIN.getStubList()  :  makeStubList(std::move(filteredStubs));
+      L1track2D trkOUT(settings_, stubsOUT, trkIN.getCellLocation(), trkIN.getHelix2D(), true);
 
       // If one of the filters provided an estimate of the r-z track parameters, then store it inside track.
       if (estValid_) trkOUT.setTrkEstZ0andTanLam(estZ0_, estTanLambda_);
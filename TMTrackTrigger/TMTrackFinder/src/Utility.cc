@@ -5,12 +5,16 @@
 
 #include "FWCore/Utilities/interface/Exception.h"
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
 using namespace std;
 
-//=== Count number of tracker layers a given list of stubs are in.
-//=== By default, consider both PS+2S modules, but optionally consider only the PS ones.
+//=== Tracker layer of a stub, as used by countLayers(), in range 0 to maxLayerForCounting-1.
 
-unsigned int Utility::countLayers(const Settings* settings, const std::vector<const Stub*>& vstubs, bool disableReducedLayerID, bool onlyPS) {
+unsigned int Utility::layerForCounting(const Settings* settings, const Stub* stub, bool disableReducedLayerID) {
 
   //=== Unpack configuration parameters
 
@@ -26,35 +30,31 @@ unsigned int Utility::countLayers(const Settings* settings, const std::vector<co
   // Disable use of reduced layer ID if requested, otherwise take from cfg.
   bool reduce  =  (disableReducedLayerID)  ?  false  :  reduceLayerID;
 
-  const int maxLayerID(30);
-  std::vector<bool> foundLayers(maxLayerID, false);
-
+  int layerID;
   if (useLayerID) {
-    // Count layers using CMSSW layer ID.
-    for (const Stub* stub: vstubs) {
-      if ( (! onlyPS) || stub->psModule()) { // Consider only stubs in PS modules if that option specified.
-	// Use either normal or reduced layer ID depending on request.
-	int layerID = reduce  ?  stub->layerIdReduced()  :  stub->layerId();
-	if (layerID >= 0 && layerID < maxLayerID) {
-	  foundLayers[layerID] = true;
-	} else {
-	  throw cms::Exception("Utility::invalid layer ID");
-	} 
-      }
-    }
-
+    // Use CMSSW layer ID, either normal or reduced depending on request.
+    layerID = reduce  ?  stub->layerIdReduced()  :  stub->layerId();
   } else {
-    // Count layers by binning stub distance from beam line.
-    for (const Stub* stub: vstubs) {
-      if ( (! onlyPS) || stub->psModule()) { // Consider only stubs in PS modules if that option specified.
-	// N.B. In this case, no concept of "reduced" layer ID has been defined yet, so don't depend on "reduce";
-	int layerID = (int) ( (stub->r() - trackerInnerRadius) / layerIDfromRadiusBin );
-	if (layerID >= 0 && layerID < maxLayerID) {
-	  foundLayers[layerID] = true;
-	} else {
-	  throw cms::Exception("Utility::invalid layer ID");
-	} 
-      }
+    // Bin stub distance from beam line.
+    // N.B. In this case, no concept of "reduced" layer ID has been defined yet, so don't depend on "reduce";
+    layerID = (int) ( (stub->r() - trackerInnerRadius) / layerIDfromRadiusBin );
+  }
+
+  if (layerID < 0 || layerID >= int(maxLayerForCounting)) throw cms::Exception("Utility::invalid layer ID");
+
+  return layerID;
+}
+
+//=== Count number of tracker layers a given list of stubs are in.
+//=== By default, consider both PS+2S modules, but optionally consider only the PS ones.
+
+unsigned int Utility::countLayers(const Settings* settings, const std::vector<const Stub*>& vstubs, bool disableReducedLayerID, bool onlyPS) {
+
+  std::vector<bool> foundLayers(maxLayerForCounting, false);
+
+  for (const Stub* stub: vstubs) {
+    if ( (! onlyPS) || stub->psModule()) { // Consider only stubs in PS modules if that option specified.
+      foundLayers[ layerForCounting(settings, stub, disableReducedLayerID) ] = true;
     }
   }
 
@@ -79,44 +79,69 @@ const TP* Utility::matchingTP(const Settings* settings, const std::vector<const
   const double        minFracMatchStubsOnTP   = settings->minFracMatchStubsOnTP();
   const unsigned int  minNumMatchLayers       = settings->minNumMatchLayers();
 
-  // Loop over the given stubs, looking at the TP that produced each one.
+  static_assert(maxLayerForCounting <= 32, "Utility::matchingTP stores layers in 32 bit masks");
+
+  // Info accumulated about each TP that produced any of the given stubs. 
+  // (A track candidate rarely has stubs from more than a few TPs, so this table is searched linearly).
+  struct TPcount {
+    const TP*    tp;
+    unsigned int nMatchedStubs;
+    uint32_t     layers;       // Bit mask of tracker layers in which the given stubs came from this TP.
+    uint32_t     layersStrict; // Same, but only for stubs where the TP contributed to both clusters.
+  };
+  vector<TPcount> tpCounts;
+  // Links between the given stubs & entries in tpCounts, in order of the stubs.
+  vector<pair<unsigned int, const Stub*> > links;
+  tpCounts.reserve(4);
+  links.reserve(vstubs.size());
 
-  map<const TP*, vector<const Stub*> > tpsToStubs;
-  map<const TP*, vector<const Stub*> > tpsToStubsStrict;
+  // Loop once over the given stubs, looking at the TP that produced each one.
 
   for (const Stub* s : vstubs) {
-    // If this stub was produced by one or more TPs, store a link from the TPs to the stub.
+    const uint32_t layerBit = 1u << Utility::layerForCounting(settings, s, true);
+    // If this stub was produced by one or more TPs, note it for each of them.
     // (The assocated TPs here are influenced by config param "StubMatchStrict"). 
     for (const TP* tp_i : s->assocTPs()) {
-      tpsToStubs[ tp_i ].push_back( s );
-    }
-    // To resolve tie-break situations, do the same, but now only considering strictly associated TP, where the TP contributed
-    // to both clusters making up stub.
-    if (s->assocTP() != nullptr) {
-      tpsToStubsStrict[ s->assocTP() ].push_back( s );
+      unsigned int j = 0;
+      while (j < tpCounts.size() && tpCounts[j].tp != tp_i) j++;
+      if (j == tpCounts.size()) {
+	TPcount newCount = {tp_i, 0, 0, 0};
+	tpCounts.push_back(newCount);
+      }
+      TPcount& count = tpCounts[j];
+      count.nMatchedStubs++;
+      count.layers |= layerBit;
+      // To resolve tie-break situations, also count layers using only strictly associated TP, where the TP contributed
+      // to both clusters making up stub.
+      if (s->assocTP() == tp_i) count.layersStrict |= layerBit;
+      links.push_back( make_pair(j, s) );
     }
   }
 
+  // Consider the TPs in the order of their addresses, so that ties are resolved as when they were held in a std::map.
+  vector<unsigned int> order(tpCounts.size());
+  for (unsigned int j = 0; j < order.size(); j++) order[j] = j;
+  sort(order.begin(), order.end(), [&tpCounts](unsigned int a, unsigned int b){return std::less<const TP*>()(tpCounts[a].tp, tpCounts[b].tp);});
+
   // Loop over all the TP that matched the given stubs, looking for the best matching TP.
 
   nMatchedLayersBest = 0;        // initialize
   unsigned int nMatchedLayersStrictBest = 0; // initialize
   matchedStubsBest.clear();     // initialize
   const TP* tpBest = nullptr;   // initialize
+  int jBest = -1;
 
-  for (const auto& iter: tpsToStubs) {
-    const TP*                 tp                 = iter.first;
-    const vector<const Stub*> matchedStubsFromTP = iter.second;
-
-    const vector<const Stub*> matchedStubsStrictFromTP = tpsToStubsStrict[tp]; // Empty vector, if this TP didnt produce both clusters in stub.
+  for (unsigned int j : order) {
+    const TPcount& count = tpCounts[j];
+    const TP* tp = count.tp;
 
     // Count number of the given stubs that came from this TP.
-    unsigned int nMatchedStubs  = matchedStubsFromTP.size();
+    unsigned int nMatchedStubs  = count.nMatchedStubs;
     // Count number of tracker layers in which the given stubs came from this TP.
-    unsigned int nMatchedLayers = Utility::countLayers( settings, matchedStubsFromTP, true );
+    unsigned int nMatchedLayers = __builtin_popcount( count.layers );
 
     // For tie-breaks, count number of tracker layers in which both clusters of the given stubs came from this TP.
-    unsigned int nMatchedLayersStrict = Utility::countLayers( settings, matchedStubsStrictFromTP, true );
+    unsigned int nMatchedLayersStrict = __builtin_popcount( count.layersStrict );
 
     // If enough layers matched, then accept this tracking particle.
     // Of the three criteria used here, usually only one is used, with the cuts on the other two set ultra loose.
@@ -129,11 +154,19 @@ const TP* Utility::matchingTP(const Settings* settings, const std::vector<const
       if (nMatchedLayersBest < nMatchedLayers || (nMatchedLayersBest == nMatchedLayers && nMatchedLayersStrictBest < nMatchedLayersStrict)) {
 	// Store data for this TP match.
 	nMatchedLayersBest = nMatchedLayers;
-	matchedStubsBest   = matchedStubsFromTP;
 	tpBest             = tp;
+	jBest              = j;
       }
     }
   }
 
+  // Note which of the given stubs came from the best matching TP.
+  if (jBest >= 0) {
+    matchedStubsBest.reserve(tpCounts[jBest].nMatchedStubs);
+    for (const auto& link : links) {
+      if (int(link.first) == jBest) matchedStubsBest.push_back(link.second);
+    }
+  }
+
   return tpBest;
 }
@@ -96,9 +96,7 @@ bool kalmanState::good( const TP *tp )const{
     while( state ){
 	const Stub *stub = state->stub();
 	if( stub ){
-	    set<const TP*> tps = stub->assocTPs();
-
-	    if( tps.find(tp) == tps.end() ) return false; 
+	    if( ! stub->assocTPs().contains(tp) ) return false; 
 	}
 	state = state->last_state();
     }
@@ -178,8 +176,7 @@ void kalmanState::dump( ostream &os, const TP *tp, bool all )const
 	os  << "[r,phi,z] = ";
 	os << "[" << stub->r() << ", " << stub->phi() << ", " << stub->z() << "] ";
 	os << " assoc TP indices = [ "; 
-	std::set<const TP*> tps = stub->assocTPs();
-	for( auto tp : tps ) os << tp->index() << " "; 
+	for( auto tp : stub->assocTPs() ) os << tp->index() << " "; 
 	os << "] ";
 	os << endl;
     }
@@ -199,8 +196,7 @@ void kalmanState::dump( ostream &os, const TP *tp, bool all )const
 	os << "\tstub [r,phi,z] = ";
 	os << "[" << stub_->r() << ", " << stub_->phi() << ", " << stub_->z() << "] ";
 	os << " assoc TP indices = [ "; 
-	std::set<const TP*> tps = stub_->assocTPs();
-	for( auto tp : tps ) os << tp->index() << " "; 
+	for( auto tp : stub_->assocTPs() ) os << tp->index() << " "; 
 	os << "] ";
     }
     else{
@@ -0,0 +1,44 @@
+#################################################################################################
+# Configuration for the standalone microbenchmark executable, which times the CPU-intensive kernels
+# of the track finding (HT filling, HT track finding, r-z filters, duplicate removal, track fits ...)
+# in isolation, on events made by the StubGenerator, for several values of pileup & number of signal 
+# tracks. Results are written to a JSON file, so they can be compared between software versions.
+#
+# Run with:
+#   tmttBenchmark tmtt_benchmark_cfg.py [jsonFile]
+# where the optional argument overrides the value of OutputFile below.
+#################################################################################################
+
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("Benchmark")
+
+#--- Load the same track finding configuration as used by tmtt_tf_analysis_cfg.py.
+process.load('TMTrackTrigger.TMTrackFinder.TMTrackProducer_cff')
+
+#--- No histograms are booked by the benchmark.
+process.TMTrackProducer.TrackFitSettings.KalmanFillInternalHists = cms.bool(False)
+#--- Disable duplicate removal in HTpair, so that the duplicate removal algorithms are timed on all track candidates.
+process.TMTrackProducer.DupTrkRemoval.DupTrkAlgRzSeg = cms.uint32(0)
+
+from TMTrackTrigger.TMTrackFinder.StubGenerator_cfi import StubGenerator
+
+process.Benchmark = cms.PSet(
+  # Name of JSON output file.
+  OutputFile      = cms.string('tmtt_benchmark.json'),
+  # Label copied to JSON file, to identify the software version benchmarked.
+  Label           = cms.string(''),
+  # Number of generated events used for each point of the sweep.
+  NumEvents       = cms.uint32(10),
+  # Number of times each kernel is run over these events. The fastest is reported.
+  NumRepetitions  = cms.uint32(3),
+  # Values of pileup & number of signal tracks swept over, which control the number of stubs & track candidates per sector.
+  PileUp          = cms.vdouble(0., 70., 140., 200., 250.),
+  NumSignalTracks = cms.vuint32(1, 20),
+  # Duplicate track removal algorithms to benchmark (see KillDupTrks.h).
+  DupTrkAlgs      = cms.vuint32(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19),
+  # Track fitters to benchmark.
+  TrackFitters    = cms.vstring("KF4ParamsComb", "TrackFitLinearAlgo4", "LinearRegression", "ChiSquared4ParamsApprox"),
+  # Generator options (PileUp & NumSignalTracks are overridden by the values above).
+  Generator       = StubGenerator.clone()
+)
@@ -0,0 +1,30 @@
+#################################################################################################
+# Configuration for the standalone generator executable, which writes a snapshot file containing
+# stubs & tracking particles from helical tracks in a simplified tracker, with configurable pileup.
+# Useful for throughput & scaling studies of the track finding, independently of the MC samples.
+#
+# Generate the events with:
+#   tmttGenerate tmtt_generate_cfg.py [snapshotFile] [numEvents]
+# where the optional arguments override the values of OutputFile & NumEvents below.
+# Then run the track finding on them with:
+#   tmttReplay tmtt_replay_cfg.py events_gen.snap
+#################################################################################################
+
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("Generate")
+
+#--- Load the track finding configuration, whose GenCuts define which TPs are used for efficiency measurement.
+process.load('TMTrackTrigger.TMTrackFinder.TMTrackProducer_cff')
+
+#--- Generator options. (See StubGenerator_cfi.py for the full list & their default values).
+from TMTrackTrigger.TMTrackFinder.StubGenerator_cfi import StubGenerator
+
+process.Generator = StubGenerator.clone(
+  # Snapshot file to write & number of events to generate.
+  OutputFile           = cms.string('events_gen.snap'),
+  NumEvents            = cms.uint32(100),
+  # Examples of how to override the defaults.
+  NumSignalTracks      = cms.uint32(1),
+  PileUp               = cms.double(200.)
+)
@@ -0,0 +1,34 @@
+#################################################################################################
+# Configuration for the standalone replay executable, which runs the L1 track finding on stubs &
+# tracking particles stored in a snapshot file, without needing the CMSSW framework to read the events.
+#
+# First write the snapshot file with a normal CMSSW job:
+#   cmsRun tmtt_tf_analysis_cfg.py Events=100 snapshotFile=events.snap
+# Then replay it as often as you like with:
+#   tmttReplay tmtt_replay_cfg.py [snapshotFile] [maxEvents]
+# where the optional arguments override the values of InputFile & MaxEvents below.
+#################################################################################################
+
+import FWCore.ParameterSet.Config as cms
+
+process = cms.Process("Replay")
+
+#--- Load the same track finding configuration as used by tmtt_tf_analysis_cfg.py.
+process.load('TMTrackTrigger.TMTrackFinder.TMTrackProducer_cff')
+
+#--- Optionally override default configuration parameters here (example given of how).
+
+#process.TMTrackProducer.HTArraySpecRz.EnableRzHT = cms.bool(True)
+#--- Only fill the histograms needed for the input data & tracking efficiency summaries (see Histos.h).
+#process.TMTrackProducer.HistosDisabled = cms.untracked.vstring('EtaPhiSectors', 'RphiHT', 'RZfilters', 'StudyBusyEvents')
+
+process.Replay = cms.PSet(
+  # Snapshot file to read.
+  InputFile = cms.string('events.snap'),
+  # Number of events to process (-1 = all).
+  MaxEvents = cms.int32(-1),
+  # Name of output histogram file. If it is equal to a null string, no histograms are made.
+  HistFile  = cms.string(''),
+  # B-field in Tesla (taken from the EventSetup in CMSSW jobs).
+  BField    = cms.double(3.8112)
+)
@@ -36,6 +36,25 @@ options.register('histFile','Hist.root',VarParsing.VarParsing.multiplicity.singl
 options.register('outEdmFile','',VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,"Name of output EDM file")
 #options.register('outEdmFile','outputEdm.root',VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,"Name of output EDM file")
 
+#--- Specify name of output snapshot file of stubs & tracking particles, which can be replayed without CMSSW.
+#--- If the name is equal to a null string, no snapshot file will be written.
+options.register('snapshotFile','',VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,"Name of output stub/TP snapshot file")
+
+#--- Specify name of output binary file of firmware test vectors, containing the digitized stubs at the HT output
+#--- packed into link words. (Requires stub digitization). If the name is equal to a null string, no file will be written.
+options.register('testVectorFile','',VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,"Name of output firmware test vector file")
+
+#--- Specify if time spent in each processing stage & sector should be histogrammed (1) or not (0).
+options.register('stageTiming',1,VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.int,"Histogram processing time per stage & sector")
+
+#--- Specify number of separate threads that should fill the histograms, in parallel with the track finding.
+#--- If it is 0, the histograms are filled by the track finding thread.
+options.register('asyncHistos',0,VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.int,"Number of threads filling histograms")
+
+#--- Specify which histograms should be filled: 'full' (all), or 'production' (only those needed for the
+#--- input data & tracking efficiency summaries, which is much faster).
+options.register('histosProfile','full',VarParsing.VarParsing.multiplicity.singleton, VarParsing.VarParsing.varType.string,"Histogram profile: full or production")
+
 options.parseArguments()
 
 #--- input and output
@@ -73,6 +92,29 @@ process.load('TMTrackTrigger.TMTrackFinder.TMTrackProducer_cff')
 #--- Add boolean, indicating if output EDM file will be written, to cfg params, so is available to C++.
 process.TMTrackProducer.WriteOutEdmFile = cms.untracked.bool( (options.outEdmFile != "") )
 
+#--- Add name of output snapshot file (if any) to cfg params.
+process.TMTrackProducer.SnapshotFile = cms.untracked.string( options.snapshotFile )
+
+#--- Add name of output firmware test vector file (if any) to cfg params.
+process.TMTrackProducer.TestVectorFile = cms.untracked.string( options.testVectorFile )
+
+#--- Add boolean, indicating if processing time should be histogrammed, to cfg params.
+process.TMTrackProducer.StageTiming = cms.untracked.bool( (options.stageTiming != 0) )
+
+#--- Add boolean, indicating if histograms should be filled by separate threads, and number of threads, to cfg params.
+process.TMTrackProducer.AsyncHistos = cms.untracked.bool( (options.asyncHistos != 0) )
+if (options.asyncHistos != 0) :
+  process.TMTrackProducer.AsyncHistosThreads = cms.untracked.uint32( options.asyncHistos )
+
+#--- Add list of histogram families that should not be filled to cfg params.
+#--- (Possible families: InputData, EtaPhiSectors, RphiHT, RZfilters, StudyBusyEvents, TrackCands, TrackFitting).
+if (options.histosProfile == 'full') :
+  process.TMTrackProducer.HistosDisabled = cms.untracked.vstring()
+elif (options.histosProfile == 'production') :
+  process.TMTrackProducer.HistosDisabled = cms.untracked.vstring('EtaPhiSectors', 'RphiHT', 'RZfilters', 'StudyBusyEvents')
+else :
+  raise ValueError("Unknown histosProfile: " + options.histosProfile)
+
 #--- Optionally override default configuration parameters here (example given of how).
 
 #process.TMTrackProducer.HTArraySpecRz.EnableRzHT = cms.bool(True)